@@ -0,0 +1,72 @@
+#ifndef QUBEENGINE_ASSET_ASSETCOOKER_H_
+#define QUBEENGINE_ASSET_ASSETCOOKER_H_
+
+#include <qubeengine/io/AssetManifest.h>
+#include <qubeengine/render/ShaderCompiler.h>
+#include <qubeengine/texture/BlockCompressor.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <string>
+#include <vector>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::asset
+{
+	//Import settings. They are part of the key of every asset they apply to, so changing them cooks those
+	//assets again.
+	struct CookSettings
+	{
+		texture::TextureFormat textureFormat = texture::TextureFormat::Bc7;
+		std::string shaderCompiler; //glslangValidator, see render::ShaderCompiler
+
+		//Whether run() packs what the runtime loads into an io::ResourceArchive. Not part of any key.
+		bool packArchive = false;
+		bool compressArchive = false;
+	};
+
+	//Cooks everything under a resource directory into a cache directory ahead of time, with the same cookers
+	//the runtime falls back to: OBJ files into mesh caches, images into texture caches and GLSL shaders into
+	//SPIR-V. Every source is hashed together with its settings and only cooked if there is no file for that
+	//key yet, so a second run only pays for reading the sources. Assets are cooked in parallel on the job
+	//system, which the cookers use for their own loops as well.
+	//
+	//The run ends with an io::AssetManifest of every cooked asset and removes cooked files it no longer lists.
+	//If asked to, it then packs the manifest, the cooked files and the scenes, which the runtime loads as they
+	//are, into an io::ResourceArchive in the resource directory.
+	class AssetCooker
+	{
+	public:
+		AssetCooker(const std::string& resDirectory, const std::string& cacheDirectory, const CookSettings& settings, thread::JobSystem& jobSystem);
+
+		//Returns false if an asset failed to cook or the manifest could not be written. Assets that did
+		//cook are listed either way.
+		bool run();
+
+	private:
+		enum class CookResult
+		{
+			Cooked,
+			UpToDate,
+			Failed
+		};
+
+		//Returns false for files that are not assets, such as archives and the cache itself.
+		static bool getKind(const std::string& extension, io::AssetKind& kind);
+
+		CookResult cook(const std::string& sourcePath, io::AssetKind kind, io::AssetManifest::Entry& entry) const;
+		bool packArchive(const std::string& archivePath, const std::vector<io::AssetManifest::Entry>& entries) const;
+
+		std::string mResDirectory;
+		std::string mCacheDirectory;
+		CookSettings mSettings;
+		render::ShaderCompiler mShaderCompiler;
+		io::FileSystem mFileSystem; //Nothing mounted, the cooker reads what is on disk
+		thread::JobSystem& mJobSystem;
+	};
+}
+
+#endif
\ No newline at end of file
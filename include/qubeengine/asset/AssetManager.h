@@ -0,0 +1,120 @@
+#ifndef QUBEENGINE_ASSET_ASSETMANAGER_H_
+#define QUBEENGINE_ASSET_ASSETMANAGER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace qe::io
+{
+	class AssetManifest;
+	class FileSystem;
+}
+
+namespace qe::render
+{
+	class QueueTimeline;
+	class UploadQueue;
+}
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::asset
+{
+	using TextureHandle = uint32;
+
+	enum class AssetState : uint8
+	{
+		Loading,	//Read, cooked and staged on the job system
+		Uploading,	//Copies submitted, waiting for the graphics timeline
+		Resident,	//Safe to sample
+		Failed
+	};
+
+	//Streams textures in the background, so the renderer can start before they are loaded.
+	//
+	//A request returns a handle right away and runs on the job system: the file is mapped, read from the
+	//texture cache or cooked into it, and its levels are copied into a staging buffer next to a new image.
+	//Textures the asset manifest lists are read from the asset cooker's output without opening the source.
+	//Only recording the copies needs the render thread. update() does that for every finished job, submits
+	//them in one batch and reports the textures whose batch the graphics timeline has passed, without ever
+	//waiting for the GPU. Until then renderers sample a placeholder.
+	class AssetManager
+	{
+	public:
+		AssetManager(VkDevice device, VkPhysicalDevice physicalDevice, bool supportsTextureCompression, const io::AssetManifest& manifest,
+			const io::FileSystem& fileSystem, render::UploadQueue& uploadQueue, render::QueueTimeline& graphicsTimeline, thread::JobSystem& jobSystem);
+		~AssetManager();
+
+		AssetManager(const AssetManager&) = delete;
+		AssetManager& operator=(const AssetManager&) = delete;
+
+		//Requesting a path again returns the handle of the first request.
+		TextureHandle requestTexture(const std::string& path);
+
+		//Records and submits the uploads of finished loads, then returns the textures that became resident
+		//since the last call. Call it once per frame from the render thread.
+		std::vector<TextureHandle> update();
+
+		//Blocks until the texture is loaded and its upload is recorded, for renderers that cannot swap
+		//textures later. The upload is submitted with the next flush of the upload queue, everything the
+		//graphics queue runs after that can sample it. Throws if the texture failed to load.
+		void finishLoading(TextureHandle handle);
+
+		AssetState getState(TextureHandle handle) const;
+		VkImageView getView(TextureHandle handle) const;
+		VkFormat getFormat(TextureHandle handle) const;
+		uint32 getLevelCount(TextureHandle handle) const;
+
+	private:
+		//Everything a load produces off the render thread.
+		struct LoadedTexture
+		{
+			VkImage image = VK_NULL_HANDLE;
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			VkImageView view = VK_NULL_HANDLE;
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			uint32 levelCount = 0;
+			VkBuffer stagingBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+			std::vector<VkBufferImageCopy> regions;
+		};
+
+		struct Texture
+		{
+			std::string path;
+			AssetState state = AssetState::Loading;
+			std::future<LoadedTexture> loading;
+			LoadedTexture loaded;
+			uint64 arrivalValue = 0;
+		};
+
+		LoadedTexture loadTexture(const std::string& path) const;
+		void destroyTexture(LoadedTexture& texture) const;
+		//Takes the result of a finished load and records its upload. Returns false if the load failed.
+		bool recordUpload(Texture& texture);
+		uint32 findMemoryType(uint32 typeFilter, VkMemoryPropertyFlags properties) const;
+
+		VkDevice mDevice;
+		VkPhysicalDevice mPhysicalDevice;
+		bool mSupportsTextureCompression;
+		const io::AssetManifest& mManifest;
+		const io::FileSystem& mFileSystem;
+		render::UploadQueue& mUploadQueue;
+		render::QueueTimeline& mGraphicsTimeline;
+		thread::JobSystem& mJobSystem;
+
+		std::vector<Texture> mTextures;
+		std::unordered_map<std::string, TextureHandle> mTextureHandles;
+	};
+}
+
+#endif
\ No newline at end of file
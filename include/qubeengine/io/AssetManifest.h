@@ -0,0 +1,89 @@
+#ifndef QUBEENGINE_IO_ASSETMANIFEST_H_
+#define QUBEENGINE_IO_ASSETMANIFEST_H_
+
+#include <qubeengine/io/FileSystem.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <string>
+#include <vector>
+
+namespace qe::io
+{
+	enum class AssetKind : uint32
+	{
+		Mesh,		//OBJ file cooked into a mesh cache
+		Texture,	//Image cooked into a texture cache
+		Shader		//GLSL source compiled to SPIR-V
+	};
+
+	//Index of the cache directory written by the asset cooker: for every source file under the resource
+	//directory, the cooked file and the key it was cooked with. The runtime maps it once at startup and opens
+	//cooked assets through it without reading, let alone hashing, their sources.
+	//
+	//Cooked files are named after their key, a hash of the source contents and of the settings they were
+	//cooked with, so an unchanged source is never cooked twice. The manifest also stores the size and write
+	//time of every source. A source that was edited after cooking does not match them and is not found, so
+	//the runtime falls back to loading it directly. A source that is missing is found, the cooked file is all
+	//there is of it.
+	class AssetManifest
+	{
+	public:
+		static constexpr uint32 MAGIC = 0x4E414D51; //"QMAN"
+		static constexpr uint32 VERSION = 1;
+		static constexpr const char* FILE_NAME = "manifest.qman";
+
+		struct Entry
+		{
+			AssetKind kind;
+			std::string sourcePath;	//Relative to the resource directory, with forward slashes
+			std::string cookedPath;	//Relative to the cache directory
+			uint64 key;
+			uint64 sourceSize;
+			int64 sourceTime;
+		};
+
+		//Size and write time of a source as stored in entries. Returns false if the file does not exist.
+		static bool getSourceStamp(const std::string& path, uint64& size, int64& time);
+
+		//Writes FILE_NAME into the cache directory.
+		static bool write(const std::string& cacheDirectory, std::vector<Entry> entries);
+
+		//Returns false and stays closed if there is no manifest or it is damaged. Paths passed to find are
+		//resolved against resDirectory.
+		bool open(const FileSystem& fileSystem, const std::string& cacheDirectory, const std::string& resDirectory);
+		void close();
+		bool isOpen() const;
+
+		//Looks up a source by the path the runtime would load it from. Returns false if it was not cooked as
+		//kind or changed since, otherwise the path of the cooked file and the key to open it with.
+		bool find(const std::string& path, AssetKind kind, std::string& cookedPath, uint64& key) const;
+
+	private:
+		struct Header
+		{
+			uint32 magic;
+			uint32 version;
+			uint32 entryCount;
+			uint32 stringSize;
+		};
+
+		//Sorted by source path. Paths are offsets into the null terminated strings after the records.
+		struct Record
+		{
+			uint64 key;
+			uint64 sourceSize;
+			int64 sourceTime;
+			uint32 kind;
+			uint32 sourcePathOffset;
+			uint32 cookedPathOffset;
+			uint32 padding;
+		};
+
+		FileView mFile;
+		const Header* mpHeader = nullptr;
+		std::string mCacheDirectory;
+		std::string mResDirectory;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef QUBEENGINE_IO_FILEREADER_H_
+#define QUBEENGINE_IO_FILEREADER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace qe::io
+{
+	class FileView;
+
+	//Reads a file view front to back. Lines and byte ranges are handed out as pointers into the mapping, so
+	//only what the caller keeps is ever copied. The windows ahead of the read position are requested from the
+	//kernel before they are reached. With releaseBehind, what is behind it is given back, so streaming through
+	//a file larger than memory only keeps a few windows mapped.
+	class FileReader
+	{
+	public:
+		static constexpr std::size_t WINDOW_SIZE = 1 << 20;
+
+		explicit FileReader(const FileView& file, bool releaseBehind = false);
+
+		//Copies up to size bytes, returns how many were copied.
+		std::size_t read(void* pDestination, std::size_t size);
+
+		//Copies one value of a trivially copyable type as it is stored. Returns false and reads nothing if
+		//the file ends before it.
+		template<typename T>
+		bool read(T& value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "FileReader only reads trivially copyable values.");
+
+			const uint8* pValue = consume(sizeof(T));
+			if (!pValue)
+			{
+				return false;
+			}
+
+			std::memcpy(&value, pValue, sizeof(T));
+
+			return true;
+		}
+
+		//Points at the next size bytes and moves past them. Returns nullptr and reads nothing if fewer are left.
+		const uint8* consume(std::size_t size);
+
+		//The next line without its line break, \n or \r\n. Returns false at the end of the file.
+		bool readLine(std::string_view& line);
+
+		void seek(std::size_t position);
+		void skip(std::size_t size);
+
+		std::size_t getPosition() const;
+		std::size_t getRemaining() const;
+		bool isAtEnd() const;
+
+	private:
+		void moveTo(std::size_t position);
+
+		const FileView& mFile;
+		const uint8* mpData;
+		std::size_t mSize;
+		std::size_t mPosition = 0;
+		std::size_t mRequestedEnd = 0; //Everything before it was requested with AccessHint::WillNeed
+		std::size_t mReleasedEnd = 0;
+		bool mReleaseBehind;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef QUBEENGINE_IO_FILESYSTEM_H_
+#define QUBEENGINE_IO_FILESYSTEM_H_
+
+#include <qubeengine/io/FileView.h>
+#include <qubeengine/io/ResourceArchive.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qe::io
+{
+	//Where the runtime opens files: shaders, scenes, the asset manifest and cooked or source assets. Paths
+	//are the ones the files have on disk, every file is memory mapped into an io::FileView instead of read
+	//into a buffer. Opening is thread safe, loaders running on jobs share one file system.
+	//
+	//Archives are mounted for a directory. Files under it are looked up in the archives first, in the order
+	//they were mounted, and only opened from disk if none has them.
+	class FileSystem
+	{
+	public:
+		//Returns false if there is no archive at archivePath or it is damaged. Not thread safe, mount before
+		//files are opened.
+		bool mountArchive(const std::string& archivePath, const std::string& directory);
+		uint32 getMountedFileCount() const;
+
+		//Returns false if the file does not exist, is empty or cannot be mapped.
+		bool open(const std::string& path, FileView& file, AccessHint hint = AccessHint::Sequential) const;
+
+	private:
+		struct Mount
+		{
+			std::string directory; //Normalized, with forward slashes and a trailing one
+			std::unique_ptr<ResourceArchive> pArchive;
+		};
+
+		static std::string normalize(const std::string& path);
+
+		std::vector<Mount> mMounts;
+	};
+}
+
+#endif
\ No newline at end of file
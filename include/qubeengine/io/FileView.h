@@ -0,0 +1,46 @@
+#ifndef QUBEENGINE_IO_FILEVIEW_H_
+#define QUBEENGINE_IO_FILEVIEW_H_
+
+#include <qubeengine/io/MappedFile.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace qe::io
+{
+	//The read-only contents of a file opened through an io::FileSystem. Loaders parse them in place, nothing
+	//is copied out of the mapping and pages are only read when they are touched. A loose file is mapped on its
+	//own, a packed one points into the mapping of its io::ResourceArchive, which has to outlive the view.
+	//Compressed files are the exception, they are decompressed into memory the view owns.
+	class FileView
+	{
+	public:
+		FileView() = default;
+
+		FileView(const FileView&) = delete;
+		FileView& operator=(const FileView&) = delete;
+
+		void close();
+
+		bool isOpen() const;
+		const uint8* getData() const;
+		std::size_t getSize() const;
+
+		//Hints how a range of the file will be read, see MappedFile::advise.
+		void advise(std::size_t offset, std::size_t size, AccessHint hint) const;
+
+	private:
+		friend class FileSystem;
+		friend class ResourceArchive;
+
+		MappedFile mFile; //Loose files
+		std::vector<uint8> mDecompressed; //Compressed files
+		const MappedFile* mpMapping = nullptr; //The one the contents are in, if any
+		std::size_t mOffset = 0; //Of the contents in the mapping
+		const uint8* mpData = nullptr;
+		std::size_t mSize = 0;
+	};
+}
+
+#endif
\ No newline at end of file
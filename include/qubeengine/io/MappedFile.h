@@ -0,0 +1,56 @@
+#ifndef QUBEENGINE_IO_MAPPEDFILE_H_
+#define QUBEENGINE_IO_MAPPEDFILE_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <string>
+
+namespace qe::io
+{
+	//How a range of a mapping is going to be read. Passed on to the kernel, which reads ahead or drops pages
+	//accordingly.
+	enum class AccessHint : uint8
+	{
+		Sequential,	//Front to back, read far ahead
+		Random,		//Scattered reads, no read ahead
+		WillNeed,	//Read the range in now
+		DontNeed	//Done with the range, its pages may be dropped and are read again if touched
+	};
+
+	//A whole file mapped read-only into memory. Pages are only read from disk when they are touched, so
+	//opening a large file is cheap and its contents can be copied without going through a stream.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		//Returns false if the file does not exist, is empty or cannot be mapped. hint applies to the whole file.
+		bool open(const std::string& path, AccessHint hint = AccessHint::Sequential);
+		void close();
+
+		bool isOpen() const;
+		const uint8* getData() const;
+		std::size_t getSize() const;
+
+		//Hints how a range will be read from now on. Windows only takes the hint passed to open.
+		void advise(std::size_t offset, std::size_t size, AccessHint hint) const;
+
+	private:
+		const uint8* mpData = nullptr;
+		std::size_t mSize = 0;
+
+#ifdef WIN32
+		void* mpFileHandle = nullptr;
+		void* mpMappingHandle = nullptr;
+#else
+		int mFileDescriptor = -1;
+#endif
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef QUBEENGINE_IO_MESHCACHE_H_
+#define QUBEENGINE_IO_MESHCACHE_H_
+
+#include <qubeengine/io/FileSystem.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <string>
+
+namespace qe::io
+{
+	//A cooked mesh: the vertex and index arrays exactly as they are uploaded, plus the submesh records.
+	//The file starts with a header followed by the three blobs at aligned offsets. Reading it maps the
+	//file and hands out pointers into the mapping, so the blobs go straight into a staging buffer.
+	//
+	//The header stores a key of the source the mesh was cooked from and the stride of the submesh records.
+	//A cache that does not match both is stale and cooked again. The vertex format and the index size are
+	//picked by the cooker and read back from the header.
+	class MeshCache
+	{
+	public:
+		static constexpr uint32 MAGIC = 0x48534D51; //"QMSH"
+		static constexpr uint32 VERSION = 4;
+
+		//The start of every submesh record, where it lies in the blobs. open() checks it against their sizes,
+		//indices are relative to vertexOffset.
+		struct SubmeshRange
+		{
+			uint32 firstIndex;
+			uint32 indexCount;
+			int32 vertexOffset;
+			uint32 vertexCount;
+		};
+
+		//What write() stores. The records are written as raw bytes, so they must not contain padding.
+		struct Contents
+		{
+			const void* pVertices;
+			uint32 vertexFormat; //Key of the vertex layout, not interpreted by the cache
+			uint32 vertexStride;
+			uint32 vertexCount;
+			const void* pIndices;
+			uint32 indexSize; //2 or 4 bytes
+			uint32 indexCount;
+			const void* pSubmeshes;
+			uint32 submeshStride;
+			uint32 submeshCount;
+		};
+
+		static uint64 computeSourceKey(const FileView& source);
+		static bool write(const std::string& path, uint64 sourceKey, const Contents& contents);
+
+		//Returns false and stays closed if the file is missing, damaged or stale.
+		bool open(const FileSystem& fileSystem, const std::string& path, uint64 sourceKey, uint32 submeshStride);
+		void close();
+		bool isOpen() const;
+
+		const void* getVertexData() const;
+		uint32 getVertexFormat() const;
+		uint32 getVertexStride() const;
+		uint32 getVertexCount() const;
+		const void* getIndexData() const;
+		uint32 getIndexSize() const;
+		uint32 getIndexCount() const;
+		const void* getSubmeshData() const;
+		uint32 getSubmeshCount() const;
+
+	private:
+		struct Header
+		{
+			uint32 magic;
+			uint32 version;
+			uint64 sourceKey;
+			uint32 vertexFormat;
+			uint32 vertexStride;
+			uint32 vertexCount;
+			uint32 indexSize;
+			uint32 indexCount;
+			uint32 submeshStride;
+			uint32 submeshCount;
+			uint32 padding;
+			uint64 vertexOffset;
+			uint64 indexOffset;
+			uint64 submeshOffset;
+		};
+
+		static constexpr uint64 BLOB_ALIGNMENT = 16;
+
+		FileView mFile;
+		const Header* mpHeader = nullptr;
+	};
+}
+
+#endif
\ No newline at end of file
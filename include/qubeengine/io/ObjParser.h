@@ -0,0 +1,110 @@
+#ifndef QUBEENGINE_IO_OBJPARSER_H_
+#define QUBEENGINE_IO_OBJPARSER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::io
+{
+	class FileView;
+
+	//One corner of a triangle. Indices are zero based, -1 if the face did not reference that attribute.
+	struct ObjIndex
+	{
+		int32 position;
+		int32 texCoord;
+		int32 normal;
+	};
+
+	//Faces between two "o" or "g" lines, triangulated.
+	struct ObjShape
+	{
+		std::string name;
+		std::vector<ObjIndex> indices;
+	};
+
+	//Positions and normals are 3 floats each, texture coordinates 2.
+	struct ObjModel
+	{
+		std::vector<float> positions;
+		std::vector<float> texCoords;
+		std::vector<float> normals;
+		std::vector<ObjShape> shapes;
+	};
+
+	//Reads the geometry of Wavefront OBJ files: v, vt, vn, f, o and g records, everything else is skipped.
+	//Produces the same shapes and triangles as tinyobjloader, including its ear clipping of polygons.
+	//
+	//The text is split into chunks on line boundaries that are parsed in parallel. Each chunk keeps its
+	//own attributes and faces, and relative (negative) indices are fixed up once the chunks are merged
+	//and every chunk knows how many attributes came before it. Polygons are triangulated after merging,
+	//since ear clipping needs the positions.
+	class ObjParser
+	{
+	public:
+		//Chunks smaller than this are not worth a job.
+		static constexpr std::size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+		//Throws if a line cannot be parsed or a face references an attribute that does not exist.
+		static void parse(const FileView& file, ObjModel& model, thread::JobSystem* pJobSystem = nullptr);
+		static void parse(const char* pText, std::size_t size, ObjModel& model, thread::JobSystem* pJobSystem = nullptr);
+
+	private:
+		//Faces that belong to the same shape. A chunk starts with a segment that continues the shape of
+		//the chunk before it, every "o" or "g" line starts a new shape.
+		struct Segment
+		{
+			bool startsShape;
+			std::string name;
+			uint32 firstFace;
+			std::vector<ObjIndex> triangles;
+		};
+
+		//A relative index is stored relative to the start of its chunk until the chunk offsets are known.
+		struct Fixup
+		{
+			uint32 corner;
+			uint8 components; //Bit 0 position, bit 1 texture coordinate, bit 2 normal
+		};
+
+		struct Chunk
+		{
+			const char* pBegin;
+			const char* pEnd;
+
+			std::vector<float> positions;
+			std::vector<float> texCoords;
+			std::vector<float> normals;
+			std::vector<ObjIndex> corners;
+			std::vector<uint32> faceStarts;
+			std::vector<Fixup> fixups;
+			std::vector<Segment> segments;
+			std::string error;
+
+			uint32 positionBase = 0;
+			uint32 texCoordBase = 0;
+			uint32 normalBase = 0;
+		};
+
+		static void parseChunk(Chunk& chunk);
+		static bool parseLine(Chunk& chunk, const char* p, const char* pEnd);
+		static bool parseFace(Chunk& chunk, const char* p, const char* pEnd);
+		static bool parseFloat(const char*& p, const char* pEnd, float& value);
+		static bool parseInt(const char*& p, const char* pEnd, int32& value);
+		static std::string parseName(const char* p, const char* pEnd);
+
+		static bool resolveChunk(Chunk& chunk, ObjModel& model);
+		static void triangulateChunk(Chunk& chunk, const std::vector<float>& positions);
+		static void triangulatePolygon(const ObjIndex* pCorners, uint32 count, const std::vector<float>& positions, std::vector<ObjIndex>& triangles);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef QUBEENGINE_IO_RESOURCEARCHIVE_H_
+#define QUBEENGINE_IO_RESOURCEARCHIVE_H_
+
+#include <qubeengine/io/FileView.h>
+#include <qubeengine/io/MappedFile.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <string>
+#include <vector>
+
+namespace qe::io
+{
+	//Many files packed into one, written by the asset cooker and mounted into an io::FileSystem at runtime.
+	//Opening a packed file is a lookup in a table inside the mapping instead of an open and a stat, and the
+	//files are read from one place on disk instead of wherever the loose ones are.
+	//
+	//Paths are hashed into an open addressing table of twice their count, so a lookup usually reads one
+	//bucket and one record. Files start on a page of their own and are mapped in place. Files packed with
+	//compression are stored as LZ4 blocks if that saves at least an eighth, and are decompressed into the
+	//view when they are opened.
+	class ResourceArchive
+	{
+	public:
+		static constexpr uint32 MAGIC = 0x43524151; //"QARC"
+		static constexpr uint32 VERSION = 1;
+		static constexpr const char* FILE_NAME = "resources.qarc";
+
+		struct Entry
+		{
+			std::string path;		//Inside the archive, relative to the directory it is mounted for, with forward slashes
+			std::string filePath;	//Where the file is read from when packing
+			bool compress;
+		};
+
+		//Returns false if a file cannot be read or the archive cannot be written. Paths have to be unique.
+		static bool write(const std::string& path, const std::vector<Entry>& entries);
+
+		//Returns false and stays closed if there is no archive or it is damaged.
+		bool open(const std::string& path);
+		void close();
+		bool isOpen() const;
+
+		uint32 getFileCount() const;
+
+		//Returns false if the archive has no file at path or it fails to decompress. hint applies to the
+		//range of the file.
+		bool openFile(const std::string& path, FileView& file, AccessHint hint) const;
+
+	private:
+		enum class Compression : uint32
+		{
+			None,
+			Lz4
+		};
+
+		struct Header
+		{
+			uint32 magic;
+			uint32 version;
+			uint32 fileCount;
+			uint32 bucketCount; //A power of two
+			uint32 stringSize;
+			uint32 padding;
+		};
+
+		//The buckets follow the header, the records and then the null terminated paths follow them. Buckets
+		//hold a record index plus one, zero for none.
+		struct Record
+		{
+			uint64 pathHash;
+			uint64 offset;
+			uint64 size;
+			uint64 storedSize;
+			uint32 pathOffset;
+			uint32 compression;
+		};
+
+		static constexpr uint64 BLOB_ALIGNMENT = 4096;
+
+		static uint64 hashPath(const std::string& path);
+
+		MappedFile mFile;
+		const Header* mpHeader = nullptr;
+		const uint32* mpBuckets = nullptr;
+		const Record* mpRecords = nullptr;
+		const char* mpStrings = nullptr;
+	};
+}
+
+#endif
\ No newline at end of file
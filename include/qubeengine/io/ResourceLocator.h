@@ -0,0 +1,22 @@
+#ifndef QUBEENGINE_IO_RESOURCELOCATOR_H_
+#define QUBEENGINE_IO_RESOURCELOCATOR_H_
+
+#include <string>
+
+namespace qe::io
+{
+	//Finds the resource directory instead of assuming where the executable runs from. The environment
+	//variable QUBEENGINE_RES_DIRECTORY wins if it is set. Otherwise the working directory and its parents are
+	//searched for a res directory with scenes in it, so any build directory inside the source tree works.
+	class ResourceLocator
+	{
+	public:
+		static constexpr const char* ENVIRONMENT_VARIABLE = "QUBEENGINE_RES_DIRECTORY";
+
+		//The directory ends with a separator, so relative resource paths can be appended as they are.
+		//Returns false if there is none.
+		static bool findResDirectory(std::string& directory);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef QUBEENGINE_IO_TEXTURECACHE_H_
+#define QUBEENGINE_IO_TEXTURECACHE_H_
+
+#include <qubeengine/io/FileSystem.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <string>
+
+namespace qe::io
+{
+	//A cooked texture: every mip level exactly as it is copied into the image, level 0 first. The file
+	//starts with a header holding the offsets of the levels, followed by the levels at aligned offsets.
+	//The levels form one blob, so reading a texture is one copy from the mapping into a staging buffer
+	//and one copy command with a region per level.
+	//
+	//Like the mesh cache, the header stores a key of the source image and a cache that does not match it is
+	//cooked again. The format is picked by the cooker and read back from the header. Levels that do not fit
+	//the format and the extent of their mip level are damage, the cache is not opened then.
+	class TextureCache
+	{
+	public:
+		static constexpr uint32 MAGIC = 0x58455451; //"QTEX"
+		static constexpr uint32 VERSION = 1;
+		static constexpr uint32 MAX_LEVEL_COUNT = 16;
+
+		//What write() stores.
+		struct Contents
+		{
+			uint32 format; //texture::TextureFormat
+			uint32 width;
+			uint32 height;
+			uint32 levelCount;
+			const void* pData;
+			const std::size_t* pLevelOffsets; //levelCount + 1 byte offsets into pData, the last one is its size
+		};
+
+		static uint64 computeSourceKey(const FileView& source);
+		static bool write(const std::string& path, uint64 sourceKey, const Contents& contents);
+
+		//Returns false and stays closed if the file is missing, damaged or stale.
+		bool open(const FileSystem& fileSystem, const std::string& path, uint64 sourceKey);
+		void close();
+		bool isOpen() const;
+
+		uint32 getFormat() const;
+		uint32 getWidth() const;
+		uint32 getHeight() const;
+		uint32 getLevelCount() const;
+
+		//All levels, getLevelOffset(getLevelCount()) bytes.
+		const void* getData() const;
+		std::size_t getLevelOffset(uint32 level) const;
+
+	private:
+		struct Header
+		{
+			uint32 magic;
+			uint32 version;
+			uint64 sourceKey;
+			uint32 format;
+			uint32 width;
+			uint32 height;
+			uint32 levelCount;
+			uint64 dataOffset;
+			uint64 levelOffsets[MAX_LEVEL_COUNT + 1];
+		};
+
+		static constexpr uint64 BLOB_ALIGNMENT = 16;
+
+		FileView mFile;
+		const Header* mpHeader = nullptr;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,101 @@
+#ifndef QUBEENGINE_MESH_MESHCOOKER_H_
+#define QUBEENGINE_MESH_MESHCOOKER_H_
+
+#include <qubeengine/io/MeshCache.h>
+#include <qubeengine/render/VertexLayout.h>
+#include <qubeengine/scene/SceneBvh.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace qe::io
+{
+	class FileView;
+}
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::mesh
+{
+	//Full precision vertex the model is parsed into. The vertex buffer holds the vertices packed with a
+	//render::VertexLayout instead. Vertices are welded byte for byte, so there is no padding.
+	struct Vertex
+	{
+		glm::vec3 pos;
+		glm::vec2 texCoord;
+	};
+
+	//A simplified index list of a submesh over the same vertices, drawn instead of the full one where the
+	//difference is too small to see.
+	struct SubmeshLod
+	{
+		uint32 firstIndex;
+		uint32 indexCount;
+		float error; //How far the surface moved from the full submesh, in model units
+	};
+
+	//A contiguous index range of the loaded model, one per object in the OBJ file. Vertices are only shared
+	//within a submesh, so its indices are relative to vertexOffset. Stored as is in the mesh cache.
+	struct Submesh
+	{
+		//Levels of detail besides the full submesh.
+		static constexpr uint32 MAX_LOD_COUNT = 3;
+
+		uint32 firstIndex;
+		uint32 indexCount;
+		int32 vertexOffset;
+		uint32 vertexCount;
+		scene::Aabb bounds;
+		float boundingRadius; //Around the center of bounds
+		uint32 lodCount;
+		SubmeshLod lods[MAX_LOD_COUNT]; //Coarser ones later, their indices follow those of the full submesh
+	};
+
+	static_assert(offsetof(Submesh, vertexCount) == offsetof(io::MeshCache::SubmeshRange, vertexCount), "Submesh starts with a MeshCache::SubmeshRange.");
+
+	//A model in the layout of the mesh cache: packed vertices, 16 or 32 bit indices and the submeshes.
+	struct CookedMesh
+	{
+		render::VertexLayout vertexLayout;
+		std::vector<uint8> vertices;
+		uint32 vertexCount = 0;
+		std::vector<uint8> indices;
+		uint32 indexSize = 4;
+		std::vector<Submesh> submeshes;
+	};
+
+	//Turns an OBJ file into a cooked mesh: parsed, welded, optimized and simplified into levels of detail per
+	//object, then packed with the smallest vertex layout and index size that hold it. Shared by the renderer,
+	//which cooks models it finds no cache for, and by the offline asset cooker.
+	class MeshCooker
+	{
+	public:
+		static void cook(const io::FileView& source, CookedMesh& mesh, thread::JobSystem* pJobSystem = nullptr);
+
+		//Writes the mesh to a mesh cache, see io::MeshCache::write.
+		static bool write(const std::string& path, uint64 sourceKey, const CookedMesh& mesh);
+
+		//Every level of detail aims for this fraction of the triangles of the one before it, and is dropped if
+		//it does not get below LOD_MIN_REDUCTION of them.
+		static constexpr float LOD_REDUCTION = 0.5f;
+		static constexpr float LOD_MIN_REDUCTION = 0.8f;
+		//Largest error of a level of detail, relative to the bounding radius of its submesh.
+		static constexpr float LOD_MAX_ERROR = 0.25f;
+
+	private:
+		static void parse(const io::FileView& source, std::vector<Vertex>& vertices, std::vector<uint32>& indices,
+			std::vector<Submesh>& submeshes, thread::JobSystem* pJobSystem);
+		//Appends the levels of detail of the submesh whose full index list is at the end of indices.
+		static void generateLods(std::vector<uint32>& indices, const std::vector<Vertex>& vertices, Submesh& submesh);
+		static void pack(const std::vector<Vertex>& vertices, const std::vector<uint32>& indices, CookedMesh& mesh);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef QUBEENGINE_MESH_MESHOPTIMIZER_H_
+#define QUBEENGINE_MESH_MESHOPTIMIZER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vector>
+
+namespace qe::mesh
+{
+	//How well an index list uses the post transform vertex cache, measured on a simulated FIFO cache.
+	struct VertexCacheStats
+	{
+		uint64 transformedVertexCount; //Cache misses, each one runs the vertex shader
+		uint64 triangleCount;
+		uint64 vertexCount; //Vertices referenced by the index list
+
+		//Average cache miss ratio, vertex shader invocations per triangle. 0.5 is the best a large grid can do.
+		float getAcmr() const;
+		//Average transformed vertex ratio, vertex shader invocations per vertex. 1.0 is optimal.
+		float getAtvr() const;
+
+		VertexCacheStats& operator+=(const VertexCacheStats& other);
+	};
+
+	//Reorders indexed triangle lists of one mesh for the GPU. The stages are meant to run in order:
+	//optimizeVertexCache, then optimizeOverdraw on its output, then optimizeVertexFetch.
+	//
+	//The vertex cache stage is Tipsify (Sander, Nehab and Barczak, 2007): it fans around one vertex at a
+	//time and picks the next one from the vertices the fan touched, preferring those still in the cache.
+	//The overdraw stage splits that order into clusters wherever the cache starts cold, and sorts the
+	//clusters so the ones facing away from the center of the mesh are drawn first. Those are the most
+	//likely to occlude the rest, and since the clusters stay intact the cache efficiency barely changes.
+	class MeshOptimizer
+	{
+	public:
+		//Entries of the simulated cache. Matches the post transform caches of most desktop GPUs.
+		static constexpr uint32 CACHE_SIZE = 16;
+		//How much worse than its cluster a split may make the cache efficiency in optimizeOverdraw.
+		static constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+		static VertexCacheStats analyzeVertexCache(const uint32* pIndices, uint32 indexCount, uint32 vertexCount, uint32 cacheSize = CACHE_SIZE);
+
+		//Writes the triangles of pIndices to pDestination in cache friendly order. Both may not overlap.
+		static void optimizeVertexCache(const uint32* pIndices, uint32 indexCount, uint32 vertexCount, uint32* pDestination, uint32 cacheSize = CACHE_SIZE);
+
+		//Writes the triangles of pIndices to pDestination sorted by cluster. pPositions points at the first
+		//position, a float3 every positionStride bytes. Both index lists may not overlap.
+		static void optimizeOverdraw(const uint32* pIndices, uint32 indexCount, const float* pPositions, uint32 positionStride, uint32 vertexCount,
+			uint32* pDestination, float threshold = OVERDRAW_THRESHOLD, uint32 cacheSize = CACHE_SIZE);
+
+		//Copies the vertices into pDestination in the order the indices first use them and rewrites the
+		//indices to match, so the vertex fetch walks memory forwards. Unused vertices are dropped, the
+		//number of vertices written is returned.
+		static uint32 optimizeVertexFetch(uint32* pIndices, uint32 indexCount, const void* pVertices, uint32 vertexCount, uint32 vertexSize, void* pDestination);
+
+	private:
+		//FIFO cache with one timestamp per vertex. A vertex is cached while fewer than cacheSize misses
+		//happened since it was loaded.
+		struct CacheSimulator
+		{
+			std::vector<uint32> timestamps;
+			uint32 time;
+			uint32 cacheSize;
+
+			CacheSimulator(uint32 vertexCount, uint32 cacheSize);
+
+			void reset();
+			uint32 addTriangle(const uint32* pTriangle);
+		};
+
+		//Starts of the clusters of an index list: a new cluster wherever a triangle misses all three vertices.
+		//Clusters are split further where the part so far uses the cache well enough on its own.
+		static void findClusters(const uint32* pIndices, uint32 indexCount, uint32 vertexCount, float threshold, uint32 cacheSize, std::vector<uint32>& clusters);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef QUBEENGINE_MESH_MESHSIMPLIFIER_H_
+#define QUBEENGINE_MESH_MESHSIMPLIFIER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vector>
+
+namespace qe::mesh
+{
+	//Reduces the triangle count of an indexed mesh for levels of detail, keeping its vertex buffer.
+	//
+	//Edges are collapsed in order of their quadric error (Garland and Heckbert, 1998) over position and
+	//texture coordinate together, so collapses that stretch the texture cost as much as those that bend the
+	//surface. Every collapse moves a vertex onto one of its neighbours instead of a new position, which is
+	//what lets all levels share the vertices of the full mesh. Vertices on open borders and where more than
+	//two texture islands meet never move, vertices on a texture seam only move along it together with their
+	//twin on the other side, so neither holes nor texture cracks appear. Collapses that would flip a
+	//triangle are skipped.
+	class MeshSimplifier
+	{
+	public:
+		//How much a texture coordinate counts against a position, which is scaled so the mesh fits a unit cube.
+		static constexpr float ATTRIBUTE_WEIGHT = 0.5f;
+
+		//Writes the simplified triangles of pIndices to pDestination, which needs room for indexCount indices
+		//and may not overlap them. Collapses stop once targetIndexCount is reached or the next one would move
+		//the surface further than maxError. pPositions and pTexCoords point at the first float3 and float2,
+		//one every vertexStride bytes. Returns the number of indices written, error receives how far the
+		//surface moved, both in model units.
+		static uint32 simplify(const uint32* pIndices, uint32 indexCount, const float* pPositions, const float* pTexCoords, uint32 vertexStride,
+			uint32 vertexCount, uint32 targetIndexCount, float maxError, uint32* pDestination, float& error);
+
+	private:
+		enum class VertexKind : uint8
+		{
+			Free,	//Moves onto any neighbour
+			Seam,	//Moves along its seam, its twin with it
+			Locked	//Border, non-manifold or where seams meet
+		};
+
+		//Squared distance to the planes of the triangles around a vertex, in position and texture coordinate
+		//space: v^T A v + 2 b^T v + c, divided by the triangle area summed into weight.
+		struct Quadric
+		{
+			double a[15]; //Upper triangle of the symmetric 5x5 matrix, row by row
+			double b[5];
+			double c;
+			double weight;
+
+			void addTriangle(const double* pP, const double* pQ, const double* pR);
+			Quadric& operator+=(const Quadric& other);
+			double evaluate(const double* pPoint) const;
+		};
+
+		struct Collapse
+		{
+			double cost;
+			uint32 from;
+			uint32 to;
+		};
+
+		static void classifyVertices(const uint32* pIndices, uint32 indexCount, const std::vector<uint32>& positionIds, std::vector<VertexKind>& kinds,
+			std::vector<uint32>& twins);
+		static bool flipsTriangles(uint32 from, uint32 to, const std::vector<uint32>& indices, const std::vector<uint32>& triangleOffsets,
+			const std::vector<uint32>& triangles, const float* pPositions, uint32 vertexStride);
+	};
+}
+
+#endif
\ No newline at end of file
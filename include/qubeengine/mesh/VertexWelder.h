@@ -0,0 +1,64 @@
+#ifndef QUBEENGINE_MESH_VERTEXWELDER_H_
+#define QUBEENGINE_MESH_VERTEXWELDER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <type_traits>
+#include <vector>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::mesh
+{
+	//Merges identical vertices, so every corner of a mesh can be written out as its own vertex and turned
+	//into an indexed mesh afterwards. Vertices are compared byte for byte, so they must not contain padding
+	//and should be zero initialized.
+	//
+	//Uses an open addressing table sized for the input up front, with one probe sequence per vertex. With
+	//a job system, large inputs are split into partitions by hash. Identical vertices always land in the
+	//same partition, so the partitions are welded in parallel without sharing a table.
+	class VertexWelder
+	{
+	public:
+		//Inputs with fewer vertices are welded on the calling thread.
+		static constexpr uint32 PARALLEL_THRESHOLD = 1 << 16;
+
+		//Writes the index of the unique vertex for every input vertex into pRemap and returns the number of
+		//unique vertices. They are numbered in the order they first appear.
+		static uint32 buildRemap(const void* pVertices, uint32 vertexCount, uint32 vertexSize, uint32* pRemap, thread::JobSystem* pJobSystem = nullptr);
+
+		//Gathers the unique vertices of a remap built by buildRemap into pDestination.
+		static void remapVertices(const void* pVertices, uint32 vertexCount, uint32 vertexSize, const uint32* pRemap, void* pDestination);
+
+		//Welds one vertex per corner into unique vertices and an index list.
+		template<typename Vertex>
+		static void weld(const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32>& indices, thread::JobSystem* pJobSystem = nullptr)
+		{
+			static_assert(std::is_trivially_copyable_v<Vertex>, "Vertices are compared and copied as raw bytes.");
+
+			uint32 cornerCount = static_cast<uint32>(corners.size());
+			indices.resize(cornerCount);
+			uint32 vertexCount = buildRemap(corners.data(), cornerCount, sizeof(Vertex), indices.data(), pJobSystem);
+
+			vertices.resize(vertexCount);
+			remapVertices(corners.data(), cornerCount, sizeof(Vertex), indices.data(), vertices.data());
+		}
+
+	private:
+		struct Entry
+		{
+			uint32 vertex;
+			uint32 tag; //More bits of the hash, most mismatches are rejected without comparing vertices
+		};
+
+		//Stores the index of the first equal vertex for every member of a partition. Members are vertex
+		//indices in increasing order, nullptr stands for all vertices.
+		static void findFirstOccurrences(const uint8* pVertices, uint32 vertexSize, const uint64* pHashes, const uint32* pMembers,
+			uint32 memberCount, uint32* pFirstOccurrences);
+	};
+}
+
+#endif
\ No newline at end of file
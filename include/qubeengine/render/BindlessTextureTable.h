@@ -0,0 +1,51 @@
+#ifndef QUBEENGINE_RENDER_BINDLESSTEXTURETABLE_H_
+#define QUBEENGINE_RENDER_BINDLESSTEXTURETABLE_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+namespace qe::render
+{
+	//One descriptor set holding every texture in a single runtime sized array. Shaders index it with a
+	//texture index from their instance data, so switching textures between draws needs no rebinding.
+	//Slots that were never written are left unbound (partially bound), and new textures can be added
+	//while command buffers using the set are pending (update after bind, update unused while pending).
+	//Slots those command buffers sample must not be changed until they have finished.
+	class BindlessTextureTable
+	{
+	public:
+		//Index that always holds the fallback texture.
+		static const uint32 FALLBACK_TEXTURE = 0;
+
+		//Checks for Vulkan 1.2 and the descriptor indexing features the table needs. They have to be
+		//enabled on the device, see fillFeatures().
+		static bool isSupported(VkPhysicalDevice physicalDevice);
+		static void fillFeatures(VkPhysicalDeviceDescriptorIndexingFeatures& features);
+
+		BindlessTextureTable(VkDevice device, uint32 capacity, VkImageView fallbackView, VkSampler fallbackSampler);
+		~BindlessTextureTable();
+
+		BindlessTextureTable(const BindlessTextureTable&) = delete;
+		BindlessTextureTable& operator=(const BindlessTextureTable&) = delete;
+
+		//Returns the index the shaders use to sample the texture.
+		uint32 addTexture(VkImageView view, VkSampler sampler);
+		void setTexture(uint32 index, VkImageView view, VkSampler sampler);
+
+		VkDescriptorSetLayout getLayout() const;
+		VkDescriptorSet getSet() const;
+		uint32 getTextureCount() const;
+
+	private:
+		VkDevice mDevice;
+		uint32 mCapacity;
+		uint32 mTextureCount = 0;
+
+		VkDescriptorSetLayout mLayout = VK_NULL_HANDLE;
+		VkDescriptorPool mPool = VK_NULL_HANDLE;
+		VkDescriptorSet mSet = VK_NULL_HANDLE;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef QUBEENGINE_RENDER_DESCRIPTORALLOCATOR_H_
+#define QUBEENGINE_RENDER_DESCRIPTORALLOCATOR_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace qe::render
+{
+	//A resource written to one binding of a descriptor set. Only the buffer or the image part is used,
+	//depending on the descriptor type.
+	struct DescriptorBinding
+	{
+		uint32 binding;
+		VkDescriptorType type;
+		VkDescriptorBufferInfo bufferInfo;
+		VkDescriptorImageInfo imageInfo;
+
+		static DescriptorBinding buffer(uint32 binding, VkDescriptorType type, VkBuffer buffer,
+			VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+		static DescriptorBinding image(uint32 binding, VkDescriptorType type, VkImageView view, VkSampler sampler,
+			VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		bool isImage() const;
+		bool operator==(const DescriptorBinding& other) const;
+	};
+
+	//Hands out descriptor sets from pools that grow on demand instead of being sized up front. Sets either
+	//belong to a frame in flight, and are released together when that frame's pools are reset, or are
+	//persistent and live until resetPersistent(). Requesting a set with bindings that were written before
+	//returns the existing set, so binding the same resources again costs nothing.
+	class DescriptorAllocator
+	{
+	public:
+		static const uint32 PERSISTENT = UINT32_MAX;
+
+		DescriptorAllocator(VkDevice device, uint32 frameCount);
+		~DescriptorAllocator();
+
+		DescriptorAllocator(const DescriptorAllocator&) = delete;
+		DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+		//Resets every pool of the frame at once. Call it after the frame's fence was waited on, the sets
+		//allocated for it the last time around are invalid afterwards.
+		void beginFrame(uint32 frameIndex);
+
+		//Releases all persistent sets, e.g. when the resources they point at are recreated. The pools are
+		//kept for the next round.
+		void resetPersistent();
+
+		VkDescriptorSet allocate(VkDescriptorSetLayout layout, uint32 frameIndex = PERSISTENT);
+
+		//Returns a set of the layout with exactly these bindings written, reusing a cached one if possible.
+		VkDescriptorSet getSet(VkDescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings, uint32 frameIndex = PERSISTENT);
+
+		std::size_t getPoolCount() const;
+
+	private:
+		static const uint32 INITIAL_POOL_SETS = 32;
+		static const uint32 MAX_POOL_SETS = 4096;
+
+		struct CachedSet
+		{
+			VkDescriptorSetLayout layout;
+			std::vector<DescriptorBinding> bindings;
+			VkDescriptorSet set;
+		};
+
+		//Pools are filled front to back. Once the current one runs out the next is used, and a new pool
+		//twice the size is created when there is none.
+		struct PoolList
+		{
+			std::vector<VkDescriptorPool> pools;
+			std::size_t currentPool = 0;
+			uint32 nextPoolSets = INITIAL_POOL_SETS;
+			std::unordered_multimap<uint64, CachedSet> cache;
+		};
+
+		PoolList& getPoolList(uint32 frameIndex);
+		VkDescriptorPool createPool(uint32 setCount);
+		void resetPoolList(PoolList& poolList);
+		static uint64 hashSet(VkDescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings);
+
+		VkDevice mDevice;
+		std::vector<PoolList> mFramePools;
+		PoolList mPersistentPools;
+	};
+}
+
+#endif
\ No newline at end of file
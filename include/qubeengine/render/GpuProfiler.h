@@ -0,0 +1,83 @@
+#ifndef QUBEENGINE_RENDER_GPUPROFILER_H_
+#define QUBEENGINE_RENDER_GPUPROFILER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace qe::render
+{
+	//Times regions of a command buffer with pairs of timestamp queries. Every frame index, one per command
+	//buffer, owns a range of a query pool that its command buffer resets and writes each time it executes.
+	//
+	//Nothing waits for the queries. submitted() remembers the timeline value of the submission and
+	//collect() reads back the frames whose values have been reached, which is usually two frames later.
+	//The zones go to the GPU track of util::Profiler, next to the CPU zones of the same frames.
+	class GpuProfiler
+	{
+	public:
+		//A queue family with timestampValidBits == 0 cannot write timestamps. The profiler is then
+		//created disabled and every call does nothing.
+		GpuProfiler(VkDevice device, VkPhysicalDevice physicalDevice, uint32 queueFamily, uint32 frameCount, uint32 maxZones = 32);
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		bool isEnabled() const;
+
+		//Recorded once per command buffer. beginFrame() has to be outside of a render pass, the zones can
+		//be anywhere in between, as long as they nest.
+		void beginFrame(VkCommandBuffer commandBuffer, uint32 frameIndex);
+		void endFrame(VkCommandBuffer commandBuffer, uint32 frameIndex);
+		uint32 beginZone(VkCommandBuffer commandBuffer, uint32 frameIndex, const std::string& name);
+		void endZone(VkCommandBuffer commandBuffer, uint32 frameIndex, uint32 zone);
+
+		//cpuTime is util::Profiler::now() at submission, the GPU zones are placed relative to it.
+		void submitted(uint32 frameIndex, uint64 timelineValue, double cpuTime);
+		void collect(uint64 completedTimelineValue);
+
+		//Duration of the last collected frame in microseconds.
+		double getLastFrameTime() const;
+
+	private:
+		struct Zone
+		{
+			std::string name;
+			uint32 beginQuery;
+			uint32 endQuery;
+		};
+
+		struct PendingFrame
+		{
+			uint32 frameIndex;
+			uint64 timelineValue;
+			double cpuTime;
+		};
+
+		uint32 getFirstQuery(uint32 frameIndex) const;
+		void readFrame(const PendingFrame& frame);
+
+		VkDevice mDevice;
+		VkQueryPool mQueryPool = VK_NULL_HANDLE;
+		bool mIsEnabled = false;
+		uint32 mFrameCount;
+		uint32 mQueriesPerFrame;
+		double mTimestampPeriod = 1.0;	//Nanoseconds per tick
+		uint64 mTimestampMask = 0;
+		uint32 mTrack = 0;
+
+		std::vector<std::vector<Zone>> mFrameZones;
+		std::vector<uint32> mFrameQueryCounts;
+		std::deque<PendingFrame> mPendingFrames;
+		std::vector<uint64> mResults;
+		double mLastFrameEnd = 0.0;
+		double mLastFrameTime = 0.0;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef QUBEENGINE_RENDER_PIPELINECACHE_H_
+#define QUBEENGINE_RENDER_PIPELINECACHE_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+
+namespace qe::io
+{
+	class FileSystem;
+}
+
+namespace qe::render
+{
+	//A VkPipelineCache that is kept on disk between runs, so pipelines the driver compiled once start from
+	//its binaries the next time.
+	//
+	//The file is what vkGetPipelineCacheData returns. Its header names the vendor, device and cache UUID of
+	//the driver that wrote it, a file from any other driver or driver version is ignored and the cache
+	//starts empty.
+	class PipelineCache
+	{
+	public:
+		static constexpr const char* FILE_NAME = "pipelines.qpc";
+
+		PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const io::FileSystem& fileSystem, const std::string& path);
+		~PipelineCache();
+
+		PipelineCache(const PipelineCache&) = delete;
+		PipelineCache& operator=(const PipelineCache&) = delete;
+
+		VkPipelineCache get() const;
+
+		//Writes the cache back to its file. Must not run while pipelines are built through it.
+		bool save() const;
+
+	private:
+		//The header every pipeline cache starts with, VK_PIPELINE_CACHE_HEADER_VERSION_ONE.
+		struct Header
+		{
+			uint32 headerSize;
+			uint32 headerVersion;
+			uint32 vendorId;
+			uint32 deviceId;
+			uint8 cacheUuid[VK_UUID_SIZE];
+		};
+
+		VkDevice mDevice;
+		VkPipelineCache mCache = VK_NULL_HANDLE;
+		std::string mPath;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef QUBEENGINE_RENDER_PIPELINEVARIANTS_H_
+#define QUBEENGINE_RENDER_PIPELINEVARIANTS_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::render
+{
+	//Everything a pipeline variant differs in. What the fields mean is up to the renderer that builds them,
+	//only constants has a fixed meaning: constant i is passed as specialization constant i of every stage.
+	struct PipelineKey
+	{
+		static constexpr uint32 MAX_CONSTANTS = 4;
+
+		uint32 program = 0;			//Which shaders
+		uint32 vertexLayout = 0;	//VertexLayout::getKey(), 0 without vertex input
+		uint32 features = 0;		//Fixed function toggles
+		uint32 constants[MAX_CONSTANTS] = {};
+
+		bool operator==(const PipelineKey& other) const;
+
+		//Points into the key and entries, both have to outlive the info. Stages ignore IDs they do not declare.
+		VkSpecializationInfo getSpecializationInfo(VkSpecializationMapEntry (&entries)[MAX_CONSTANTS]) const;
+	};
+
+	struct PipelineKeyHash
+	{
+		std::size_t operator()(const PipelineKey& key) const;
+	};
+
+	//A set of pipeline variants, looked up by key when commands are recorded.
+	//
+	//Variants are built in parallel on the job system through one VkPipelineCache, which Vulkan synchronizes
+	//internally, so a driver that already compiled a variant in an earlier run only has to look it up. Sets
+	//are cheap to swap, a renderer can build a replacement while recording with the current one.
+	class PipelineVariants
+	{
+	public:
+		using BuildFunction = std::function<VkPipeline(const PipelineKey& key, VkPipelineCache cache)>;
+
+		explicit PipelineVariants(VkDevice device);
+		~PipelineVariants();
+
+		PipelineVariants(const PipelineVariants&) = delete;
+		PipelineVariants& operator=(const PipelineVariants&) = delete;
+
+		//Builds the keys that are not in the set yet, one job each, and waits for them. If a build throws,
+		//the first exception is passed on once all jobs finished, the variants that were built are kept.
+		void build(const std::vector<PipelineKey>& keys, VkPipelineCache cache, thread::JobSystem& jobSystem, const BuildFunction& function);
+
+		//Returns VK_NULL_HANDLE for keys that were not built.
+		VkPipeline find(const PipelineKey& key) const;
+		std::size_t getCount() const;
+
+	private:
+		VkDevice mDevice;
+		std::unordered_map<PipelineKey, VkPipeline, PipelineKeyHash> mPipelines;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef QUBEENGINE_RENDER_QUEUETIMELINE_H_
+#define QUBEENGINE_RENDER_QUEUETIMELINE_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace qe::render
+{
+	//A queue together with one timeline semaphore. Every submission signals the next value of the timeline,
+	//so "has this work finished" becomes a comparison against the completed value, and waiting for a
+	//specific submission needs no fence. Work on other queues waits on the same semaphore and value.
+	class QueueTimeline
+	{
+	public:
+		//A semaphore a submission waits on. Value is ignored for binary semaphores, such as the ones used
+		//by the swapchain.
+		struct Wait
+		{
+			VkSemaphore semaphore;
+			uint64 value;
+			VkPipelineStageFlags stages;
+		};
+
+		//Timeline semaphores are core in Vulkan 1.2 and come from VK_KHR_timeline_semaphore before that.
+		//If requiresExtension() the extension has to be enabled on the device, the feature always has to
+		//be, see fillFeatures().
+		static bool isSupported(VkPhysicalDevice physicalDevice);
+		static bool requiresExtension(VkPhysicalDevice physicalDevice);
+		static void fillFeatures(VkPhysicalDeviceTimelineSemaphoreFeatures& features);
+
+		QueueTimeline(VkDevice device, VkQueue queue);
+		~QueueTimeline();
+
+		QueueTimeline(const QueueTimeline&) = delete;
+		QueueTimeline& operator=(const QueueTimeline&) = delete;
+
+		//Returns the timeline value that is signaled once the command buffers have executed.
+		uint64 submit(const std::vector<VkCommandBuffer>& commandBuffers, const std::vector<Wait>& waits = {},
+			const std::vector<VkSemaphore>& binarySignals = {});
+
+		//Blocks until the given value was signaled. Values that were never submitted return immediately.
+		void wait(uint64 value) const;
+		void waitIdle() const;
+		uint64 getCompletedValue() const;
+		uint64 getSubmittedValue() const;
+
+		VkQueue getQueue() const;
+		VkSemaphore getSemaphore() const;
+
+	private:
+		VkDevice mDevice;
+		VkQueue mQueue;
+		VkSemaphore mSemaphore = VK_NULL_HANDLE;
+		uint64 mSubmittedValue = 0;
+
+		//Loaded from the device so the KHR entry points are used when the device is older than 1.2.
+		PFN_vkWaitSemaphores mpWaitSemaphores = nullptr;
+		PFN_vkGetSemaphoreCounterValue mpGetSemaphoreCounterValue = nullptr;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,202 @@
+#ifndef QUBEENGINE_RENDER_RENDERGRAPH_H_
+#define QUBEENGINE_RENDER_RENDERGRAPH_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace qe::render
+{
+	class GpuProfiler;
+
+	using ResourceHandle = uint32;
+
+	enum class PassType
+	{
+		Graphics,	//Gets a render pass and framebuffers built from its attachment accesses
+		Compute,
+		Transfer
+	};
+
+	//How a pass touches a resource. Every access maps to the pipeline stages, access mask and image layout the
+	//graph uses to place barriers between passes.
+	enum class Access
+	{
+		ColorAttachmentWrite,
+		DepthAttachmentWrite,
+		DepthAttachmentRead,
+		VertexShaderRead,
+		FragmentShaderRead,
+		ComputeShaderRead,
+		ComputeShaderWrite,
+		IndirectRead,
+		TransferRead,
+		TransferWrite
+	};
+
+	//A frame described as passes that declare which resources they read and write. Compiling the graph drops
+	//passes nothing depends on, works out every barrier and layout transition between the passes that are left,
+	//builds the render passes for the graphics passes, and lets transient images whose lifetimes do not
+	//overlap share memory.
+	//
+	//The graph is built once per swapchain and recorded into every command buffer with execute(). Imported
+	//resources can have one Vulkan object per swapchain image, picked by the image index at execution.
+	class RenderGraph
+	{
+	public:
+		using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, std::size_t imageIndex)>;
+
+		RenderGraph(VkDevice device, VkPhysicalDevice physicalDevice);
+		~RenderGraph();
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		//An image owned by someone else, such as the swapchain. Its contents are discarded on first use
+		//(firstUseStages is where the first use has to wait, e.g. on the acquire semaphore) and it is
+		//transitioned to finalLayout at the end of the frame.
+		ResourceHandle importImage(const std::string& name, const std::vector<VkImage>& images, const std::vector<VkImageView>& views,
+			VkFormat format, VkExtent2D extent, VkImageLayout finalLayout, VkPipelineStageFlags firstUseStages);
+		ResourceHandle importBuffer(const std::string& name, const std::vector<VkBuffer>& buffers);
+
+		//An image that only lives within the frame, created and placed in memory by compile().
+		ResourceHandle createImage(const std::string& name, VkFormat format, VkExtent2D extent);
+
+		uint32 addPass(const std::string& name, PassType type, RecordFunction record);
+
+		//Passing a clear value clears an attachment when the render pass begins. Attachments written without
+		//one keep what earlier passes rendered.
+		void read(uint32 passIndex, ResourceHandle resource, Access access);
+		void write(uint32 passIndex, ResourceHandle resource, Access access, const VkClearValue* pClearValue = nullptr);
+
+		//Outputs are what the frame is for. Passes that do not contribute to one are culled.
+		void markOutput(ResourceHandle resource);
+
+		void compile(uint32 frameCount);
+		void execute(VkCommandBuffer commandBuffer, std::size_t imageIndex) const;
+
+		//Every pass, with its barriers, is recorded as a zone of the profiler. The image index is the
+		//profiler frame index.
+		void setProfiler(GpuProfiler* pProfiler);
+
+		//Only valid after compile() and for graphics passes that were not culled.
+		VkRenderPass getRenderPass(uint32 passIndex) const;
+		bool isPassCulled(uint32 passIndex) const;
+
+	private:
+		struct AccessInfo
+		{
+			VkPipelineStageFlags stages;
+			VkAccessFlags access;
+			VkImageLayout layout;
+			VkImageUsageFlags imageUsage;
+			bool isWrite;
+		};
+
+		struct Resource
+		{
+			std::string name;
+			bool isImage;
+			bool isImported;
+			bool isOutput = false;
+
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			VkExtent2D extent = {};
+			VkImageLayout finalLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags firstUseStages = 0;
+			VkAccessFlags firstUseAccess = 0;
+			VkImageUsageFlags usage = 0;
+
+			//One per swapchain image for imported resources, a single entry for transient images.
+			std::vector<VkImage> images;
+			std::vector<VkImageView> views;
+			std::vector<VkBuffer> buffers;
+
+			//Lifetime in compiled pass order, used to alias transient images.
+			uint32 firstPass = UINT32_MAX;
+			uint32 lastPass = 0;
+		};
+
+		struct ResourceUse
+		{
+			ResourceHandle resource;
+			AccessInfo info;
+			bool isAttachment;
+			bool isRead;
+			bool hasClearValue;
+			VkClearValue clearValue;
+		};
+
+		struct Barrier
+		{
+			ResourceHandle resource;
+			VkAccessFlags srcAccess;
+			VkAccessFlags dstAccess;
+			VkImageLayout oldLayout;
+			VkImageLayout newLayout;
+		};
+
+		struct BarrierBatch
+		{
+			VkPipelineStageFlags srcStages = 0;
+			VkPipelineStageFlags dstStages = 0;
+			std::vector<Barrier> barriers;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			PassType type;
+			RecordFunction record;
+			std::vector<ResourceUse> uses;
+			bool isCulled = false;
+
+			BarrierBatch barriers;
+			VkRenderPass renderPass = VK_NULL_HANDLE;
+			std::vector<VkFramebuffer> framebuffers;
+			std::vector<VkClearValue> clearValues;
+			VkExtent2D extent = {};
+		};
+
+		//Where a resource was last touched while walking the passes in order.
+		struct ResourceState
+		{
+			VkPipelineStageFlags stages = 0;
+			VkAccessFlags access = 0;
+			VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			bool isWrite = false;
+		};
+
+		static AccessInfo getAccessInfo(Access access);
+		static bool isDepthFormat(VkFormat format);
+		static VkImageAspectFlags getAspectMask(VkFormat format);
+
+		ResourceUse& findOrAddUse(uint32 passIndex, ResourceHandle resource);
+		void cullPasses();
+		void computeLifetimes();
+		void allocateTransientImages();
+		void computeBarriers();
+		void createRenderPasses(uint32 frameCount);
+		void recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch, std::size_t imageIndex) const;
+		uint32 findMemoryType(uint32 typeFilter, VkMemoryPropertyFlags properties) const;
+
+		VkImage getImage(const Resource& resource, std::size_t imageIndex) const;
+		VkImageView getView(const Resource& resource, std::size_t imageIndex) const;
+
+		VkDevice mDevice;
+		VkPhysicalDevice mPhysicalDevice;
+
+		std::vector<Resource> mResources;
+		std::vector<Pass> mPasses;
+		std::vector<uint32> mPassOrder; //Passes left after culling
+		std::vector<VkDeviceMemory> mTransientMemory;
+		BarrierBatch mFinalBarriers;
+		GpuProfiler* mpProfiler = nullptr;
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef QUBEENGINE_RENDER_SHADERCOMPILER_H_
+#define QUBEENGINE_RENDER_SHADERCOMPILER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <string>
+
+namespace qe::io
+{
+	class FileView;
+}
+
+namespace qe::render
+{
+	//Compiles GLSL to SPIR-V for the asset cooker and for the runtime, which compiles whatever the cooker did
+	//not. The stage comes from the extension of the source: .vert, .frag, .comp, .geom, .tesc or .tese.
+	//
+	//Built with QUBEENGINE_HAS_SHADERC, shaders are compiled in process by shaderc from the Vulkan SDK.
+	//Otherwise every compile runs glslangValidator and pipes the source into it, found through VULKAN_SDK and
+	//then PATH unless a path is given. Either way the code that is compiled is the one that was hashed, even
+	//if the file changes in between. Compiling is thread safe.
+	class ShaderCompiler
+	{
+	public:
+		//Part of the key of every shader, bump it when the compile step changes.
+		static constexpr uint32 VERSION = 1;
+
+		explicit ShaderCompiler(const std::string& validatorPath = "");
+		~ShaderCompiler();
+
+		ShaderCompiler(const ShaderCompiler&) = delete;
+		ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+		static bool isShader(const std::string& path);
+
+		//Hash of the stage and the contents of a source, which names its SPIR-V in a cache directory.
+		static uint64 computeSourceKey(const std::string& sourcePath, const io::FileView& source);
+
+		//Writes the SPIR-V of source to outputPath, through a temporary file so a failed compile leaves
+		//nothing behind. Returns false and prints the errors if the shader does not compile.
+		bool compile(const std::string& sourcePath, const io::FileView& source, const std::string& outputPath) const;
+
+	private:
+		static std::string findValidator();
+
+		std::string mValidatorPath;
+		void* mpCompiler = nullptr; //shaderc_compiler_t
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef QUBEENGINE_RENDER_SHADERLIBRARY_H_
+#define QUBEENGINE_RENDER_SHADERLIBRARY_H_
+
+#include <qubeengine/render/ShaderCompiler.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qe::io
+{
+	class AssetManifest;
+	class FileSystem;
+}
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::render
+{
+	//Finds the SPIR-V of the shaders the renderer loads and keeps it in step with their GLSL sources.
+	//
+	//A shader is taken from the asset manifest if the cooker compiled it, otherwise from the cache directory
+	//under the key of its source, and only compiled when neither has it. The cache directory is the one the
+	//cooker writes to and the names are the same, so nothing is compiled twice across runs or tools.
+	//
+	//While the renderer runs, update() polls the sources of every shader handed out. Edited ones are compiled
+	//on the job system, and once all of them are done the new binaries replace the old and update() reports
+	//it, so the renderer can rebuild its pipelines. A shader that does not compile keeps its last binary.
+	class ShaderLibrary
+	{
+	public:
+		static constexpr std::chrono::milliseconds POLL_INTERVAL = std::chrono::milliseconds(500);
+
+		ShaderLibrary(const io::FileSystem& fileSystem, const io::AssetManifest& manifest, const std::string& shaderDirectory,
+			const std::string& cacheDirectory, thread::JobSystem& jobSystem);
+		~ShaderLibrary();
+
+		ShaderLibrary(const ShaderLibrary&) = delete;
+		ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+		//Path of the SPIR-V for a source in the shader directory, compiled first if there is none. Safe to
+		//call from any thread. Throws if the shader can neither be found nor compiled.
+		std::string getBinaryPath(const std::string& sourceName);
+
+		//Call once per frame from one thread. Returns true when reloaded shaders have replaced the binaries
+		//getBinaryPath returns.
+		bool update();
+
+	private:
+		struct Shader
+		{
+			std::string sourceName;
+			std::string binaryPath;
+			uint64 sourceSize;
+			int64 sourceTime;
+			bool hasSource;	//Shipped without its source, nothing to watch
+		};
+
+		struct Reload
+		{
+			std::size_t shader;
+			std::future<std::string> binaryPath; //Empty if the shader failed to compile
+		};
+
+		//Returns an empty path if the shader cannot be compiled.
+		std::string findBinary(const std::string& sourcePath) const;
+
+		const io::FileSystem& mFileSystem;
+		const io::AssetManifest& mManifest;
+		std::string mShaderDirectory;
+		std::string mCacheDirectory;
+		thread::JobSystem& mJobSystem;
+		ShaderCompiler mCompiler;
+
+		std::mutex mMutex;
+		std::vector<Shader> mShaders;
+		std::vector<Reload> mReloads;
+		std::chrono::steady_clock::time_point mLastPoll;
+	};
+}
+
+#endif
\ No newline at end of file
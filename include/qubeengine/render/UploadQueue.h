@@ -0,0 +1,98 @@
+#ifndef QUBEENGINE_RENDER_UPLOADQUEUE_H_
+#define QUBEENGINE_RENDER_UPLOADQUEUE_H_
+
+#include <qubeengine/render/QueueTimeline.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace qe::render
+{
+	//Copies staged data into device local buffers and images without stalling the graphics queue.
+	//
+	//When the device has a transfer-only queue family the copies run there. Every resource is then released
+	//by the transfer queue and acquired by the graphics queue, which waits for the transfer timeline value
+	//of the batch, so uploads overlap rendering instead of being serialized with it. Without such a family
+	//both timelines are the same and the batches are recorded on the graphics queue with ordinary barriers.
+	//
+	//Uploads are recorded into a batch until flush() submits it. Nothing waits for the GPU; collect() frees
+	//the staging buffers of batches whose timeline values have been reached.
+	class UploadQueue
+	{
+	public:
+		UploadQueue(VkDevice device, uint32 transferFamily, QueueTimeline& transferTimeline, uint32 graphicsFamily, QueueTimeline& graphicsTimeline);
+		~UploadQueue();
+
+		UploadQueue(const UploadQueue&) = delete;
+		UploadQueue& operator=(const UploadQueue&) = delete;
+
+		//True if copies run on their own queue family and need ownership transfers.
+		bool isDedicated() const;
+
+		//Both take ownership of the staging buffer and free it once the copy has finished. dstUsage is how
+		//the graphics queue uses the buffer afterwards, it decides which stages wait for the copy.
+		void uploadBuffer(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkBuffer dstBuffer, VkDeviceSize size, VkBufferUsageFlags dstUsage);
+		//Both leave the image in SHADER_READ_ONLY_OPTIMAL for the fragment shader. uploadImage copies level 0,
+		//with more than one mip level the rest is blitted from it. Transfer queues cannot blit, so that part
+		//runs on the graphics queue after the ownership transfer. The image needs TRANSFER_SRC usage and a
+		//format that supports linear blits.
+		void uploadImage(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkImage dstImage, uint32 width, uint32 height, uint32 mipLevels = 1);
+		//Copies levels that were built ahead of time, one region per level.
+		void uploadImageLevels(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkImage dstImage, const std::vector<VkBufferImageCopy>& regions);
+		//Overwrites a buffer that frames in flight may be reading. The copy runs on the graphics queue behind a
+		//barrier against everything submitted there before, so earlier frames still see the old contents.
+		void updateBuffer(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkBuffer dstBuffer, VkDeviceSize size, VkBufferUsageFlags dstUsage);
+
+		void flush();
+		void collect();
+		void waitIdle();
+
+	private:
+		struct StagingBuffer
+		{
+			VkBuffer buffer;
+			VkDeviceMemory memory;
+		};
+
+		struct Batch
+		{
+			VkCommandBuffer transferCommandBuffer = VK_NULL_HANDLE;
+			VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE; //Only with a dedicated transfer family
+			VkPipelineStageFlags acquireStages = 0;
+			uint64 transferValue = 0;
+			uint64 acquireValue = 0;
+			std::vector<StagingBuffer> stagingBuffers;
+		};
+
+		static void getBufferScope(VkBufferUsageFlags usage, VkPipelineStageFlags& stages, VkAccessFlags& access);
+
+		void copyImage(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkImage dstImage, const VkBufferImageCopy* pRegions, uint32 regionCount, uint32 levelCount);
+		//Hands an image in TRANSFER_DST_OPTIMAL over to the graphics queue in newLayout.
+		void releaseImage(VkImage dstImage, uint32 levelCount, VkImageLayout newLayout, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess);
+		void generateMips(VkImage dstImage, uint32 width, uint32 height, uint32 mipLevels);
+		//Where commands that need the graphics queue are recorded, they run after the batch's copies.
+		VkCommandBuffer getGraphicsCommandBuffer() const;
+
+		void beginBatch();
+		void destroyBatch(Batch& batch);
+		VkCommandBuffer allocateCommandBuffer(VkCommandPool pool);
+		VkCommandPool createCommandPool(uint32 queueFamily);
+
+		VkDevice mDevice;
+		uint32 mTransferFamily;
+		uint32 mGraphicsFamily;
+		QueueTimeline& mTransferTimeline;
+		QueueTimeline& mGraphicsTimeline;
+
+		VkCommandPool mTransferCommandPool = VK_NULL_HANDLE;
+		VkCommandPool mGraphicsCommandPool = VK_NULL_HANDLE;
+
+		bool mIsRecording = false;
+		Batch mCurrentBatch;
+		std::vector<Batch> mPendingBatches;
+	};
+}
+
+#endif
\ No newline at end of file
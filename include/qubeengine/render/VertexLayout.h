@@ -0,0 +1,76 @@
+#ifndef QUBEENGINE_RENDER_VERTEXLAYOUT_H_
+#define QUBEENGINE_RENDER_VERTEXLAYOUT_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include <vector>
+
+namespace qe::render
+{
+	enum class PositionFormat : uint8
+	{
+		Float3,		//12 bytes, as loaded
+		Unorm16x4	//8 bytes, quantized relative to the bounds of the mesh, w is unused
+	};
+
+	enum class TexCoordFormat : uint8
+	{
+		Float2,		//8 bytes, as loaded
+		Half2,		//4 bytes, for texture coordinates that repeat the texture
+		Unorm16x2	//4 bytes, for texture coordinates within [0, 1]
+	};
+
+	//How vertices are stored in the vertex buffer: position at location 0 and texture coordinates at
+	//location 1, interleaved in one binding. Loaders keep full precision vertices and pack them with a
+	//layout right before they are uploaded or cooked.
+	//
+	//Quantized positions are unorms across the bounds of their mesh. The vertex shader maps them back with
+	//the offset and scale from getDequantization, which are the identity for float positions, so the same
+	//shader handles every layout. Attributes that are the same for every vertex have no format at all and
+	//are constants of the shaders instead.
+	class VertexLayout
+	{
+	public:
+		VertexLayout() = default;
+		VertexLayout(PositionFormat positionFormat, TexCoordFormat texCoordFormat);
+
+		//The smallest layout that keeps the texture coordinates exact enough. pTexCoords points at the first
+		//pair, stride is in bytes.
+		static VertexLayout choose(const float* pTexCoords, uint32 stride, std::size_t vertexCount);
+
+		//The smallest layout that holds vertices of both layouts as exactly as they are.
+		static VertexLayout combine(const VertexLayout& a, const VertexLayout& b);
+
+		//Identifies the layout in cooked meshes. fromKey returns false for keys that name no layout.
+		uint32 getKey() const;
+		static bool fromKey(uint32 key, VertexLayout& layout);
+
+		PositionFormat getPositionFormat() const;
+		TexCoordFormat getTexCoordFormat() const;
+		uint32 getStride() const;
+
+		VkVertexInputBindingDescription getBindingDescription(uint32 binding = 0) const;
+		std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(uint32 binding = 0) const;
+
+		//Position = offset + stored position * scale, for a mesh with the given bounds.
+		void getDequantization(const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec3& offset, glm::vec3& scale) const;
+
+		//Packs vertexCount vertices into pDestination, getStride() bytes each. Positions must lie within the
+		//bounds. pPositions and pTexCoords point at the attributes of the first vertex, stride is in bytes.
+		void pack(const float* pPositions, const float* pTexCoords, uint32 stride, uint32 vertexCount,
+			const glm::vec3& boundsMin, const glm::vec3& boundsMax, void* pDestination) const;
+
+		//Converts vertexCount vertices packed with sourceLayout for a mesh with the given bounds to this layout.
+		void repack(const VertexLayout& sourceLayout, const void* pSource, uint32 vertexCount,
+			const glm::vec3& boundsMin, const glm::vec3& boundsMax, void* pDestination) const;
+
+	private:
+		PositionFormat mPositionFormat = PositionFormat::Float3;
+		TexCoordFormat mTexCoordFormat = TexCoordFormat::Float2;
+	};
+}
+
+#endif
\ No newline at end of file
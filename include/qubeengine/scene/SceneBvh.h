@@ -0,0 +1,83 @@
+#ifndef QUBEENGINE_SCENE_SCENEBVH_H_
+#define QUBEENGINE_SCENE_SCENEBVH_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::scene
+{
+	struct Aabb
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+
+		void expand(const glm::vec3& point);
+		void expand(const Aabb& other);
+		glm::vec3 getCenter() const;
+
+		//An inverted box that any expand call replaces.
+		static Aabb empty();
+
+		//Bounds of the box after it has been moved by matrix (Arvo's method).
+		static Aabb transform(const Aabb& box, const glm::mat4& matrix);
+	};
+
+	//Eight wide bounding volume hierarchy over object bounds. Every node keeps the boxes of its children as 
+	//structure of arrays, so a frustum test covers all eight children at once with AVX (or two SSE halves).
+	class SceneBvh
+	{
+	public:
+		static const uint32 NODE_WIDTH = 8;
+
+		void build(const std::vector<Aabb>& objectBounds);
+		void clear();
+
+		//Appends the index of every object whose bounds touch the frustum. Planes are (normal, distance) with 
+		//the normals pointing inwards, in the same space as the object bounds. With a job system the subtrees 
+		//below the first couple of levels are culled on the worker threads.
+		void cullFrustum(const glm::vec4 planes[6], std::vector<uint32>& visibleObjects, thread::JobSystem* pJobSystem = nullptr) const;
+
+		std::size_t getNodeCount() const;
+		std::size_t getObjectCount() const;
+
+	private:
+		struct alignas(32) Node
+		{
+			float minX[NODE_WIDTH];
+			float minY[NODE_WIDTH];
+			float minZ[NODE_WIDTH];
+			float maxX[NODE_WIDTH];
+			float maxY[NODE_WIDTH];
+			float maxZ[NODE_WIDTH];
+
+			//>= 0 is the index of a child node, < 0 is the bitwise not of an object index.
+			int32 children[NODE_WIDTH];
+			uint32 childCount;
+		};
+
+		uint32 buildNode(std::vector<uint32>& objects, uint32 begin, uint32 end,
+			const std::vector<Aabb>& objectBounds, const std::vector<glm::vec3>& centroids);
+
+		//Returns the bit masks of children that touch the frustum and of children that are completely inside it.
+		static void testNode(const Node& node, const glm::vec4 planes[6], uint32& visibleMask, uint32& insideMask);
+
+		void cullNode(uint32 nodeIndex, const glm::vec4 planes[6], std::vector<uint32>& visibleObjects) const;
+		void collectNode(uint32 nodeIndex, std::vector<uint32>& visibleObjects) const;
+		void visitChildren(uint32 nodeIndex, const glm::vec4 planes[6], std::vector<uint32>& visibleObjects, std::vector<uint32>* pIntersectedNodes) const;
+
+		std::vector<Node> mNodes;
+		std::size_t mObjectCount = 0;
+	};
+}
+
+#endif
\ No newline at end of file
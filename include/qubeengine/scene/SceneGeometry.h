@@ -0,0 +1,88 @@
+#ifndef QUBEENGINE_SCENE_SCENEGEOMETRY_H_
+#define QUBEENGINE_SCENE_SCENEGEOMETRY_H_
+
+#include <qubeengine/io/MeshCache.h>
+#include <qubeengine/mesh/MeshCooker.h>
+#include <qubeengine/render/VertexLayout.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace qe::io
+{
+	class AssetManifest;
+}
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::scene
+{
+	//The meshes of every model of a scene in one vertex arena and one index arena, so the whole scene is drawn
+	//from a single vertex and index buffer and each of them is uploaded with one copy.
+	//
+	//Models are loaded in parallel on the job system: from the output of the asset cooker, from the mesh
+	//cache next to the OBJ file or by cooking the OBJ file, in that order. Their submeshes are appended in
+	//model order with offsets into the arenas. Models are copied into the arenas straight from their mapped
+	//caches, and converted on the way if their vertex layout or index size differs from that of the arenas.
+	class SceneGeometry
+	{
+	public:
+		//Throws if a model cannot be loaded.
+		void load(const io::FileSystem& fileSystem, const std::vector<std::string>& meshPaths, const io::AssetManifest& manifest, thread::JobSystem& jobSystem);
+
+		//Drops the loaded models once the arenas were copied. The submeshes stay.
+		void release();
+
+		const render::VertexLayout& getVertexLayout() const;
+		uint32 getIndexSize() const;
+
+		//Submeshes of all models, those of a model are a contiguous range.
+		const std::vector<mesh::Submesh>& getSubmeshes() const;
+		uint32 getFirstSubmesh(uint32 model) const;
+		uint32 getSubmeshCount(uint32 model) const;
+
+		std::size_t getVertexDataSize() const;
+		std::size_t getIndexDataSize() const;
+
+		//Write the arenas, getVertexDataSize and getIndexDataSize bytes. Models are copied in parallel.
+		void copyVertices(void* pDestination) const;
+		void copyIndices(void* pDestination) const;
+
+	private:
+		struct Model
+		{
+			io::MeshCache cache;		//Open if the model was read from a cache
+			mesh::CookedMesh cooked;	//Otherwise the model as it was cooked
+			render::VertexLayout vertexLayout;
+			uint32 indexSize;
+			const void* pVertices;
+			uint32 vertexCount;
+			const void* pIndices;
+			uint32 indexCount;
+			std::vector<mesh::Submesh> submeshes;
+			uint32 firstSubmesh;
+			uint32 baseVertex;
+			uint32 baseIndex;
+		};
+
+		static void loadModel(const io::FileSystem& fileSystem, const std::string& path, const io::AssetManifest& manifest, thread::JobSystem& jobSystem,
+			Model& model);
+		static bool openCache(const io::FileSystem& fileSystem, const std::string& cachePath, uint64 sourceKey, Model& model);
+
+		std::vector<std::unique_ptr<Model>> mModels;
+		std::vector<mesh::Submesh> mSubmeshes;
+		std::vector<uint32> mFirstSubmeshes; //Per model, plus the total
+		render::VertexLayout mVertexLayout;
+		uint32 mIndexSize = 2;
+		uint32 mVertexCount = 0;
+		uint32 mIndexCount = 0;
+		thread::JobSystem* mpJobSystem = nullptr;
+	};
+}
+
+#endif
\ No newline at end of file
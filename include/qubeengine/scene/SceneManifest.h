@@ -0,0 +1,56 @@
+#ifndef QUBEENGINE_SCENE_SCENEMANIFEST_H_
+#define QUBEENGINE_SCENE_SCENEMANIFEST_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace qe::io
+{
+	class FileSystem;
+}
+
+namespace qe::scene
+{
+	//A mesh with the texture it is drawn with. Paths are relative to the resource directory.
+	struct SceneModel
+	{
+		std::string name;
+		std::string meshPath;
+		std::string texturePath;
+	};
+
+	//A placed copy of a model: scaled, turned around the z axis, then moved to position.
+	struct SceneInstance
+	{
+		uint32 model;
+		glm::vec3 position;
+		float rotation; //Degrees
+		float scale;
+	};
+
+	//What a scene is made of, read from a text file with one statement per line:
+	//
+	//	model <name> <mesh path> <texture path>
+	//	instance <model name> <x> <y> <z> [<rotation> [<scale>]]
+	//
+	//Models have to be declared before their instances. Empty lines and lines starting with # are skipped.
+	class SceneManifest
+	{
+	public:
+		//Throws if the file cannot be read, a line is malformed or the scene has no instances.
+		void load(const io::FileSystem& fileSystem, const std::string& path);
+
+		const std::vector<SceneModel>& getModels() const;
+		const std::vector<SceneInstance>& getInstances() const;
+
+	private:
+		std::vector<SceneModel> mModels;
+		std::vector<SceneInstance> mInstances;
+	};
+}
+
+#endif
\ No newline at end of file
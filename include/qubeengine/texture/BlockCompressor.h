@@ -0,0 +1,50 @@
+#ifndef QUBEENGINE_TEXTURE_BLOCKCOMPRESSOR_H_
+#define QUBEENGINE_TEXTURE_BLOCKCOMPRESSOR_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::texture
+{
+	//Formats of cooked textures, all of them sRGB.
+	enum class TextureFormat : uint8
+	{
+		Rgba8,	//4 bytes per texel, as decoded
+		Bc1,	//8 bytes per 4x4 block, opaque color only
+		Bc7		//16 bytes per 4x4 block, color and alpha
+	};
+
+	//Encodes RGBA8 images into BC1 and BC7 blocks on the CPU, so textures can be cooked without a GPU or an
+	//external tool.
+	//
+	//Both encoders fit a line through the colors of a block with its principal axis, quantize the two ends
+	//and pick the closest palette entry for every texel, then refit the ends to those choices once with
+	//least squares. BC7 blocks use mode 6 only, one subset with 7 bit RGBA endpoints and 16 palette entries.
+	//That is well below what an exhaustive encoder reaches but fast enough to cook while loading.
+	class BlockCompressor
+	{
+	public:
+		static bool isCompressed(TextureFormat format);
+
+		//Bytes of a level, whole blocks for compressed formats.
+		static std::size_t getLevelSize(TextureFormat format, uint32 width, uint32 height);
+
+		//Encodes an RGBA8 level into pDestination, getLevelSize bytes. Blocks that reach past the right or
+		//bottom edge repeat the last column or row.
+		static void compress(TextureFormat format, const uint8* pPixels, uint32 width, uint32 height, uint8* pDestination,
+			thread::JobSystem* pJobSystem = nullptr);
+
+	private:
+		//pBlock holds the 16 texels of a block as RGBA8, row by row.
+		static void encodeBc1(const uint8* pBlock, uint8* pDestination);
+		static void encodeBc7(const uint8* pBlock, uint8* pDestination);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef QUBEENGINE_TEXTURE_IMAGEDECODER_H_
+#define QUBEENGINE_TEXTURE_IMAGEDECODER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::texture
+{
+	//Decodes images with stb_image into memory the caller owns, usually level 0 of a mip chain.
+	//
+	//stb_image decodes to the channel count of the file. Asking it for RGBA makes it convert into one more
+	//buffer of its own, which would then be copied again, so images are expanded to RGBA8 here instead: RGB
+	//with SSSE3 or AVX2 shuffles, rows spread over the job system. Decoding is thread safe, so every texture
+	//a job system loads at the same time is decoded on its own worker.
+	class ImageDecoder
+	{
+	public:
+		//Reads the extent from the header without decoding. Returns false if stb_image cannot read the image.
+		static bool getInfo(const uint8* pSource, std::size_t sourceSize, uint32& width, uint32& height);
+
+		//Decodes into pDestination, 4 * width * height bytes of RGBA8 with the extent getInfo returned.
+		//Returns false if the image cannot be decoded.
+		static bool decode(const uint8* pSource, std::size_t sourceSize, uint32 width, uint32 height, uint8* pDestination,
+			thread::JobSystem* pJobSystem = nullptr);
+
+		//Expands texels of 1 to 4 channels to RGBA8. Grey is copied to all three colors, missing alpha is opaque.
+		static void expandToRgba(const uint8* pSource, uint32 channelCount, std::size_t texelCount, uint8* pDestination);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef QUBEENGINE_TEXTURE_MIPCHAIN_H_
+#define QUBEENGINE_TEXTURE_MIPCHAIN_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::texture
+{
+	//Builds the mip levels of RGBA8 images on the CPU, for formats the GPU cannot blit with linear filtering
+	//and for textures that are cooked ahead of time.
+	//
+	//The levels are stored one after another without padding, level 0 first. Every level is a 2x2 box filter
+	//of the one above it, computed in 16 bits per channel so rounding does not add up over the chain. For sRGB
+	//images the color channels are filtered in linear space, alpha always is. Level 0 is converted to 16 bits
+	//and rows are filtered with SSE2 or AVX2, spread over the job system.
+	class MipChain
+	{
+	public:
+		//A full chain down to 1x1.
+		static uint32 getLevelCount(uint32 width, uint32 height);
+
+		static uint32 getLevelExtent(uint32 extent, uint32 level);
+
+		//Byte offsets of the levels in a chain, the last entry is the size of the whole chain.
+		static std::vector<std::size_t> getLevelOffsets(uint32 width, uint32 height, uint32 levelCount);
+
+		//Fills levels 1 to levelCount - 1 of pChain from level 0, which must already be in place.
+		static void generate(uint8* pChain, uint32 width, uint32 height, uint32 levelCount, bool isSrgb, thread::JobSystem* pJobSystem = nullptr);
+
+	private:
+		//Rows of level 0 from 8 to 16 bits per channel.
+		static void decodeRows(const uint8* pSource, uint32 width, uint16* pDestination, uint32 beginRow, uint32 endRow, bool isSrgb);
+		//Rows of a level in 16 bits per channel.
+		static void downsampleRows(const uint16* pSource, uint32 sourceWidth, uint32 sourceHeight, uint16* pDestination, uint32 width,
+			uint32 beginRow, uint32 endRow);
+		static void encodeRows(const uint16* pSource, uint32 width, uint8* pDestination, uint32 beginRow, uint32 endRow, bool isSrgb);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef QUBEENGINE_TEXTURE_TEXTURECOOKER_H_
+#define QUBEENGINE_TEXTURE_TEXTURECOOKER_H_
+
+#include <qubeengine/texture/BlockCompressor.h>
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace qe::thread
+{
+	class JobSystem;
+}
+
+namespace qe::texture
+{
+	//A texture with its whole mip chain in the layout of the texture cache.
+	struct CookedTexture
+	{
+		TextureFormat format;
+		uint32 width;
+		uint32 height;
+		uint32 levelCount;
+		std::vector<uint8> data;
+		std::vector<std::size_t> levelOffsets; //levelCount + 1 entries, the last one is the size of data
+	};
+
+	//Turns an encoded image (JPEG, PNG and whatever else stb_image reads) into a cooked texture: decoded to
+	//sRGB RGBA8, filtered down to 1x1 with MipChain and encoded level by level.
+	class TextureCooker
+	{
+	public:
+		//Levels start at multiples of this, enough for any block size and for buffer to image copies.
+		static constexpr std::size_t LEVEL_ALIGNMENT = 16;
+
+		//Returns false if the image cannot be decoded.
+		static bool cook(const uint8* pSource, std::size_t sourceSize, TextureFormat format, CookedTexture& texture,
+			thread::JobSystem* pJobSystem = nullptr);
+
+		//Writes the texture to a texture cache, see io::TextureCache::write.
+		static bool write(const std::string& path, uint64 sourceKey, const CookedTexture& texture);
+	};
+}
+
+#endif
\ No newline at end of file
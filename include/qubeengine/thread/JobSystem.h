@@ -0,0 +1,61 @@
+#ifndef QUBEENGINE_THREAD_JOBSYSTEM_H_
+#define QUBEENGINE_THREAD_JOBSYSTEM_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace qe::thread
+{
+	//Fixed pool of worker threads. Runs one-off jobs that hand their result back through a future, and data 
+	//parallel loops that are split into chunks across the workers.
+	class JobSystem
+	{
+	public:
+		//A thread count of 0 starts one worker per hardware thread, leaving one for the calling thread.
+		explicit JobSystem(uint32 threadCount = 0);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		template<typename Function>
+		auto submit(Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>>>
+		{
+			using ResultType = std::invoke_result_t<std::decay_t<Function>>;
+
+			//std::function needs a copyable target, so the packaged task lives behind a shared pointer.
+			auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function));
+			std::future<ResultType> future = task->get_future();
+			enqueue([task]() { (*task)(); });
+
+			return future;
+		}
+
+		//Splits [0, count) into ranges of at most grainSize elements and runs them across the workers. The 
+		//calling thread works on ranges too, so this is safe to call from inside another job.
+		void parallelFor(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t begin, std::size_t end)>& function);
+
+		uint32 getThreadCount() const;
+
+	private:
+		void enqueue(std::function<void()> job);
+		void workerLoop();
+
+		std::vector<std::thread> mWorkers;
+		std::deque<std::function<void()>> mJobs;
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		bool mIsStopping = false;
+	};
+}
+
+#endif
\ No newline at end of file
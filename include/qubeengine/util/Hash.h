@@ -0,0 +1,73 @@
+#ifndef QUBEENGINE_UTIL_HASH_H_
+#define QUBEENGINE_UTIL_HASH_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+#include <cstring>
+
+namespace qe::util
+{
+	static const uint64 FNV_OFFSET_BASIS = 14695981039346656037ull;
+	static const uint64 FNV_PRIME = 1099511628211ull;
+
+	//64 bit FNV-1a over raw bytes. Pass a previous result as the seed to hash several pieces as one.
+	inline uint64 hashBytes(const void* pData, std::size_t size, uint64 seed = FNV_OFFSET_BASIS)
+	{
+		const uint8* pBytes = static_cast<const uint8*>(pData);
+		uint64 hash = seed;
+
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= pBytes[i];
+			hash *= FNV_PRIME;
+		}
+
+		return hash;
+	}
+
+	//Finalizer of MurmurHash3. Every input bit affects every output bit, so the low bits can index a table.
+	inline uint64 mixBits(uint64 value)
+	{
+		value ^= value >> 33;
+		value *= 0xFF51AFD7ED558CCDull;
+		value ^= value >> 33;
+		value *= 0xC4CEB9FE1A85EC53ull;
+		value ^= value >> 33;
+
+		return value;
+	}
+
+	//Consumes eight bytes per step instead of one, for short keys that are hashed in bulk such as vertices.
+	//Results depend on the byte order of the machine, so do not store them.
+	inline uint64 hashWords(const void* pData, std::size_t size, uint64 seed = FNV_OFFSET_BASIS)
+	{
+		const uint8* pBytes = static_cast<const uint8*>(pData);
+		uint64 hash = seed ^ (size * FNV_PRIME);
+
+		for (; size >= sizeof(uint64); size -= sizeof(uint64), pBytes += sizeof(uint64))
+		{
+			uint64 word;
+			std::memcpy(&word, pBytes, sizeof(uint64));
+			hash = (hash ^ mixBits(word)) * FNV_PRIME;
+		}
+
+		if (size > 0)
+		{
+			uint64 word = 0;
+			std::memcpy(&word, pBytes, size);
+			hash = (hash ^ mixBits(word)) * FNV_PRIME;
+		}
+
+		return mixBits(hash);
+	}
+
+	//Hashes a trivially copyable value. Only use it on types without padding, padding bytes are not reliable.
+	template<typename T>
+	inline uint64 hashValue(const T& value, uint64 seed = FNV_OFFSET_BASIS)
+	{
+		return hashBytes(&value, sizeof(T), seed);
+	}
+}
+
+#endif
\ No newline at end of file
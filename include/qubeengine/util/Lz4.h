@@ -0,0 +1,37 @@
+#ifndef QUBEENGINE_UTIL_LZ4_H_
+#define QUBEENGINE_UTIL_LZ4_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <cstddef>
+
+namespace qe::util
+{
+	//Compresses single blocks in the LZ4 block format: runs of literals and copies of up to 64 KiB back.
+	//Decompression is a few copies per sequence, fast enough to run on load. The compressor is the plain
+	//greedy one, it runs ahead of time.
+	class Lz4
+	{
+	public:
+		//Most bytes compress can write for size bytes of input.
+		static std::size_t getMaxCompressedSize(std::size_t size);
+
+		//Returns the number of bytes written to pDestination, which needs getMaxCompressedSize(size) bytes.
+		static std::size_t compress(const uint8* pSource, std::size_t size, uint8* pDestination);
+
+		//Returns false unless the block decompresses to exactly destinationSize bytes. Damaged blocks are
+		//rejected without reading or writing out of bounds.
+		static bool decompress(const uint8* pSource, std::size_t sourceSize, uint8* pDestination, std::size_t destinationSize);
+
+	private:
+		static constexpr std::size_t MIN_MATCH = 4;
+		static constexpr std::size_t LAST_LITERALS = 5; //The format ends every block with at least this many literals
+		static constexpr std::size_t MATCH_LIMIT = 12; //and starts no copy in the last MATCH_LIMIT bytes
+		static constexpr std::size_t MAX_OFFSET = 65535;
+		static constexpr uint32 HASH_BITS = 16;
+
+		static uint8* writeLength(uint8* pDestination, std::size_t length);
+	};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef QUBEENGINE_UTIL_PROFILER_H_
+#define QUBEENGINE_UTIL_PROFILER_H_
+
+#include <qubeengine/util/Typedefs.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace qe::util
+{
+	//Collects timed zones from any thread, and from the GPU, into one trace that can be opened in
+	//chrome://tracing or Perfetto. Every thread gets its own track, other sources such as a GPU queue add
+	//theirs with addTrack(). Zones are only recorded between beginCapture() and endCapture().
+	class Profiler
+	{
+	public:
+		static Profiler& instance()
+		{
+			static Profiler sInstance;
+			return sInstance;
+		}
+
+		//Microseconds since the profiler was first used, on the clock all tracks share.
+		static double now();
+
+		Profiler(const Profiler&) = delete;
+		Profiler& operator=(const Profiler&) = delete;
+
+		uint32 addTrack(const std::string& name);
+		uint32 getThreadTrack();
+
+		void beginCapture();
+		//Writes the captured zones as Chrome trace JSON and stops capturing.
+		bool endCapture(const std::string& path);
+		bool isCapturing() const;
+
+		void addZone(const std::string& name, uint32 track, double start, double duration);
+
+	private:
+		struct Zone
+		{
+			std::string name;
+			uint32 track;
+			double start;
+			double duration;
+		};
+
+		Profiler() = default;
+
+		static void writeEscaped(std::string& out, const std::string& text);
+
+		mutable std::mutex mMutex;
+		std::vector<std::string> mTracks;
+		std::vector<Zone> mZones;
+		std::atomic<bool> mIsCapturing{ false };
+	};
+
+	//Times the scope it lives in. pElapsed, if given, receives the duration in microseconds even when the
+	//profiler is not capturing, so the same zone can feed frame statistics.
+	class ProfileZone
+	{
+	public:
+		explicit ProfileZone(const char* pName, double* pElapsed = nullptr);
+		~ProfileZone();
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+	private:
+		const char* mpName;
+		double* mpElapsed;
+		double mStart;
+	};
+}
+
+#define QE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define QE_PROFILE_CONCAT(a, b) QE_PROFILE_CONCAT_IMPL(a, b)
+#define QE_PROFILE_ZONE(name) qe::util::ProfileZone QE_PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+#endif
\ No newline at end of file
@@ -11,77 +11,113 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include <qubeengine/asset/AssetManager.h>
+#include <qubeengine/io/AssetManifest.h>
+#include <qubeengine/mesh/MeshCooker.h>
+#include <qubeengine/render/BindlessTextureTable.h>
+#include <qubeengine/render/DescriptorAllocator.h>
+#include <qubeengine/render/GpuProfiler.h>
+#include <qubeengine/render/PipelineCache.h>
+#include <qubeengine/render/PipelineVariants.h>
+#include <qubeengine/render/QueueTimeline.h>
+#include <qubeengine/render/RenderGraph.h>
+#include <qubeengine/render/ShaderLibrary.h>
+#include <qubeengine/render/UploadQueue.h>
+#include <qubeengine/render/VertexLayout.h>
+#include <qubeengine/scene/SceneBvh.h>
+#include <qubeengine/scene/SceneGeometry.h>
+#include <qubeengine/scene/SceneManifest.h>
+#include <qubeengine/thread/JobSystem.h>
+#include <qubeengine/util/Profiler.h>
 
 #include <chrono>
+#include <functional>
+#include <future>
 #include <vector>
 #include <optional>
 #include <array>
 #include <string>
+#include <memory>
 
 namespace qe
 {
 	struct UniformBufferObject 
+	{
+		//proj * view * scene rotation, multiplied once on the CPU instead of for every vertex. Takes the 
+		//space of InstanceData::model to clip space.
+		glm::mat4 viewProjModel;
+
+		//Planes of viewProjModel in the form (normal, distance). The culling compute shader tests instance 
+		//bounding spheres against these, so they are in the same space as InstanceData::model.
+		glm::vec4 frustumPlanes[6];
+
+		//xyz = camera position in the space of the frustum planes, w = distance at which one unit of 
+		//simplification error covers LOD_ERROR_PIXELS. Used to pick the level of detail of every instance.
+		glm::vec4 lodCamera;
+	};
+
+	//One entry per drawn object. Read by the culling compute shader and by the vertex shader through the 
+	//compacted visible instance list. Padded so the layout matches std430 in the shaders.
+	struct InstanceData
 	{
 		glm::mat4 model;
-		glm::mat4 view;
-		glm::mat4 proj;
+		uint32 meshIndex;
+		uint32 textureIndex; //Into the bindless texture table, unused without descriptor indexing where every model binds its own set
+		uint32 padding[2];
 	};
 
-	struct Vertex
+	//One entry per mesh (index range) in the shared vertex and index buffers. Every mesh owns one indirect 
+	//draw command and a region of the visible instance list starting at visibleBase. The levels of detail of 
+	//a submesh are meshes of their own right after its full mesh, instances only reference the full one.
+	struct MeshData
 	{
-		glm::vec3 pos;
-		glm::vec3 color;
-		glm::vec2 texCoord;
-
-		//A vertex binding describes at which rate to load data from memory throughout the vertices.
-		//It specifies the number of bytes between data entriesand whether to move to the next data entry after 
-		//each vertex or after each instance.
-		inline static VkVertexInputBindingDescription getBindingDescription()
-		{
-			VkVertexInputBindingDescription bindingDescription = {};
-			bindingDescription.binding = 0;
-			bindingDescription.stride = sizeof(Vertex);
-			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		glm::vec4 boundingSphere; //xyz = center in mesh space, w = radius
+		glm::vec4 positionOffset; //xyz = position of a stored (0, 0, 0), see render::VertexLayout
+		glm::vec4 positionScale; //xyz = scale of the stored positions
+		uint32 visibleBase;
+		uint32 lodCount;
+		uint32 padding[2];
+		glm::vec4 lodErrors; //Simplification error of every level of detail in mesh space, see mesh::SubmeshLod
+	};
 
-			return bindingDescription;
-		}
+	enum class CullingMode
+	{
+		Gpu,	//Compute shader tests every instance
+		Cpu		//SIMD BVH traversal, results are copied into the same draw buffers
+	};
 
-		//An attribute description struct describes how to extract a vertex attribute from a chunk of vertex data 
-		//originating from a binding description. We have two attributes, position and color, so we need two attribute 
-		//description structs.
-		static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions()
-		{
-			std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = {};
-			attributeDescriptions[0].binding = 0;
-			attributeDescriptions[0].location = 0;
-			attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[0].offset = offsetof(Vertex, pos);
-
-			attributeDescriptions[1].binding = 0;
-			attributeDescriptions[1].location = 1;
-			attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-			attributeDescriptions[2].binding = 0;
-			attributeDescriptions[2].location = 2;
-			attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-			attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
-
-			return attributeDescriptions;
-		}
+	//Shaders of a render::PipelineKey.
+	enum class PipelineProgram : uint32
+	{
+		Draw,	//shader.vert with shader.frag or bindless.frag
+		Cull,	//cull.comp
+		Depth	//depth.vert without a fragment shader
+	};
 
-		bool operator==(const Vertex& other) const 
-		{
-			return pos == other.pos && color == other.color && texCoord == other.texCoord;
-		}
+	//Matches the push constant block shared by the culling compute shader and the vertex shader.
+	struct DrawPushConstants
+	{
+		uint32 instanceCount;
+		uint32 visibleBase;
+	};
+
+	//Where the frame time went since the last report, summed in microseconds. Time spent waiting on the
+	//graphics timeline means the CPU is ahead and the frame is GPU bound, time spent in acquire and
+	//present means it is bound by presentation, and the rest is CPU work.
+	struct FrameStats
+	{
+		double cpuTime = 0.0;
+		double gpuWaitTime = 0.0;
+		double presentTime = 0.0;
+		double gpuTime = 0.0;	//Measured with timestamp queries
+		uint32 frameCount = 0;
 	};
 
 	struct QueueFamilyIndices
 	{
 		std::optional<uint32> graphicsFamily;
 		std::optional<uint32> presentFamily;
+		std::optional<uint32> transferFamily; //Only set for a family without graphics support
 
 		bool isComplete()
 		{
@@ -102,6 +138,8 @@ namespace qe
 		static const int WINDOW_WIDTH;
 		static const int WINDOW_HEIGHT;
 		static const bool ENABLE_VAL_LAYERS;
+		static constexpr uint32 DEFAULT_FRAMES_IN_FLIGHT = 2;
+		static constexpr uint32 MAX_FRAMES_IN_FLIGHT = 4;
 
 		static VkResult createDebugUtilsMessengerEXT(VkInstance instance,
 			const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator,
@@ -109,14 +147,16 @@ namespace qe
 
 		static void destroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator);
 
-		VulkanTutorial();
+		//More frames in flight let the CPU run further ahead of the GPU at the cost of latency.
+		VulkanTutorial(uint32 framesInFlight = DEFAULT_FRAMES_IN_FLIGHT);
 
 		void run();
 
 	private:
 		const std::vector<const char*> mDeviceExtensions;
 		const std::vector<const char*> mValidationLayers;
-		static const int MAX_FRAMES_IN_FLIGHT = 2;
+		const uint32 mFramesInFlight;
+		static const uint32 BINDLESS_TEXTURE_CAPACITY = 4096;
 
 		GLFWwindow* mpWindow = nullptr;
 
@@ -129,35 +169,58 @@ namespace qe
 		
 		VkQueue mGraphicsQueue = nullptr;
 		VkQueue mPresentQueue = nullptr;
+		VkQueue mTransferQueue = nullptr; //Same as mGraphicsQueue without a dedicated transfer family
+		std::unique_ptr<render::QueueTimeline> mpGraphicsTimeline;
+		std::unique_ptr<render::QueueTimeline> mpTransferTimeline; //Only with a dedicated transfer family
+		std::unique_ptr<render::UploadQueue> mpUploadQueue;
 		
 		VkSwapchainKHR mSwapchain = nullptr;
 		std::vector<VkImage> mSwapchainImages;
 		VkFormat mSwapchainImageFormat;
 		VkExtent2D mSwapchainExtent;
 		std::vector<VkImageView> mSwapchainImageViews;
-		std::vector<VkFramebuffer> mSwapchainFramebuffers;
 		
-		VkRenderPass mRenderPass;
+		std::unique_ptr<render::RenderGraph> mpRenderGraph;
+		uint32 mDepthPrepass = 0;
+		uint32 mMainPass = 0;
 		VkDescriptorSetLayout mDescriptorSetLayout;
 		VkPipelineLayout mPipelineLayout;
-		VkPipeline mGraphicsPipeline;
+		//Every pipeline variant the frame uses, looked up by key when the command buffers are recorded.
+		std::unique_ptr<render::PipelineCache> mpPipelineCache;
+		std::unique_ptr<render::PipelineVariants> mpPipelines;
+
+		//Variants built from reloaded shaders on the job system while frames keep using the current ones.
+		std::future<void> mPipelineRebuild;
+		std::unique_ptr<render::PipelineVariants> mpRebuiltPipelines;
 
 		VkCommandPool mCommandPool;
 		std::vector<VkCommandBuffer> mCommandBuffers;
 
 		std::vector<VkSemaphore> mImageAvailableSemaphores;
 		std::vector<VkSemaphore> mRenderFinishedSemaphores;
-		std::vector<VkFence> mInFlightFences;
-		std::vector<VkFence> mImagesInFlight;
+		std::vector<uint64> mFrameTimelineValues;	//Graphics timeline value of the last submission per frame slot
+		std::vector<uint64> mImageTimelineValues;	//And per swapchain image
+		std::unique_ptr<render::GpuProfiler> mpGpuProfiler;
+		FrameStats mFrameStats;
+		bool mTraceKeyWasPressed = false;
 		std::size_t mCurrentFrame = 0;
 		
 		bool mFramebufferResized = false;
-		std::string modelPath;
-		std::string texturePath;
-		const std::string RES_FILE = "../../../../res/resource_locations.txt";
-
-		std::vector<Vertex> mVertices;
-		std::vector<uint32_t> mIndices;
+		const std::string SCENE_FILE = "scenes/default.scene"; //Relative to the resource directory
+		std::string mResDirectory;
+		io::FileSystem mFileSystem; //Shaders, the scene and assets are all opened through it
+		scene::SceneManifest mScene;
+
+		//Written by QubeAssetCooker. Assets it lists are opened from their cooked files without touching 
+		//the sources, everything else is loaded and cooked at runtime.
+		io::AssetManifest mAssetManifest;
+		//Compiles the shaders the manifest does not list and watches their sources.
+		std::unique_ptr<render::ShaderLibrary> mpShaderLibrary;
+
+		//Every model of the scene, kept on the CPU until the vertex and index buffers are staged.
+		scene::SceneGeometry mSceneGeometry;
+		render::VertexLayout mVertexLayout;
+		VkIndexType mIndexType = VK_INDEX_TYPE_UINT32;
 		VkBuffer mVertexBuffer;
 		VkDeviceMemory mVertexBufferMemory;
 
@@ -167,17 +230,59 @@ namespace qe
 		std::vector<VkBuffer> mUniformBuffers;
 		std::vector<VkDeviceMemory> mUniformBuffersMemory;
 
-		VkDescriptorPool mDescriptorPool;
+		std::unique_ptr<render::DescriptorAllocator> mpDescriptorAllocator;
 		std::vector<VkDescriptorSet> mDescriptorSets;
+		std::vector<std::vector<VkDescriptorSet>> mModelDescriptorSets; //Per swapchain image and model, without bindless textures
 
-		VkImage mTextureImage;
-		VkDeviceMemory mTextureImageMemory;
-		VkImageView mTextureImageView;
+		//Textures stream in through the asset manager. With bindless textures every model samples the 
+		//fallback until its texture is resident. Without them every model is drawn with a descriptor set 
+		//holding its own texture, and initVulkan waits for all of them.
+		std::unique_ptr<asset::AssetManager> mpAssetManager;
+		std::vector<asset::TextureHandle> mModelTextures; //Per model of the scene
 		VkSampler mTextureSampler;
-
-		VkImage mDepthImage;
-		VkDeviceMemory mDepthImageMemory;
-		VkImageView mDepthImageView;
+		bool mSupportsTextureCompression = false;
+
+		bool mSupportsBindless = false;
+		std::unique_ptr<render::BindlessTextureTable> mpBindlessTextures;
+		VkImage mFallbackTextureImage;
+		VkDeviceMemory mFallbackTextureImageMemory;
+		VkImageView mFallbackTextureImageView;
+
+		std::unique_ptr<thread::JobSystem> mpJobSystem;
+
+		std::vector<mesh::Submesh> mSubmeshes;
+		std::vector<MeshData> mMeshes;
+		std::vector<uint32> mMeshSubmeshes; //Submesh every mesh draws a level of detail of
+		std::vector<InstanceData> mInstances;
+		std::vector<uint32> mInstanceModels; //Scene model of every instance
+		std::vector<uint32> mModelFirstMeshes; //First mesh of every model, followed by the mesh count
+		std::vector<VkDrawIndexedIndirectCommand> mDrawCommandTemplate;
+		uint32 mVisibleInstanceCapacity = 0; //Sum of the regions of all meshes
+		bool mSupportsMultiDrawIndirect = false;
+
+		VkBuffer mInstanceBuffer;
+		VkDeviceMemory mInstanceBufferMemory;
+		VkBuffer mMeshBuffer;
+		VkDeviceMemory mMeshBufferMemory;
+		VkBuffer mDrawCommandTemplateBuffer;
+		VkDeviceMemory mDrawCommandTemplateBufferMemory;
+
+		std::vector<VkBuffer> mDrawCommandBuffers;
+		std::vector<VkDeviceMemory> mDrawCommandBuffersMemory;
+		std::vector<VkBuffer> mVisibleInstanceBuffers;
+		std::vector<VkDeviceMemory> mVisibleInstanceBuffersMemory;
+
+		CullingMode mCullingMode = CullingMode::Gpu;
+		bool mCullingKeyWasPressed = false;
+		bool mUseDepthPrepass = false;
+		bool mDepthPrepassKeyWasPressed = false;
+		glm::vec4 mFrustumPlanes[6];
+		glm::vec4 mLodCamera;
+		scene::SceneBvh mSceneBvh;
+		std::vector<uint32> mCpuVisibleInstances;
+		std::vector<VkDrawIndexedIndirectCommand> mCpuDrawCommands;
+		std::vector<VkBuffer> mCpuCullingBuffers;
+		std::vector<VkDeviceMemory> mCpuCullingBuffersMemory;
 
 		glm::vec3 mCameraPosition = glm::vec3(3.0f, 3.0f, 2.5f);
 
@@ -231,20 +336,30 @@ namespace qe
 		///Section 3 - Setup
 		
 		//Tutorial 9: Introduction
+		//Bits of render::PipelineKey::features.
+		static constexpr uint32 PIPELINE_BINDLESS_TEXTURES = 1;	//Samples the texture table in set 1
+		static constexpr uint32 PIPELINE_DEPTH_EQUAL = 2;		//Tests against the depth prepass, writes no depth
+
+		void createPipelineCache();
+		//Creates the pipeline layout and builds every variant the frame uses.
 		void createGraphicsPipeline();
+		std::vector<render::PipelineKey> getPipelineKeys() const;
+		render::PipelineKey getDrawPipelineKey() const;
+		//Use the current binaries of the shader library. Safe to call from jobs while frames are drawn.
+		void buildPipelineVariants(render::PipelineVariants& pipelines) const;
+		VkPipeline buildPipeline(const render::PipelineKey& key, VkPipelineCache cache) const;
+		VkPipeline buildGraphicsPipeline(const render::PipelineKey& key, VkPipelineCache cache) const;
 
 		//Tutorial 10: Shader Modules
-		static std::vector<char> readFile(const std::string& fileName);
-		VkShaderModule createShaderModule(const std::vector<char>& code);
+		void readFile(const std::string& fileName, io::FileView& file) const;
+		VkShaderModule createShaderModule(const io::FileView& code) const;
 
 		//Tutorial 11: Render Passes
-		void createRenderPass();
+		//The render pass, framebuffers and depth buffer are built by the render graph.
+		void createRenderGraph();
 
 		///Section 4 - Drawing
 
-		//Tutorial 13: Framebuffers
-		void createFramebuffers();
-
 		//Tutorial 14: Command Buffers
 		void createCommandPool();
 		void createCommandBuffers();
@@ -266,7 +381,11 @@ namespace qe
 
 		//Tutorial 19: Staging Buffer
 		void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
-		void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+		void createDeviceLocalBuffer(const void* srcData, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+		//Lets fill write size bytes into the mapped staging memory, so the data does not need to be in one piece first.
+		void createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& bufferMemory, 
+			const std::function<void(void* pData)>& fill);
+		void updateDeviceLocalBuffer(const void* srcData, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer buffer);
 		
 		//Tutorial 20: Index Buffer
 		void createIndexBuffer();
@@ -279,50 +398,75 @@ namespace qe
 		void updateUniformBuffer(uint32_t currentImage);
 
 		//Tutorial 22: Descriptor Pool and Sets
-		void createDescriptorPool();
 		void createDescriptorSets();
 
 		///Section 7 - Texture Mapping
 
 		//Tutorial 23: Images
-		void createTextureImage();
-		void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+		void createAssetManager();
+		void updateStreamedTextures();
+		void createTextureImageFromPixels(const void* pixels, uint32_t width, uint32_t height, VkImage& image, VkDeviceMemory& imageMemory, uint32& mipLevels);
+		void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
 		VkCommandBuffer beginSingleTimeCommands();
 		void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-		void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-		void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
 	
 		//Tutorial 24: Image View and Sampler
-		void createTextureImageView();
-		VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+		VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels);
 		void createTextureSampler();
+		void createBindlessTextures();
 
 		///Section 8 - Depth Buffering
-		void createDepthResources();
 		VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 		VkFormat findDepthFormat();
 		bool hasStencilComponent(VkFormat format);
 
 		///Section 9 - Loading Models
-		void loadModel();
-		void initResPaths();
+		void loadScene();
+		void loadSceneGeometry();
+
+		///Section 10 - GPU Culling
+		static const uint32 CULLING_WORKGROUP_SIZE = 64;
+		//Screen space error a level of detail may cause before the next finer one is drawn.
+		static constexpr float LOD_ERROR_PIXELS = 1.0f;
+
+		void createSceneInstances();
+		void createInstanceBuffers();
+		void createCullingBuffers();
+		render::PipelineKey getCullingPipelineKey() const;
+		VkPipeline buildCullingPipeline(const render::PipelineKey& key, VkPipelineCache cache) const;
+		void recordDrawCommandReset(VkCommandBuffer commandBuffer, std::size_t imageIndex);
+		void recordCullingCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex);
+		void recordDrawCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex);
+		static void extractFrustumPlanes(const glm::mat4& matrix, glm::vec4 planes[6]);
+
+		///Section 11 - CPU Culling
+		void buildSceneBvh();
+		uint32 selectLod(const InstanceData& instance) const;
+		void updateCpuCulling(uint32_t currentImage);
+		void recordCpuCullingCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex);
+		void setCullingMode(CullingMode mode);
+
+		///Section 12 - Profiling
+		static constexpr const char* TRACE_FILE = "qube_trace.json";
+
+		std::string getFrameStatsReport();
+		void toggleTraceCapture();
+
+		///Section 13 - Shader Reloading
+		void updateShaders();
+		//Swaps in the variants of a finished rebuild, waiting for it if asked to. Returns true if it did, the
+		//command buffers still bind the old ones then.
+		bool collectRebuiltPipelines(bool wait);
+
+		///Section 14 - Depth Prepass
+		render::PipelineKey getDepthPipelineKey() const;
+		void recordDepthPrepassCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex);
+		//The draws of a range of meshes in the main pass, shared with the prepass so both lay down the same triangles.
+		void recordIndirectDraws(VkCommandBuffer commandBuffer, std::size_t imageIndex, uint32 firstMesh, uint32 meshCount);
+		void setDepthPrepass(bool isEnabled);
 
 		void processInput(GLFWwindow* window, float deltaTime);
 	};
 }
 
-namespace std
-{
-	//We need to create a hash function for our custom Vertex struct so we can use it in maps.
-	template<> struct hash<qe::Vertex> 
-	{
-		size_t operator()(qe::Vertex const& vertex) const 
-		{
-			return ((hash<glm::vec3>()(vertex.pos) ^
-				(hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-				(hash<glm::vec2>()(vertex.texCoord) << 1);
-		}
-	};
-}
-
 #endif
\ No newline at end of file
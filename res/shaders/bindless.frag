@@ -0,0 +1,16 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragTextureIndex;
+
+//Every texture of the scene, indexed with the texture index of the instance.
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	outColor = texture(textures[nonuniformEXT(fragTextureIndex)], fragTexCoord);
+}
\ No newline at end of file
@@ -1,2 +0,0 @@
-@echo off
-for /r %%i in (*.frag, *.vert) do %VULKAN_SDK%/Bin/glslangValidator.exe -V %%i
\ No newline at end of file
@@ -0,0 +1,66 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+//Depth prepass, see shader.vert. Only reads positions and has no fragment shader.
+
+struct InstanceData
+{
+    mat4 model;
+    uint meshIndex;
+    uint textureIndex;
+};
+
+struct MeshData
+{
+    vec4 boundingSphere;
+    vec4 positionOffset;
+    vec4 positionScale;
+    uint visibleBase;
+    uint lodCount;
+    vec4 lodErrors;
+};
+
+layout(binding = 0) uniform UniformBufferObject 
+{
+    mat4 viewProjModel;
+    vec4 frustumPlanes[6];
+    vec4 lodCamera;
+} ubo;
+
+layout(std430, binding = 2) readonly buffer InstanceBuffer
+{
+    InstanceData instances[];
+};
+
+layout(std430, binding = 3) readonly buffer VisibleInstanceBuffer
+{
+    uint visibleInstances[];
+};
+
+layout(std430, binding = 5) readonly buffer MeshBuffer
+{
+    MeshData meshes[];
+};
+
+layout(push_constant) uniform DrawPushConstants
+{
+    uint instanceCount;
+    uint visibleBase;
+} constants;
+
+layout(constant_id = 0) const bool QUANTIZED_POSITIONS = true;
+
+layout(location = 0) in vec3 inPosition;
+
+//The main pass tests with EQUAL against this depth, so both have to compute it exactly the same way.
+invariant gl_Position;
+
+void main()
+{
+	InstanceData instance = instances[visibleInstances[constants.visibleBase + gl_InstanceIndex]];
+
+	MeshData mesh = meshes[instance.meshIndex];
+	vec3 position = QUANTIZED_POSITIONS ? mesh.positionOffset.xyz + inPosition * mesh.positionScale.xyz : inPosition;
+
+	gl_Position = ubo.viewProjModel * (instance.model * vec4(position, 1.0));
+}
\ No newline at end of file
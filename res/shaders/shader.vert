@@ -1,23 +1,72 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(binding = 0) uniform UniformBufferObject 
+struct InstanceData
 {
     mat4 model;
-    mat4 view;
-    mat4 proj;
+    uint meshIndex;
+    uint textureIndex;
+};
+
+struct MeshData
+{
+    vec4 boundingSphere;
+    vec4 positionOffset;
+    vec4 positionScale;
+    uint visibleBase;
+    uint lodCount;
+    vec4 lodErrors;
+};
+
+layout(binding = 0) uniform UniformBufferObject 
+{
+    mat4 viewProjModel;
+    vec4 frustumPlanes[6];
+    vec4 lodCamera;
 } ubo;
 
+layout(std430, binding = 2) readonly buffer InstanceBuffer
+{
+    InstanceData instances[];
+};
+
+layout(std430, binding = 3) readonly buffer VisibleInstanceBuffer
+{
+    uint visibleInstances[];
+};
+
+layout(std430, binding = 5) readonly buffer MeshBuffer
+{
+    MeshData meshes[];
+};
+
+layout(push_constant) uniform DrawPushConstants
+{
+    uint instanceCount;
+    uint visibleBase;
+} constants;
+
+//Positions may be quantized, see render::VertexLayout. Specialized from the vertex layout.
+layout(constant_id = 0) const bool QUANTIZED_POSITIONS = true;
+
 layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inColor;
-layout(location = 2) in vec3 inTexCoord;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragTextureIndex;
 
-layout(location = 0) out vec3 fragColor;
-layout(location = 1) out vec3 fragTexCoord;
+//Has to match depth.vert bit for bit, the main pass tests with EQUAL after a depth prepass.
+invariant gl_Position;
 
 void main()
 {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
-	fragColor = inColor;
+	//gl_InstanceIndex already includes firstInstance, visibleBase is only set when that can't be used.
+	InstanceData instance = instances[visibleInstances[constants.visibleBase + gl_InstanceIndex]];
+
+	MeshData mesh = meshes[instance.meshIndex];
+	vec3 position = QUANTIZED_POSITIONS ? mesh.positionOffset.xyz + inPosition * mesh.positionScale.xyz : inPosition;
+
+	gl_Position = ubo.viewProjModel * (instance.model * vec4(position, 1.0));
     fragTexCoord = inTexCoord;
+    fragTextureIndex = instance.textureIndex;
 }
\ No newline at end of file
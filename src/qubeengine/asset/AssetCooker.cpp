@@ -0,0 +1,316 @@
+#include <qubeengine/asset/AssetCooker.h>
+
+#include <qubeengine/io/MeshCache.h>
+#include <qubeengine/io/ResourceArchive.h>
+#include <qubeengine/io/TextureCache.h>
+#include <qubeengine/mesh/MeshCooker.h>
+#include <qubeengine/render/ShaderCompiler.h>
+#include <qubeengine/texture/TextureCooker.h>
+#include <qubeengine/thread/JobSystem.h>
+#include <qubeengine/util/Hash.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <unordered_set>
+
+namespace qe::asset
+{
+	static inline std::string toHex(uint64 value)
+	{
+		char text[17];
+		std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+
+		return text;
+	}
+
+	AssetCooker::AssetCooker(const std::string& resDirectory, const std::string& cacheDirectory, const CookSettings& settings, thread::JobSystem& jobSystem) :
+		mResDirectory(resDirectory),
+		mCacheDirectory(cacheDirectory),
+		mSettings(settings),
+		mShaderCompiler(settings.shaderCompiler),
+		mJobSystem(jobSystem)
+	{
+	}
+
+	bool AssetCooker::run()
+	{
+		std::error_code error;
+		std::filesystem::create_directories(mCacheDirectory, error);
+		if (error)
+		{
+			std::cout << "Failed to create cache directory " << mCacheDirectory << "." << std::endl;
+			return false;
+		}
+
+		struct Source
+		{
+			std::string path;
+			io::AssetKind kind;
+		};
+
+		//The cache usually lives inside the resource directory, its contents are not sources.
+		std::filesystem::path cacheDirectory = std::filesystem::weakly_canonical(mCacheDirectory, error);
+		std::vector<Source> sources;
+
+		for (std::filesystem::recursive_directory_iterator it(mResDirectory, error), end; !error && it != end; it.increment(error))
+		{
+			io::AssetKind kind;
+			if (it->is_directory() && std::filesystem::weakly_canonical(it->path(), error) == cacheDirectory)
+			{
+				it.disable_recursion_pending();
+			}
+			else if (it->is_regular_file() && getKind(it->path().extension().string(), kind))
+			{
+				sources.push_back({ it->path().string(), kind });
+			}
+		}
+
+		if (error)
+		{
+			std::cout << "Failed to scan resource directory " << mResDirectory << "." << std::endl;
+			return false;
+		}
+
+		//One job per asset. The cookers split large assets up further on the same job system.
+		std::vector<io::AssetManifest::Entry> entries(sources.size());
+		std::vector<std::future<CookResult>> results;
+		results.reserve(sources.size());
+
+		for (std::size_t i = 0; i < sources.size(); ++i)
+		{
+			results.push_back(mJobSystem.submit([this, &sources, &entries, i]() { return cook(sources[i].path, sources[i].kind, entries[i]); }));
+		}
+
+		uint32 resultCounts[3] = {};
+		std::vector<io::AssetManifest::Entry> cookedEntries;
+		std::unordered_set<std::string> cookedFiles;
+
+		for (std::size_t i = 0; i < sources.size(); ++i)
+		{
+			CookResult result;
+			try
+			{
+				result = results[i].get();
+			}
+			catch (const std::exception& e)
+			{
+				std::cout << "Failed to cook " << sources[i].path << ": " << e.what() << std::endl;
+				result = CookResult::Failed;
+			}
+
+			++resultCounts[static_cast<uint32>(result)];
+
+			if (result != CookResult::Failed)
+			{
+				cookedFiles.insert(entries[i].cookedPath);
+				cookedEntries.push_back(std::move(entries[i]));
+			}
+		}
+
+		bool isComplete = resultCounts[static_cast<uint32>(CookResult::Failed)] == 0;
+
+		if (!io::AssetManifest::write(mCacheDirectory, cookedEntries))
+		{
+			std::cout << "Failed to write the asset manifest to " << mCacheDirectory << "." << std::endl;
+			isComplete = false;
+		}
+
+		//Cooked files are named after their key, so files the manifest does not list are outdated. Only
+		//files with the extensions of cooked assets are touched.
+		for (std::filesystem::directory_iterator it(mCacheDirectory, error), end; !error && it != end; it.increment(error))
+		{
+			std::string extension = it->path().extension().string();
+			if (it->is_regular_file() && (extension == ".qmesh" || extension == ".qtex" || extension == ".spv") &&
+				cookedFiles.count(it->path().filename().string()) == 0)
+			{
+				std::filesystem::remove(it->path(), error);
+			}
+		}
+
+		std::string archivePath = (std::filesystem::path(mResDirectory) / io::ResourceArchive::FILE_NAME).string();
+		if (mSettings.packArchive)
+		{
+			isComplete = packArchive(archivePath, cookedEntries) && isComplete;
+		}
+		else
+		{
+			//The runtime looks into a mounted archive first, one from an earlier run would hide what was cooked since.
+			std::filesystem::remove(archivePath, error);
+		}
+
+		std::cout << "Cooked " << resultCounts[static_cast<uint32>(CookResult::Cooked)] << " assets, " <<
+			resultCounts[static_cast<uint32>(CookResult::UpToDate)] << " were up to date and " <<
+			resultCounts[static_cast<uint32>(CookResult::Failed)] << " failed." << std::endl;
+
+		return isComplete;
+	}
+
+	bool AssetCooker::getKind(const std::string& extension, io::AssetKind& kind)
+	{
+		std::string name = extension;
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		if (name == ".obj")
+		{
+			kind = io::AssetKind::Mesh;
+		}
+		else if (name == ".png" || name == ".jpg" || name == ".jpeg" || name == ".tga" || name == ".bmp")
+		{
+			kind = io::AssetKind::Texture;
+		}
+		else if (name == ".vert" || name == ".frag" || name == ".comp" || name == ".geom" || name == ".tesc" || name == ".tese")
+		{
+			kind = io::AssetKind::Shader;
+		}
+		else
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	AssetCooker::CookResult AssetCooker::cook(const std::string& sourcePath, io::AssetKind kind, io::AssetManifest::Entry& entry) const
+	{
+		io::FileView source;
+		if (!mFileSystem.open(sourcePath, source) || !io::AssetManifest::getSourceStamp(sourcePath, entry.sourceSize, entry.sourceTime))
+		{
+			std::cout << "Failed to read " << sourcePath << "." << std::endl;
+			return CookResult::Failed;
+		}
+
+		//The key covers the contents and everything that changes what they are cooked into.
+		std::string extension;
+		uint64 key;
+
+		switch (kind)
+		{
+		case io::AssetKind::Mesh:
+			extension = ".qmesh";
+			key = io::MeshCache::computeSourceKey(source);
+			break;
+		case io::AssetKind::Texture:
+			extension = ".qtex";
+			key = util::hashValue(mSettings.textureFormat, io::TextureCache::computeSourceKey(source));
+			break;
+		default:
+			//The runtime looks compiled shaders up under the same key.
+			extension = ".spv";
+			key = render::ShaderCompiler::computeSourceKey(sourcePath, source);
+			break;
+		}
+
+		entry.kind = kind;
+		entry.sourcePath = std::filesystem::path(sourcePath).lexically_relative(mResDirectory).generic_string();
+		entry.cookedPath = toHex(key) + extension;
+		entry.key = key;
+
+		std::string cookedPath = (std::filesystem::path(mCacheDirectory) / entry.cookedPath).string();
+
+		if (kind == io::AssetKind::Mesh)
+		{
+			io::MeshCache cache;
+			if (cache.open(mFileSystem, cookedPath, key, sizeof(mesh::Submesh)))
+			{
+				return CookResult::UpToDate;
+			}
+
+			mesh::CookedMesh mesh;
+			mesh::MeshCooker::cook(source, mesh, &mJobSystem);
+
+			if (!mesh::MeshCooker::write(cookedPath, key, mesh))
+			{
+				std::cout << "Failed to write mesh cache " << cookedPath << "." << std::endl;
+				return CookResult::Failed;
+			}
+		}
+		else if (kind == io::AssetKind::Texture)
+		{
+			io::TextureCache cache;
+			if (cache.open(mFileSystem, cookedPath, key))
+			{
+				return CookResult::UpToDate;
+			}
+
+			texture::CookedTexture texture;
+			if (!texture::TextureCooker::cook(source.getData(), source.getSize(), mSettings.textureFormat, texture, &mJobSystem))
+			{
+				std::cout << "Failed to decode texture " << sourcePath << "." << std::endl;
+				return CookResult::Failed;
+			}
+
+			if (!texture::TextureCooker::write(cookedPath, key, texture))
+			{
+				std::cout << "Failed to write texture cache " << cookedPath << "." << std::endl;
+				return CookResult::Failed;
+			}
+		}
+		else
+		{
+			std::error_code error;
+			if (std::filesystem::exists(cookedPath, error))
+			{
+				return CookResult::UpToDate;
+			}
+
+			if (!mShaderCompiler.compile(sourcePath, source, cookedPath))
+			{
+				return CookResult::Failed;
+			}
+		}
+
+		std::cout << "Successfully cooked " << entry.sourcePath << " to " << entry.cookedPath << "!" << std::endl;
+
+		return CookResult::Cooked;
+	}
+
+	bool AssetCooker::packArchive(const std::string& archivePath, const std::vector<io::AssetManifest::Entry>& entries) const
+	{
+		//Paths in the archive are relative to the resource directory, which the runtime mounts it for. Files
+		//outside of it could never be looked up and empty ones cannot be mapped, neither is packed.
+		std::filesystem::path resDirectory = std::filesystem::path(mResDirectory).lexically_normal();
+		std::vector<io::ResourceArchive::Entry> archiveEntries;
+		std::unordered_set<std::string> packedPaths;
+
+		auto addFile = [&](const std::filesystem::path& filePath)
+		{
+			std::error_code error;
+			std::string path = filePath.lexically_normal().lexically_relative(resDirectory).generic_string();
+
+			if (!path.empty() && path.compare(0, 2, "..") != 0 && std::filesystem::file_size(filePath, error) > 0 && !error &&
+				packedPaths.insert(path).second)
+			{
+				archiveEntries.push_back({ path, filePath.string(), mSettings.compressArchive });
+			}
+		};
+
+		addFile(std::filesystem::path(mCacheDirectory) / io::AssetManifest::FILE_NAME);
+		for (const io::AssetManifest::Entry& entry : entries)
+		{
+			addFile(std::filesystem::path(mCacheDirectory) / entry.cookedPath);
+		}
+
+		std::error_code error;
+		for (std::filesystem::recursive_directory_iterator it(mResDirectory, error), end; !error && it != end; it.increment(error))
+		{
+			std::string extension = it->path().extension().string();
+			if (it->is_regular_file() && extension == ".scene")
+			{
+				addFile(it->path());
+			}
+		}
+
+		if (error || !io::ResourceArchive::write(archivePath, archiveEntries))
+		{
+			std::cout << "Failed to pack resource archive " << archivePath << "." << std::endl;
+			return false;
+		}
+
+		std::cout << "Packed " << archiveEntries.size() << " files into " << archivePath << "." << std::endl;
+
+		return true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,389 @@
+#include <qubeengine/asset/AssetManager.h>
+
+#include <qubeengine/io/AssetManifest.h>
+#include <qubeengine/io/TextureCache.h>
+#include <qubeengine/render/QueueTimeline.h>
+#include <qubeengine/render/UploadQueue.h>
+#include <qubeengine/texture/MipChain.h>
+#include <qubeengine/texture/TextureCooker.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace qe::asset
+{
+	static inline VkFormat getVkFormat(texture::TextureFormat format)
+	{
+		switch (format)
+		{
+		case texture::TextureFormat::Bc1:
+			return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		case texture::TextureFormat::Bc7:
+			return VK_FORMAT_BC7_SRGB_BLOCK;
+		default:
+			return VK_FORMAT_R8G8B8A8_SRGB;
+		}
+	}
+
+	AssetManager::AssetManager(VkDevice device, VkPhysicalDevice physicalDevice, bool supportsTextureCompression, const io::AssetManifest& manifest,
+		const io::FileSystem& fileSystem, render::UploadQueue& uploadQueue, render::QueueTimeline& graphicsTimeline, thread::JobSystem& jobSystem) :
+		mDevice(device),
+		mPhysicalDevice(physicalDevice),
+		mSupportsTextureCompression(supportsTextureCompression),
+		mManifest(manifest),
+		mFileSystem(fileSystem),
+		mUploadQueue(uploadQueue),
+		mGraphicsTimeline(graphicsTimeline),
+		mJobSystem(jobSystem)
+	{
+	}
+
+	AssetManager::~AssetManager()
+	{
+		//Loads that are still running reference this manager, they have to finish first. Staging buffers of
+		//textures that were uploaded belong to the upload queue.
+		for (Texture& texture : mTextures)
+		{
+			if (texture.state == AssetState::Loading)
+			{
+				try
+				{
+					texture.loaded = texture.loading.get();
+				}
+				catch (const std::exception&)
+				{
+					continue;
+				}
+			}
+
+			destroyTexture(texture.loaded);
+		}
+	}
+
+	TextureHandle AssetManager::requestTexture(const std::string& path)
+	{
+		auto it = mTextureHandles.find(path);
+		if (it != mTextureHandles.end())
+		{
+			return it->second;
+		}
+
+		TextureHandle handle = static_cast<TextureHandle>(mTextures.size());
+		mTextureHandles.emplace(path, handle);
+
+		Texture texture;
+		texture.path = path;
+		texture.loading = mJobSystem.submit([this, path]() { return loadTexture(path); });
+		mTextures.push_back(std::move(texture));
+
+		return handle;
+	}
+
+	std::vector<TextureHandle> AssetManager::update()
+	{
+		std::vector<TextureHandle> residentTextures;
+		bool hasUploads = false;
+
+		for (Texture& texture : mTextures)
+		{
+			if (texture.state == AssetState::Loading && texture.loading.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			{
+				hasUploads |= recordUpload(texture);
+			}
+		}
+
+		if (hasUploads)
+		{
+			mUploadQueue.flush();
+		}
+
+		//Uploads recorded here or by finishLoading were submitted by now, at the latest by the flush above.
+		uint64 submittedValue = mGraphicsTimeline.getSubmittedValue();
+		uint64 completedValue = mGraphicsTimeline.getCompletedValue();
+
+		for (TextureHandle handle = 0; handle < mTextures.size(); ++handle)
+		{
+			Texture& texture = mTextures[handle];
+			if (texture.state != AssetState::Uploading)
+			{
+				continue;
+			}
+
+			if (texture.arrivalValue == 0)
+			{
+				texture.arrivalValue = submittedValue;
+			}
+
+			if (texture.arrivalValue <= completedValue)
+			{
+				texture.state = AssetState::Resident;
+				residentTextures.push_back(handle);
+			}
+		}
+
+		return residentTextures;
+	}
+
+	void AssetManager::finishLoading(TextureHandle handle)
+	{
+		Texture& texture = mTextures[handle];
+		if (texture.state == AssetState::Loading)
+		{
+			recordUpload(texture);
+		}
+
+		if (texture.state == AssetState::Failed)
+		{
+			throw std::runtime_error("Failed to load texture image: " + texture.path);
+		}
+	}
+
+	AssetState AssetManager::getState(TextureHandle handle) const
+	{
+		return mTextures[handle].state;
+	}
+
+	VkImageView AssetManager::getView(TextureHandle handle) const
+	{
+		return mTextures[handle].loaded.view;
+	}
+
+	VkFormat AssetManager::getFormat(TextureHandle handle) const
+	{
+		return mTextures[handle].loaded.format;
+	}
+
+	uint32 AssetManager::getLevelCount(TextureHandle handle) const
+	{
+		return mTextures[handle].loaded.levelCount;
+	}
+
+	AssetManager::LoadedTexture AssetManager::loadTexture(const std::string& path) const
+	{
+		//Textures cooked to a block format this device cannot sample are cooked again.
+		io::TextureCache cache;
+		auto openCache = [this, &cache](const std::string& cachePath, uint64 sourceKey)
+		{
+			if (cache.open(mFileSystem, cachePath, sourceKey) &&
+				texture::BlockCompressor::isCompressed(static_cast<texture::TextureFormat>(cache.getFormat())) && !mSupportsTextureCompression)
+			{
+				cache.close();
+			}
+
+			return cache.isOpen();
+		};
+
+		//A texture the asset cooker listed is opened as is, without reading the image file.
+		std::string cookedPath;
+		uint64 cookedKey;
+		bool isCooked = mManifest.find(path, io::AssetKind::Texture, cookedPath, cookedKey) && openCache(cookedPath, cookedKey);
+
+		texture::CookedTexture cooked = {};
+		if (!isCooked)
+		{
+			//The cooked texture is keyed by the contents of the image file, so an edited image is cooked again.
+			io::FileView source;
+			if (!mFileSystem.open(path, source))
+			{
+				throw std::runtime_error("Failed to load texture image: " + path);
+			}
+
+			uint64 sourceKey = io::TextureCache::computeSourceKey(source);
+
+			std::string cachePath = path + ".qtex";
+
+			if (!openCache(cachePath, sourceKey))
+			{
+				texture::TextureFormat format = mSupportsTextureCompression ? texture::TextureFormat::Bc7 : texture::TextureFormat::Rgba8;
+				if (!texture::TextureCooker::cook(source.getData(), source.getSize(), format, cooked, &mJobSystem))
+				{
+					throw std::runtime_error("Failed to load texture image: " + path);
+				}
+
+				if (texture::TextureCooker::write(cachePath, sourceKey, cooked))
+				{
+					std::cout << "Successfully cooked texture to " << cachePath << "!" << std::endl;
+				}
+				else
+				{
+					std::cout << "Failed to write texture cache " << cachePath << ", the texture is cooked again next start." << std::endl;
+				}
+			}
+		}
+
+		if (cache.isOpen())
+		{
+			cooked.format = static_cast<texture::TextureFormat>(cache.getFormat());
+			cooked.width = cache.getWidth();
+			cooked.height = cache.getHeight();
+			cooked.levelCount = cache.getLevelCount();
+			cooked.levelOffsets.resize(cooked.levelCount + 1);
+
+			for (uint32 level = 0; level <= cooked.levelCount; ++level)
+			{
+				cooked.levelOffsets[level] = cache.getLevelOffset(level);
+			}
+		}
+
+		const void* pData = cache.isOpen() ? cache.getData() : cooked.data.data();
+		VkDeviceSize dataSize = cooked.levelOffsets.back();
+
+		LoadedTexture loaded;
+		loaded.format = getVkFormat(cooked.format);
+		loaded.levelCount = cooked.levelCount;
+
+		try
+		{
+			//The levels are laid out for the copy already, so they are staged in one go.
+			VkBufferCreateInfo bufferInfo = {};
+			bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bufferInfo.size = dataSize;
+			bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+			bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			if (vkCreateBuffer(mDevice, &bufferInfo, nullptr, &loaded.stagingBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create texture staging buffer.");
+			}
+
+			VkMemoryRequirements memRequirements;
+			vkGetBufferMemoryRequirements(mDevice, loaded.stagingBuffer, &memRequirements);
+
+			VkMemoryAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = memRequirements.size;
+			allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &loaded.stagingMemory) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to allocate texture staging memory.");
+			}
+
+			vkBindBufferMemory(mDevice, loaded.stagingBuffer, loaded.stagingMemory, 0);
+
+			void* data;
+			vkMapMemory(mDevice, loaded.stagingMemory, 0, dataSize, 0, &data);
+			std::memcpy(data, pData, static_cast<std::size_t>(dataSize));
+			vkUnmapMemory(mDevice, loaded.stagingMemory);
+
+			VkImageCreateInfo imageInfo = {};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent.width = cooked.width;
+			imageInfo.extent.height = cooked.height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = cooked.levelCount;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = loaded.format;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+
+			if (vkCreateImage(mDevice, &imageInfo, nullptr, &loaded.image) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create texture image.");
+			}
+
+			vkGetImageMemoryRequirements(mDevice, loaded.image, &memRequirements);
+			allocInfo.allocationSize = memRequirements.size;
+			allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &loaded.memory) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to allocate texture image memory.");
+			}
+
+			vkBindImageMemory(mDevice, loaded.image, loaded.memory, 0);
+
+			VkImageViewCreateInfo viewInfo = {};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = loaded.image;
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = loaded.format;
+			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = cooked.levelCount;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			if (vkCreateImageView(mDevice, &viewInfo, nullptr, &loaded.view) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create texture image view.");
+			}
+		}
+		catch (...)
+		{
+			destroyTexture(loaded);
+			throw;
+		}
+
+		loaded.regions.resize(cooked.levelCount);
+		for (uint32 level = 0; level < cooked.levelCount; ++level)
+		{
+			VkBufferImageCopy& region = loaded.regions[level];
+			region = {};
+			region.bufferOffset = cooked.levelOffsets[level];
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = { texture::MipChain::getLevelExtent(cooked.width, level), texture::MipChain::getLevelExtent(cooked.height, level), 1 };
+		}
+
+		return loaded;
+	}
+
+	void AssetManager::destroyTexture(LoadedTexture& texture) const
+	{
+		vkDestroyImageView(mDevice, texture.view, nullptr);
+		vkDestroyImage(mDevice, texture.image, nullptr);
+		vkFreeMemory(mDevice, texture.memory, nullptr);
+		vkDestroyBuffer(mDevice, texture.stagingBuffer, nullptr);
+		vkFreeMemory(mDevice, texture.stagingMemory, nullptr);
+		texture = LoadedTexture();
+	}
+
+	bool AssetManager::recordUpload(Texture& texture)
+	{
+		try
+		{
+			texture.loaded = texture.loading.get();
+		}
+		catch (const std::exception& exception)
+		{
+			std::cout << exception.what() << std::endl;
+			texture.state = AssetState::Failed;
+			return false;
+		}
+
+		//The upload queue owns the staging buffer from here on.
+		mUploadQueue.uploadImageLevels(texture.loaded.stagingBuffer, texture.loaded.stagingMemory, texture.loaded.image, texture.loaded.regions);
+		texture.loaded.stagingBuffer = VK_NULL_HANDLE;
+		texture.loaded.stagingMemory = VK_NULL_HANDLE;
+		texture.loaded.regions = std::vector<VkBufferImageCopy>();
+		texture.state = AssetState::Uploading;
+
+		return true;
+	}
+
+	uint32 AssetManager::findMemoryType(uint32 typeFilter, VkMemoryPropertyFlags properties) const
+	{
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memProperties);
+
+		for (uint32 i = 0; i < memProperties.memoryTypeCount; ++i)
+		{
+			if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				return i;
+			}
+		}
+
+		throw std::runtime_error("Failed to find suitable memory type for texture.");
+	}
+}
\ No newline at end of file
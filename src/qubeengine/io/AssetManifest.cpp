@@ -0,0 +1,165 @@
+#include <qubeengine/io/AssetManifest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace qe::io
+{
+	bool AssetManifest::getSourceStamp(const std::string& path, uint64& size, int64& time)
+	{
+		std::error_code error;
+		size = static_cast<uint64>(std::filesystem::file_size(path, error));
+		if (error)
+		{
+			return false;
+		}
+
+		time = static_cast<int64>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+
+		return !error;
+	}
+
+	bool AssetManifest::write(const std::string& cacheDirectory, std::vector<Entry> entries)
+	{
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.sourcePath < b.sourcePath; });
+
+		std::vector<Record> records(entries.size());
+		std::string strings;
+
+		for (std::size_t i = 0; i < entries.size(); ++i)
+		{
+			Record& record = records[i];
+			record = {};
+			record.key = entries[i].key;
+			record.sourceSize = entries[i].sourceSize;
+			record.sourceTime = entries[i].sourceTime;
+			record.kind = static_cast<uint32>(entries[i].kind);
+			record.sourcePathOffset = static_cast<uint32>(strings.size());
+			strings.append(entries[i].sourcePath).push_back('\0');
+			record.cookedPathOffset = static_cast<uint32>(strings.size());
+			strings.append(entries[i].cookedPath).push_back('\0');
+		}
+
+		Header header = {};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.entryCount = static_cast<uint32>(records.size());
+		header.stringSize = static_cast<uint32>(strings.size());
+
+		//Written next to the destination first, so a manifest that is cut short never replaces a good one.
+		std::string path = (std::filesystem::path(cacheDirectory) / FILE_NAME).string();
+		std::string tempPath = path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				return false;
+			}
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(sizeof(Record) * records.size()));
+			file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+			if (!file.good())
+			{
+				file.close();
+				std::remove(tempPath.c_str());
+				return false;
+			}
+		}
+
+		std::remove(path.c_str());
+
+		return std::rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+
+	bool AssetManifest::open(const FileSystem& fileSystem, const std::string& cacheDirectory, const std::string& resDirectory)
+	{
+		close();
+
+		std::string path = (std::filesystem::path(cacheDirectory) / FILE_NAME).string();
+		if (!fileSystem.open(path, mFile) || mFile.getSize() < sizeof(Header))
+		{
+			mFile.close();
+			return false;
+		}
+
+		const Header* pHeader = reinterpret_cast<const Header*>(mFile.getData());
+		uint64 stringOffset = sizeof(Header) + (uint64)sizeof(Record) * pHeader->entryCount;
+
+		bool isValid = pHeader->magic == MAGIC && pHeader->version == VERSION && stringOffset + pHeader->stringSize == mFile.getSize() &&
+			(pHeader->stringSize == 0 || mFile.getData()[mFile.getSize() - 1] == '\0');
+
+		//Paths start inside the strings, which end with a terminator, so every path is terminated.
+		const Record* pRecords = reinterpret_cast<const Record*>(mFile.getData() + sizeof(Header));
+		for (uint32 i = 0; isValid && i < pHeader->entryCount; ++i)
+		{
+			isValid = pRecords[i].sourcePathOffset < pHeader->stringSize && pRecords[i].cookedPathOffset < pHeader->stringSize;
+		}
+
+		if (!isValid)
+		{
+			mFile.close();
+			return false;
+		}
+
+		mpHeader = pHeader;
+		mCacheDirectory = cacheDirectory;
+		mResDirectory = std::filesystem::path(resDirectory).lexically_normal().string();
+
+		return true;
+	}
+
+	void AssetManifest::close()
+	{
+		mFile.close();
+		mpHeader = nullptr;
+	}
+
+	bool AssetManifest::isOpen() const
+	{
+		return mpHeader != nullptr;
+	}
+
+	bool AssetManifest::find(const std::string& path, AssetKind kind, std::string& cookedPath, uint64& key) const
+	{
+		if (!isOpen())
+		{
+			return false;
+		}
+
+		std::string sourcePath = std::filesystem::path(path).lexically_normal().lexically_relative(mResDirectory).generic_string();
+		if (sourcePath.empty() || sourcePath.compare(0, 2, "..") == 0)
+		{
+			return false;
+		}
+
+		const Record* pRecords = reinterpret_cast<const Record*>(mFile.getData() + sizeof(Header));
+		const char* pStrings = reinterpret_cast<const char*>(pRecords + mpHeader->entryCount);
+
+		const Record* pRecord = std::lower_bound(pRecords, pRecords + mpHeader->entryCount, sourcePath,
+			[pStrings](const Record& record, const std::string& value) { return std::strcmp(pStrings + record.sourcePathOffset, value.c_str()) < 0; });
+
+		if (pRecord == pRecords + mpHeader->entryCount || sourcePath != pStrings + pRecord->sourcePathOffset ||
+			pRecord->kind != static_cast<uint32>(kind))
+		{
+			return false;
+		}
+
+		//A source that is not there at all is not stale, builds that ship the resource archive leave them out.
+		uint64 sourceSize;
+		int64 sourceTime;
+		if (getSourceStamp(path, sourceSize, sourceTime) && (sourceSize != pRecord->sourceSize || sourceTime != pRecord->sourceTime))
+		{
+			return false;
+		}
+
+		cookedPath = (std::filesystem::path(mCacheDirectory) / (pStrings + pRecord->cookedPathOffset)).string();
+		key = pRecord->key;
+
+		return true;
+	}
+}
\ No newline at end of file
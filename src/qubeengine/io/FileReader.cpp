@@ -0,0 +1,104 @@
+#include <qubeengine/io/FileReader.h>
+#include <qubeengine/io/FileView.h>
+
+#include <algorithm>
+
+namespace qe::io
+{
+	FileReader::FileReader(const FileView& file, bool releaseBehind) :
+		mFile(file),
+		mpData(file.getData()),
+		mSize(file.getSize()),
+		mReleaseBehind(releaseBehind)
+	{
+		moveTo(0);
+	}
+
+	std::size_t FileReader::read(void* pDestination, std::size_t size)
+	{
+		size = std::min(size, getRemaining());
+		std::memcpy(pDestination, mpData + mPosition, size);
+		moveTo(mPosition + size);
+
+		return size;
+	}
+
+	const uint8* FileReader::consume(std::size_t size)
+	{
+		if (size > getRemaining())
+		{
+			return nullptr;
+		}
+
+		const uint8* pBytes = mpData + mPosition;
+		moveTo(mPosition + size);
+
+		return pBytes;
+	}
+
+	bool FileReader::readLine(std::string_view& line)
+	{
+		if (isAtEnd())
+		{
+			return false;
+		}
+
+		const char* pBegin = reinterpret_cast<const char*>(mpData + mPosition);
+		const char* pEnd = static_cast<const char*>(std::memchr(pBegin, '\n', getRemaining()));
+		std::size_t length = pEnd ? static_cast<std::size_t>(pEnd - pBegin) : getRemaining();
+
+		line = std::string_view(pBegin, length);
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.remove_suffix(1);
+		}
+
+		moveTo(mPosition + length + (pEnd ? 1 : 0));
+
+		return true;
+	}
+
+	void FileReader::seek(std::size_t position)
+	{
+		moveTo(std::min(position, mSize));
+	}
+
+	void FileReader::skip(std::size_t size)
+	{
+		moveTo(mPosition + std::min(size, getRemaining()));
+	}
+
+	std::size_t FileReader::getPosition() const
+	{
+		return mPosition;
+	}
+
+	std::size_t FileReader::getRemaining() const
+	{
+		return mSize - mPosition;
+	}
+
+	bool FileReader::isAtEnd() const
+	{
+		return mPosition == mSize;
+	}
+
+	void FileReader::moveTo(std::size_t position)
+	{
+		mPosition = position;
+
+		//Requests go out a whole window at a time, once the position is within a window of the last one's end.
+		if (mRequestedEnd < mSize && mPosition + WINDOW_SIZE > mRequestedEnd)
+		{
+			std::size_t begin = std::max(mRequestedEnd, mPosition);
+			mFile.advise(begin, 2 * WINDOW_SIZE, AccessHint::WillNeed);
+			mRequestedEnd = begin + 2 * WINDOW_SIZE;
+		}
+
+		if (mReleaseBehind && mPosition >= mReleasedEnd + WINDOW_SIZE)
+		{
+			mFile.advise(mReleasedEnd, mPosition - mReleasedEnd, AccessHint::DontNeed);
+			mReleasedEnd = mPosition;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <qubeengine/io/FileSystem.h>
+
+#include <filesystem>
+
+namespace qe::io
+{
+	bool FileSystem::mountArchive(const std::string& archivePath, const std::string& directory)
+	{
+		std::unique_ptr<ResourceArchive> pArchive = std::make_unique<ResourceArchive>();
+		if (!pArchive->open(archivePath))
+		{
+			return false;
+		}
+
+		std::string mountDirectory = normalize(directory);
+		if (mountDirectory.empty() || mountDirectory.back() != '/')
+		{
+			mountDirectory.push_back('/');
+		}
+
+		mMounts.push_back({ mountDirectory, std::move(pArchive) });
+
+		return true;
+	}
+
+	uint32 FileSystem::getMountedFileCount() const
+	{
+		uint32 fileCount = 0;
+		for (const Mount& mount : mMounts)
+		{
+			fileCount += mount.pArchive->getFileCount();
+		}
+
+		return fileCount;
+	}
+
+	bool FileSystem::open(const std::string& path, FileView& file, AccessHint hint) const
+	{
+		file.close();
+
+		if (!mMounts.empty())
+		{
+			std::string normalPath = normalize(path);
+
+			for (const Mount& mount : mMounts)
+			{
+				if (normalPath.compare(0, mount.directory.size(), mount.directory) == 0 &&
+					mount.pArchive->openFile(normalPath.substr(mount.directory.size()), file, hint))
+				{
+					return true;
+				}
+			}
+		}
+
+		if (!file.mFile.open(path, hint))
+		{
+			return false;
+		}
+
+		file.mpMapping = &file.mFile;
+		file.mpData = file.mFile.getData();
+		file.mSize = file.mFile.getSize();
+
+		return true;
+	}
+
+	std::string FileSystem::normalize(const std::string& path)
+	{
+		return std::filesystem::path(path).lexically_normal().generic_string();
+	}
+}
\ No newline at end of file
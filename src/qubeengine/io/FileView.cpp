@@ -0,0 +1,41 @@
+#include <qubeengine/io/FileView.h>
+
+#include <algorithm>
+
+namespace qe::io
+{
+	void FileView::close()
+	{
+		mFile.close();
+		mDecompressed.clear();
+		mDecompressed.shrink_to_fit();
+		mpMapping = nullptr;
+		mOffset = 0;
+		mpData = nullptr;
+		mSize = 0;
+	}
+
+	bool FileView::isOpen() const
+	{
+		return mpData != nullptr;
+	}
+
+	const uint8* FileView::getData() const
+	{
+		return mpData;
+	}
+
+	std::size_t FileView::getSize() const
+	{
+		return mSize;
+	}
+
+	void FileView::advise(std::size_t offset, std::size_t size, AccessHint hint) const
+	{
+		//Ranges are clipped to the file, they must not reach into the next file of an archive.
+		if (mpMapping && offset < mSize)
+		{
+			mpMapping->advise(mOffset + offset, std::min(size, mSize - offset), hint);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include <qubeengine/io/MappedFile.h>
+
+#include <algorithm>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace qe::io
+{
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+#ifdef WIN32
+	bool MappedFile::open(const std::string& path, AccessHint hint)
+	{
+		close();
+
+		DWORD flags = hint == AccessHint::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : hint == AccessHint::Random ? FILE_FLAG_RANDOM_ACCESS : 0;
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		void* pData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!pData)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		mpFileHandle = file;
+		mpMappingHandle = mapping;
+		mpData = static_cast<const uint8*>(pData);
+		mSize = static_cast<std::size_t>(size.QuadPart);
+
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (mpData)
+		{
+			UnmapViewOfFile(mpData);
+			CloseHandle(mpMappingHandle);
+			CloseHandle(mpFileHandle);
+		}
+
+		mpData = nullptr;
+		mSize = 0;
+		mpFileHandle = nullptr;
+		mpMappingHandle = nullptr;
+	}
+
+	void MappedFile::advise(std::size_t, std::size_t, AccessHint) const
+	{
+	}
+#else
+	bool MappedFile::open(const std::string& path, AccessHint hint)
+	{
+		close();
+
+		int fileDescriptor = ::open(path.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+		{
+			return false;
+		}
+
+		struct stat status;
+		if (fstat(fileDescriptor, &status) != 0 || status.st_size == 0)
+		{
+			::close(fileDescriptor);
+			return false;
+		}
+
+		void* pData = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (pData == MAP_FAILED)
+		{
+			::close(fileDescriptor);
+			return false;
+		}
+
+		mFileDescriptor = fileDescriptor;
+		mpData = static_cast<const uint8*>(pData);
+		mSize = static_cast<std::size_t>(status.st_size);
+
+		advise(0, mSize, hint);
+
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (mpData)
+		{
+			munmap(const_cast<uint8*>(mpData), mSize);
+			::close(mFileDescriptor);
+		}
+
+		mpData = nullptr;
+		mSize = 0;
+		mFileDescriptor = -1;
+	}
+
+	void MappedFile::advise(std::size_t offset, std::size_t size, AccessHint hint) const
+	{
+		if (!mpData || offset >= mSize)
+		{
+			return;
+		}
+
+		//madvise takes whole pages, the range is widened to the page the offset is in.
+		static const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+		std::size_t begin = offset - offset % pageSize;
+		std::size_t end = offset + std::min(size, mSize - offset);
+
+		static const int advice[] = { MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED };
+		madvise(const_cast<uint8*>(mpData) + begin, end - begin, advice[static_cast<uint8>(hint)]);
+	}
+#endif
+
+	bool MappedFile::isOpen() const
+	{
+		return mpData != nullptr;
+	}
+
+	const uint8* MappedFile::getData() const
+	{
+		return mpData;
+	}
+
+	std::size_t MappedFile::getSize() const
+	{
+		return mSize;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <qubeengine/io/MeshCache.h>
+
+#include <qubeengine/util/Hash.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace qe::io
+{
+	uint64 MeshCache::computeSourceKey(const FileView& source)
+	{
+		//The format version is part of the key, so cooking changes invalidate every cache.
+		return hashValue(VERSION, hashBytes(source.getData(), source.getSize()));
+	}
+
+	bool MeshCache::write(const std::string& path, uint64 sourceKey, const Contents& contents)
+	{
+		auto align = [](uint64 offset) { return (offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1); };
+
+		Header header = {};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.sourceKey = sourceKey;
+		header.vertexFormat = contents.vertexFormat;
+		header.vertexStride = contents.vertexStride;
+		header.vertexCount = contents.vertexCount;
+		header.indexSize = contents.indexSize;
+		header.indexCount = contents.indexCount;
+		header.submeshStride = contents.submeshStride;
+		header.submeshCount = contents.submeshCount;
+		header.vertexOffset = align(sizeof(Header));
+		header.indexOffset = align(header.vertexOffset + (uint64)contents.vertexStride * contents.vertexCount);
+		header.submeshOffset = align(header.indexOffset + (uint64)contents.indexSize * contents.indexCount);
+
+		//Written next to the destination first, so a cache that is cut short never replaces a good one.
+		std::string tempPath = path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				return false;
+			}
+
+			const char zeros[BLOB_ALIGNMENT] = {};
+			auto writeBlob = [&](uint64 offset, const void* pData, uint64 size)
+			{
+				file.write(zeros, static_cast<std::streamsize>(offset - static_cast<uint64>(file.tellp())));
+				file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+			};
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			writeBlob(header.vertexOffset, contents.pVertices, (uint64)contents.vertexStride * contents.vertexCount);
+			writeBlob(header.indexOffset, contents.pIndices, (uint64)contents.indexSize * contents.indexCount);
+			writeBlob(header.submeshOffset, contents.pSubmeshes, (uint64)contents.submeshStride * contents.submeshCount);
+
+			if (!file.good())
+			{
+				file.close();
+				std::remove(tempPath.c_str());
+				return false;
+			}
+		}
+
+		std::remove(path.c_str());
+
+		return std::rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+
+	bool MeshCache::open(const FileSystem& fileSystem, const std::string& path, uint64 sourceKey, uint32 submeshStride)
+	{
+		close();
+
+		if (!fileSystem.open(path, mFile) || mFile.getSize() < sizeof(Header))
+		{
+			mFile.close();
+			return false;
+		}
+
+		const Header* pHeader = reinterpret_cast<const Header*>(mFile.getData());
+		uint64 end = pHeader->submeshOffset + (uint64)pHeader->submeshStride * pHeader->submeshCount;
+
+		bool isValid = pHeader->magic == MAGIC && pHeader->version == VERSION && pHeader->sourceKey == sourceKey &&
+			pHeader->submeshStride == submeshStride && submeshStride >= sizeof(SubmeshRange) && (pHeader->indexSize == 2 || pHeader->indexSize == 4) &&
+			pHeader->vertexOffset >= sizeof(Header) &&
+			pHeader->vertexOffset + (uint64)pHeader->vertexStride * pHeader->vertexCount <= pHeader->indexOffset &&
+			pHeader->indexOffset + (uint64)pHeader->indexSize * pHeader->indexCount <= pHeader->submeshOffset &&
+			end <= mFile.getSize();
+
+		//Submeshes are uploaded and drawn straight from their ranges, so none may reach past the blobs.
+		for (uint32 i = 0; isValid && i < pHeader->submeshCount; ++i)
+		{
+			SubmeshRange range;
+			std::memcpy(&range, mFile.getData() + pHeader->submeshOffset + (uint64)i * pHeader->submeshStride, sizeof(SubmeshRange));
+
+			isValid = (uint64)range.firstIndex + range.indexCount <= pHeader->indexCount && range.vertexOffset >= 0 &&
+				(uint64)range.vertexOffset + range.vertexCount <= pHeader->vertexCount;
+		}
+
+		if (!isValid)
+		{
+			mFile.close();
+			return false;
+		}
+
+		mpHeader = pHeader;
+
+		return true;
+	}
+
+	void MeshCache::close()
+	{
+		mFile.close();
+		mpHeader = nullptr;
+	}
+
+	bool MeshCache::isOpen() const
+	{
+		return mpHeader != nullptr;
+	}
+
+	const void* MeshCache::getVertexData() const
+	{
+		return mFile.getData() + mpHeader->vertexOffset;
+	}
+
+	uint32 MeshCache::getVertexFormat() const
+	{
+		return mpHeader->vertexFormat;
+	}
+
+	uint32 MeshCache::getVertexStride() const
+	{
+		return mpHeader->vertexStride;
+	}
+
+	uint32 MeshCache::getVertexCount() const
+	{
+		return mpHeader->vertexCount;
+	}
+
+	const void* MeshCache::getIndexData() const
+	{
+		return mFile.getData() + mpHeader->indexOffset;
+	}
+
+	uint32 MeshCache::getIndexSize() const
+	{
+		return mpHeader->indexSize;
+	}
+
+	uint32 MeshCache::getIndexCount() const
+	{
+		return mpHeader->indexCount;
+	}
+
+	const void* MeshCache::getSubmeshData() const
+	{
+		return mFile.getData() + mpHeader->submeshOffset;
+	}
+
+	uint32 MeshCache::getSubmeshCount() const
+	{
+		return mpHeader->submeshCount;
+	}
+}
\ No newline at end of file
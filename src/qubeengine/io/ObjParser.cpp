@@ -0,0 +1,674 @@
+#include <qubeengine/io/ObjParser.h>
+
+#include <qubeengine/io/FileView.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace qe::io
+{
+	static const double POWERS_OF_TEN[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	static inline bool isSpace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	static inline bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	static inline bool isKeyword(const char* p, const char* pEnd, const char* pKeyword, std::size_t length)
+	{
+		return static_cast<std::size_t>(pEnd - p) >= length && std::memcmp(p, pKeyword, length) == 0 &&
+			(p + length == pEnd || isSpace(p[length]));
+	}
+
+	void ObjParser::parse(const FileView& file, ObjModel& model, thread::JobSystem* pJobSystem)
+	{
+		parse(reinterpret_cast<const char*>(file.getData()), file.getSize(), model, pJobSystem);
+	}
+
+	void ObjParser::parse(const char* pText, std::size_t size, ObjModel& model, thread::JobSystem* pJobSystem)
+	{
+		model = ObjModel();
+
+		std::size_t threadCount = pJobSystem ? pJobSystem->getThreadCount() + 1 : 1;
+		std::size_t chunkCount = std::max<std::size_t>(1, std::min(size / MIN_CHUNK_SIZE, threadCount * 4));
+		std::vector<Chunk> chunks(chunkCount);
+
+		//Every chunk ends after the first line break past its share of the text.
+		const char* pTextEnd = pText + size;
+		const char* pBegin = pText;
+		for (std::size_t i = 0; i < chunkCount; ++i)
+		{
+			const char* pSplit = pTextEnd;
+			if (i + 1 < chunkCount)
+			{
+				pSplit = std::max(pBegin, pText + size * (i + 1) / chunkCount);
+				const char* pLineEnd = static_cast<const char*>(std::memchr(pSplit, '\n', pTextEnd - pSplit));
+				pSplit = pLineEnd ? pLineEnd + 1 : pTextEnd;
+			}
+
+			chunks[i].pBegin = pBegin;
+			chunks[i].pEnd = pSplit;
+			pBegin = pSplit;
+		}
+
+		auto forEachChunk = [&](const std::function<void(Chunk& chunk)>& function)
+		{
+			if (!pJobSystem)
+			{
+				for (Chunk& chunk : chunks)
+				{
+					function(chunk);
+				}
+				return;
+			}
+
+			pJobSystem->parallelFor(chunks.size(), 1, [&](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t i = begin; i < end; ++i)
+				{
+					function(chunks[i]);
+				}
+			});
+		};
+
+		auto throwOnError = [&]()
+		{
+			for (const Chunk& chunk : chunks)
+			{
+				if (!chunk.error.empty())
+				{
+					throw std::runtime_error(chunk.error);
+				}
+			}
+		};
+
+		forEachChunk([](Chunk& chunk) { parseChunk(chunk); });
+		throwOnError();
+
+		//Every chunk copies its attributes behind the ones of the chunks before it.
+		uint32 positionCount = 0;
+		uint32 texCoordCount = 0;
+		uint32 normalCount = 0;
+		for (Chunk& chunk : chunks)
+		{
+			chunk.positionBase = positionCount;
+			chunk.texCoordBase = texCoordCount;
+			chunk.normalBase = normalCount;
+			positionCount += static_cast<uint32>(chunk.positions.size() / 3);
+			texCoordCount += static_cast<uint32>(chunk.texCoords.size() / 2);
+			normalCount += static_cast<uint32>(chunk.normals.size() / 3);
+		}
+
+		model.positions.resize((std::size_t)positionCount * 3);
+		model.texCoords.resize((std::size_t)texCoordCount * 2);
+		model.normals.resize((std::size_t)normalCount * 3);
+
+		forEachChunk([&model](Chunk& chunk) { resolveChunk(chunk, model); });
+		throwOnError();
+
+		forEachChunk([&model](Chunk& chunk) { triangulateChunk(chunk, model.positions); });
+
+		//Shapes can span chunks, so they are put together in order.
+		ObjShape shape;
+		for (Chunk& chunk : chunks)
+		{
+			for (Segment& segment : chunk.segments)
+			{
+				if (segment.startsShape)
+				{
+					if (!shape.indices.empty())
+					{
+						model.shapes.push_back(std::move(shape));
+					}
+
+					shape = ObjShape();
+					shape.name = std::move(segment.name);
+				}
+
+				if (shape.indices.empty())
+				{
+					shape.indices = std::move(segment.triangles);
+				}
+				else
+				{
+					shape.indices.insert(shape.indices.end(), segment.triangles.begin(), segment.triangles.end());
+				}
+			}
+		}
+
+		if (!shape.indices.empty())
+		{
+			model.shapes.push_back(std::move(shape));
+		}
+	}
+
+	void ObjParser::parseChunk(Chunk& chunk)
+	{
+		chunk.segments.push_back({ false, "", 0, {} });
+
+		const char* p = chunk.pBegin;
+		while (p < chunk.pEnd)
+		{
+			const char* pLineEnd = static_cast<const char*>(std::memchr(p, '\n', chunk.pEnd - p));
+			if (!pLineEnd)
+			{
+				pLineEnd = chunk.pEnd;
+			}
+
+			if (!parseLine(chunk, p, pLineEnd))
+			{
+				chunk.error = "Failed to parse OBJ line: " + std::string(p, pLineEnd);
+				return;
+			}
+
+			p = pLineEnd < chunk.pEnd ? pLineEnd + 1 : chunk.pEnd;
+		}
+	}
+
+	bool ObjParser::parseLine(Chunk& chunk, const char* p, const char* pEnd)
+	{
+		while (pEnd > p && (pEnd[-1] == '\r' || isSpace(pEnd[-1])))
+		{
+			--pEnd;
+		}
+
+		while (p < pEnd && isSpace(*p))
+		{
+			++p;
+		}
+
+		if (p == pEnd || *p == '#')
+		{
+			return true;
+		}
+
+		//Missing coordinates default to 0 and anything after them, such as w or vertex colors, is ignored.
+		auto parseFloats = [&](const char* pValues, std::vector<float>& values, uint32 count)
+		{
+			for (uint32 i = 0; i < count; ++i)
+			{
+				while (pValues < pEnd && isSpace(*pValues))
+				{
+					++pValues;
+				}
+
+				float value = 0.0f;
+				if (pValues < pEnd && !parseFloat(pValues, pEnd, value))
+				{
+					return false;
+				}
+
+				values.push_back(value);
+			}
+
+			return true;
+		};
+
+		if (isKeyword(p, pEnd, "v", 1))
+		{
+			return parseFloats(p + 1, chunk.positions, 3);
+		}
+		else if (isKeyword(p, pEnd, "vt", 2))
+		{
+			return parseFloats(p + 2, chunk.texCoords, 2);
+		}
+		else if (isKeyword(p, pEnd, "vn", 2))
+		{
+			return parseFloats(p + 2, chunk.normals, 3);
+		}
+		else if (isKeyword(p, pEnd, "f", 1))
+		{
+			return parseFace(chunk, p + 1, pEnd);
+		}
+		else if (isKeyword(p, pEnd, "o", 1) || isKeyword(p, pEnd, "g", 1))
+		{
+			chunk.segments.push_back({ true, parseName(p + 1, pEnd), static_cast<uint32>(chunk.faceStarts.size()), {} });
+		}
+
+		return true;
+	}
+
+	bool ObjParser::parseFace(Chunk& chunk, const char* p, const char* pEnd)
+	{
+		uint32 firstCorner = static_cast<uint32>(chunk.corners.size());
+		int32 counts[3] =
+		{
+			static_cast<int32>(chunk.positions.size() / 3),
+			static_cast<int32>(chunk.texCoords.size() / 2),
+			static_cast<int32>(chunk.normals.size() / 3)
+		};
+
+		while (true)
+		{
+			while (p < pEnd && isSpace(*p))
+			{
+				++p;
+			}
+
+			if (p == pEnd)
+			{
+				break;
+			}
+
+			//v, v/vt, v//vn or v/vt/vn. Positive indices count from 1, negative ones back from the last
+			//attribute read so far.
+			int32 values[3] = { 0, 0, 0 };
+			if (!parseInt(p, pEnd, values[0]))
+			{
+				return false;
+			}
+
+			if (p < pEnd && *p == '/')
+			{
+				++p;
+				if (p < pEnd && *p != '/' && !parseInt(p, pEnd, values[1]))
+				{
+					return false;
+				}
+
+				if (p < pEnd && *p == '/')
+				{
+					++p;
+					if (!parseInt(p, pEnd, values[2]))
+					{
+						return false;
+					}
+				}
+			}
+
+			if (p < pEnd && !isSpace(*p))
+			{
+				return false;
+			}
+
+			int32 resolved[3] = { -1, -1, -1 };
+			uint8 relativeComponents = 0;
+			for (uint32 i = 0; i < 3; ++i)
+			{
+				if (values[i] > 0)
+				{
+					resolved[i] = values[i] - 1;
+				}
+				else if (values[i] < 0)
+				{
+					resolved[i] = counts[i] + values[i];
+					relativeComponents |= 1 << i;
+				}
+				else if (i == 0)
+				{
+					return false;
+				}
+			}
+
+			if (relativeComponents != 0)
+			{
+				chunk.fixups.push_back({ static_cast<uint32>(chunk.corners.size()), relativeComponents });
+			}
+
+			chunk.corners.push_back({ resolved[0], resolved[1], resolved[2] });
+		}
+
+		//Points and lines written as faces are dropped, like tinyobjloader does.
+		if (chunk.corners.size() - firstCorner < 3)
+		{
+			chunk.corners.resize(firstCorner);
+			while (!chunk.fixups.empty() && chunk.fixups.back().corner >= firstCorner)
+			{
+				chunk.fixups.pop_back();
+			}
+
+			return true;
+		}
+
+		chunk.faceStarts.push_back(firstCorner);
+
+		return true;
+	}
+
+	bool ObjParser::parseFloat(const char*& p, const char* pEnd, float& value)
+	{
+		bool isNegative = false;
+		if (p < pEnd && (*p == '-' || *p == '+'))
+		{
+			isNegative = *p == '-';
+			++p;
+		}
+
+		//Up to 19 significant digits fit the mantissa, the rest only move the exponent.
+		uint64 mantissa = 0;
+		int32 exponent = 0;
+		int32 digitCount = 0;
+		bool hasDigits = false;
+
+		while (p < pEnd && isDigit(*p))
+		{
+			if (digitCount < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				digitCount += mantissa != 0;
+			}
+			else
+			{
+				++exponent;
+			}
+
+			hasDigits = true;
+			++p;
+		}
+
+		if (p < pEnd && *p == '.')
+		{
+			++p;
+			while (p < pEnd && isDigit(*p))
+			{
+				if (digitCount < 19)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					digitCount += mantissa != 0;
+					--exponent;
+				}
+
+				hasDigits = true;
+				++p;
+			}
+		}
+
+		if (!hasDigits)
+		{
+			return false;
+		}
+
+		if (p < pEnd && (*p == 'e' || *p == 'E'))
+		{
+			++p;
+			int32 exponentValue = 0;
+			if (!parseInt(p, pEnd, exponentValue))
+			{
+				return false;
+			}
+
+			exponent += exponentValue;
+		}
+
+		double result = static_cast<double>(mantissa);
+		if (exponent >= 0 && exponent <= 22)
+		{
+			result *= POWERS_OF_TEN[exponent];
+		}
+		else if (exponent < 0 && exponent >= -22)
+		{
+			result /= POWERS_OF_TEN[-exponent];
+		}
+		else
+		{
+			result *= std::pow(10.0, exponent);
+		}
+
+		value = static_cast<float>(isNegative ? -result : result);
+
+		return true;
+	}
+
+	bool ObjParser::parseInt(const char*& p, const char* pEnd, int32& value)
+	{
+		bool isNegative = false;
+		if (p < pEnd && (*p == '-' || *p == '+'))
+		{
+			isNegative = *p == '-';
+			++p;
+		}
+
+		if (p == pEnd || !isDigit(*p))
+		{
+			return false;
+		}
+
+		int64 result = 0;
+		while (p < pEnd && isDigit(*p))
+		{
+			result = std::min<int64>(result * 10 + (*p - '0'), std::numeric_limits<int32>::max());
+			++p;
+		}
+
+		value = static_cast<int32>(isNegative ? -result : result);
+
+		return true;
+	}
+
+	std::string ObjParser::parseName(const char* p, const char* pEnd)
+	{
+		//Several group names are joined with single spaces.
+		std::string name;
+		while (p < pEnd)
+		{
+			while (p < pEnd && isSpace(*p))
+			{
+				++p;
+			}
+
+			const char* pWordEnd = p;
+			while (pWordEnd < pEnd && !isSpace(*pWordEnd))
+			{
+				++pWordEnd;
+			}
+
+			if (pWordEnd != p)
+			{
+				if (!name.empty())
+				{
+					name += ' ';
+				}
+				name.append(p, pWordEnd);
+			}
+
+			p = pWordEnd;
+		}
+
+		return name;
+	}
+
+	bool ObjParser::resolveChunk(Chunk& chunk, ObjModel& model)
+	{
+		std::copy(chunk.positions.begin(), chunk.positions.end(), model.positions.begin() + (std::size_t)chunk.positionBase * 3);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), model.texCoords.begin() + (std::size_t)chunk.texCoordBase * 2);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), model.normals.begin() + (std::size_t)chunk.normalBase * 3);
+		chunk.positions = std::vector<float>();
+		chunk.texCoords = std::vector<float>();
+		chunk.normals = std::vector<float>();
+
+		for (const Fixup& fixup : chunk.fixups)
+		{
+			ObjIndex& corner = chunk.corners[fixup.corner];
+			if (fixup.components & 1)
+				corner.position += static_cast<int32>(chunk.positionBase);
+			if (fixup.components & 2)
+				corner.texCoord += static_cast<int32>(chunk.texCoordBase);
+			if (fixup.components & 4)
+				corner.normal += static_cast<int32>(chunk.normalBase);
+		}
+
+		int32 positionCount = static_cast<int32>(model.positions.size() / 3);
+		int32 texCoordCount = static_cast<int32>(model.texCoords.size() / 2);
+		int32 normalCount = static_cast<int32>(model.normals.size() / 3);
+
+		for (const ObjIndex& corner : chunk.corners)
+		{
+			if (corner.position < 0 || corner.position >= positionCount || corner.texCoord < -1 || corner.texCoord >= texCoordCount ||
+				corner.normal < -1 || corner.normal >= normalCount)
+			{
+				chunk.error = "Failed to parse OBJ, a face references a vertex attribute that does not exist.";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void ObjParser::triangulateChunk(Chunk& chunk, const std::vector<float>& positions)
+	{
+		for (std::size_t i = 0; i < chunk.segments.size(); ++i)
+		{
+			Segment& segment = chunk.segments[i];
+			std::size_t faceEnd = i + 1 < chunk.segments.size() ? chunk.segments[i + 1].firstFace : chunk.faceStarts.size();
+			segment.triangles.reserve((faceEnd - segment.firstFace) * 3);
+
+			for (std::size_t face = segment.firstFace; face < faceEnd; ++face)
+			{
+				uint32 cornerBegin = chunk.faceStarts[face];
+				uint32 cornerEnd = face + 1 < chunk.faceStarts.size() ? chunk.faceStarts[face + 1] : static_cast<uint32>(chunk.corners.size());
+				triangulatePolygon(&chunk.corners[cornerBegin], cornerEnd - cornerBegin, positions, segment.triangles);
+			}
+		}
+
+		chunk.corners = std::vector<ObjIndex>();
+		chunk.faceStarts = std::vector<uint32>();
+	}
+
+	void ObjParser::triangulatePolygon(const ObjIndex* pCorners, uint32 count, const std::vector<float>& positions, std::vector<ObjIndex>& triangles)
+	{
+		if (count == 3)
+		{
+			triangles.insert(triangles.end(), pCorners, pCorners + 3);
+			return;
+		}
+
+		auto getCoordinate = [&positions](const ObjIndex& corner, std::size_t axis)
+		{
+			return positions[(std::size_t)corner.position * 3 + axis];
+		};
+
+		//Ear clipping in the plane of the two axes the polygon is widest along, ported from tinyobjloader so
+		//both produce the same triangles. The axes come from the first corner that is not degenerate.
+		std::size_t axes[2] = { 1, 2 };
+		for (uint32 k = 0; k < count; ++k)
+		{
+			const ObjIndex& i0 = pCorners[k % count];
+			const ObjIndex& i1 = pCorners[(k + 1) % count];
+			const ObjIndex& i2 = pCorners[(k + 2) % count];
+
+			float e0x = getCoordinate(i1, 0) - getCoordinate(i0, 0);
+			float e0y = getCoordinate(i1, 1) - getCoordinate(i0, 1);
+			float e0z = getCoordinate(i1, 2) - getCoordinate(i0, 2);
+			float e1x = getCoordinate(i2, 0) - getCoordinate(i1, 0);
+			float e1y = getCoordinate(i2, 1) - getCoordinate(i1, 1);
+			float e1z = getCoordinate(i2, 2) - getCoordinate(i1, 2);
+			float cx = std::fabs(e0y * e1z - e0z * e1y);
+			float cy = std::fabs(e0z * e1x - e0x * e1z);
+			float cz = std::fabs(e0x * e1y - e0y * e1x);
+
+			const float epsilon = std::numeric_limits<float>::epsilon();
+			if (cx > epsilon || cy > epsilon || cz > epsilon)
+			{
+				if (!(cx > cy && cx > cz))
+				{
+					axes[0] = 0;
+					if (cz > cx && cz > cy)
+						axes[1] = 1;
+				}
+				break;
+			}
+		}
+
+		//The sign of the area tells the winding, ears have to match it.
+		float area = 0.0f;
+		for (uint32 k = 0; k < count; ++k)
+		{
+			const ObjIndex& i0 = pCorners[k];
+			const ObjIndex& i1 = pCorners[(k + 1) % count];
+			area += (getCoordinate(i0, axes[0]) * getCoordinate(i1, axes[1]) - getCoordinate(i0, axes[1]) * getCoordinate(i1, axes[0])) * 0.5f;
+		}
+
+		std::vector<ObjIndex> remaining(pCorners, pCorners + count);
+		std::size_t guess = 0;
+		std::size_t remainingIterations = count;
+		std::size_t previousRemaining = count;
+		ObjIndex ear[3];
+		float vx[3];
+		float vy[3];
+
+		//Gives up once a full round finds no ear, which only happens for broken polygons.
+		while (remaining.size() > 3 && remainingIterations > 0)
+		{
+			std::size_t polygonSize = remaining.size();
+			if (guess >= polygonSize)
+			{
+				guess -= polygonSize;
+			}
+
+			if (previousRemaining != polygonSize)
+			{
+				previousRemaining = polygonSize;
+				remainingIterations = polygonSize;
+			}
+			else
+			{
+				remainingIterations--;
+			}
+
+			for (std::size_t k = 0; k < 3; ++k)
+			{
+				ear[k] = remaining[(guess + k) % polygonSize];
+				vx[k] = getCoordinate(ear[k], axes[0]);
+				vy[k] = getCoordinate(ear[k], axes[1]);
+			}
+
+			float e0x = vx[1] - vx[0];
+			float e0y = vy[1] - vy[0];
+			float e1x = vx[2] - vx[1];
+			float e1y = vy[2] - vy[1];
+			float cross = e0x * e1y - e0y * e1x;
+
+			if (cross * area < 0.0f)
+			{
+				guess += 1;
+				continue;
+			}
+
+			bool isOverlapping = false;
+			for (std::size_t other = 3; other < polygonSize && !isOverlapping; ++other)
+			{
+				const ObjIndex& corner = remaining[(guess + other) % polygonSize];
+				float tx = getCoordinate(corner, axes[0]);
+				float ty = getCoordinate(corner, axes[1]);
+
+				//Point in triangle by counting edge crossings.
+				bool isInside = false;
+				for (std::size_t i = 0, j = 2; i < 3; j = i++)
+				{
+					if (((vy[i] > ty) != (vy[j] > ty)) && (tx < (vx[j] - vx[i]) * (ty - vy[i]) / (vy[j] - vy[i]) + vx[i]))
+						isInside = !isInside;
+				}
+
+				isOverlapping = isInside;
+			}
+
+			if (isOverlapping)
+			{
+				guess += 1;
+				continue;
+			}
+
+			triangles.insert(triangles.end(), ear, ear + 3);
+			remaining.erase(remaining.begin() + (guess + 1) % polygonSize);
+		}
+
+		if (remaining.size() == 3)
+		{
+			triangles.insert(triangles.end(), remaining.begin(), remaining.end());
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,253 @@
+#include <qubeengine/io/ResourceArchive.h>
+
+#include <qubeengine/util/Hash.h>
+#include <qubeengine/util/Lz4.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace qe::io
+{
+	bool ResourceArchive::write(const std::string& path, const std::vector<Entry>& entries)
+	{
+		auto align = [](uint64 offset) { return (offset + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1); };
+
+		Header header = {};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.fileCount = static_cast<uint32>(entries.size());
+		header.bucketCount = 1;
+		while (header.bucketCount < 2 * entries.size())
+		{
+			header.bucketCount *= 2;
+		}
+
+		std::vector<uint32> buckets(header.bucketCount, 0);
+		std::vector<Record> records(entries.size());
+		std::string strings;
+
+		for (std::size_t i = 0; i < entries.size(); ++i)
+		{
+			Record& record = records[i];
+			record = {};
+			record.pathHash = hashPath(entries[i].path);
+			record.pathOffset = static_cast<uint32>(strings.size());
+			strings.append(entries[i].path).push_back('\0');
+
+			uint32 bucket = static_cast<uint32>(util::mixBits(record.pathHash)) & (header.bucketCount - 1);
+			while (buckets[bucket] != 0)
+			{
+				bucket = (bucket + 1) & (header.bucketCount - 1);
+			}
+
+			buckets[bucket] = static_cast<uint32>(i + 1);
+		}
+
+		header.stringSize = static_cast<uint32>(strings.size());
+
+		//Written next to the destination first, so an archive that is cut short never replaces a good one.
+		//The tables go in last, once the files have been stored and their offsets are known.
+		std::string tempPath = path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				return false;
+			}
+
+			uint64 tableSize = sizeof(Header) + sizeof(uint32) * buckets.size() + sizeof(Record) * records.size() + strings.size();
+			uint64 offset = align(tableSize);
+			std::vector<uint8> compressed;
+			bool isComplete = true;
+
+			for (std::size_t i = 0; i < entries.size(); ++i)
+			{
+				MappedFile source;
+				if (!source.open(entries[i].filePath))
+				{
+					isComplete = false;
+					break;
+				}
+
+				Record& record = records[i];
+				record.offset = offset;
+				record.size = source.getSize();
+				record.storedSize = source.getSize();
+				record.compression = static_cast<uint32>(Compression::None);
+				const uint8* pStored = source.getData();
+
+				if (entries[i].compress)
+				{
+					compressed.resize(util::Lz4::getMaxCompressedSize(source.getSize()));
+					std::size_t compressedSize = util::Lz4::compress(source.getData(), source.getSize(), compressed.data());
+
+					if (compressedSize <= source.getSize() - source.getSize() / 8)
+					{
+						record.storedSize = compressedSize;
+						record.compression = static_cast<uint32>(Compression::Lz4);
+						pStored = compressed.data();
+					}
+				}
+
+				file.seekp(static_cast<std::streamoff>(offset));
+				file.write(reinterpret_cast<const char*>(pStored), static_cast<std::streamsize>(record.storedSize));
+				offset = align(offset + record.storedSize);
+			}
+
+			//The last file is padded as well, so every file is a whole number of pages.
+			file.seekp(static_cast<std::streamoff>(offset - 1));
+			file.put('\0');
+
+			file.seekp(0);
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			file.write(reinterpret_cast<const char*>(buckets.data()), static_cast<std::streamsize>(sizeof(uint32) * buckets.size()));
+			file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(sizeof(Record) * records.size()));
+			file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+
+			if (!isComplete || !file.good())
+			{
+				file.close();
+				std::remove(tempPath.c_str());
+				return false;
+			}
+		}
+
+		std::remove(path.c_str());
+
+		return std::rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+
+	bool ResourceArchive::open(const std::string& path)
+	{
+		close();
+
+		//Packed files are opened one by one, not read front to back.
+		if (!mFile.open(path, AccessHint::Random) || mFile.getSize() < sizeof(Header))
+		{
+			mFile.close();
+			return false;
+		}
+
+		const Header* pHeader = reinterpret_cast<const Header*>(mFile.getData());
+		uint64 recordOffset = sizeof(Header) + (uint64)sizeof(uint32) * pHeader->bucketCount;
+		uint64 stringOffset = recordOffset + (uint64)sizeof(Record) * pHeader->fileCount;
+
+		bool isValid = pHeader->magic == MAGIC && pHeader->version == VERSION && pHeader->bucketCount > 0 &&
+			(pHeader->bucketCount & (pHeader->bucketCount - 1)) == 0 && pHeader->fileCount < pHeader->bucketCount &&
+			stringOffset + pHeader->stringSize <= mFile.getSize() && (pHeader->stringSize == 0 || mFile.getData()[stringOffset + pHeader->stringSize - 1] == '\0');
+
+		const uint32* pBuckets = reinterpret_cast<const uint32*>(mFile.getData() + sizeof(Header));
+		const Record* pRecords = reinterpret_cast<const Record*>(mFile.getData() + recordOffset);
+
+		//Lookups stop at an empty bucket, without one a missing path would probe forever.
+		uint32 emptyBucketCount = 0;
+		for (uint32 i = 0; isValid && i < pHeader->bucketCount; ++i)
+		{
+			isValid = pBuckets[i] <= pHeader->fileCount;
+			emptyBucketCount += pBuckets[i] == 0 ? 1 : 0;
+		}
+
+		isValid = isValid && emptyBucketCount > 0;
+
+		//Paths start inside the strings, which end with a terminator, and files end inside the archive.
+		for (uint32 i = 0; isValid && i < pHeader->fileCount; ++i)
+		{
+			const Record& record = pRecords[i];
+			isValid = record.pathOffset < pHeader->stringSize && record.offset <= mFile.getSize() && record.storedSize <= mFile.getSize() - record.offset &&
+				(record.compression == static_cast<uint32>(Compression::Lz4) || (record.compression == static_cast<uint32>(Compression::None) &&
+				record.storedSize == record.size));
+		}
+
+		if (!isValid)
+		{
+			mFile.close();
+			return false;
+		}
+
+		mpHeader = pHeader;
+		mpBuckets = pBuckets;
+		mpRecords = pRecords;
+		mpStrings = reinterpret_cast<const char*>(mFile.getData() + stringOffset);
+
+		return true;
+	}
+
+	void ResourceArchive::close()
+	{
+		mFile.close();
+		mpHeader = nullptr;
+		mpBuckets = nullptr;
+		mpRecords = nullptr;
+		mpStrings = nullptr;
+	}
+
+	bool ResourceArchive::isOpen() const
+	{
+		return mpHeader != nullptr;
+	}
+
+	uint32 ResourceArchive::getFileCount() const
+	{
+		return mpHeader ? mpHeader->fileCount : 0;
+	}
+
+	bool ResourceArchive::openFile(const std::string& path, FileView& file, AccessHint hint) const
+	{
+		if (!isOpen())
+		{
+			return false;
+		}
+
+		//Probes end at the first empty bucket, the table is at most half full.
+		uint64 pathHash = hashPath(path);
+		uint32 mask = mpHeader->bucketCount - 1;
+		const Record* pRecord = nullptr;
+
+		for (uint32 bucket = static_cast<uint32>(util::mixBits(pathHash)) & mask; mpBuckets[bucket] != 0; bucket = (bucket + 1) & mask)
+		{
+			const Record& record = mpRecords[mpBuckets[bucket] - 1];
+			if (record.pathHash == pathHash && path == mpStrings + record.pathOffset)
+			{
+				pRecord = &record;
+				break;
+			}
+		}
+
+		if (!pRecord)
+		{
+			return false;
+		}
+
+		file.close();
+
+		if (pRecord->compression == static_cast<uint32>(Compression::None))
+		{
+			file.mpMapping = &mFile;
+			file.mOffset = static_cast<std::size_t>(pRecord->offset);
+			file.mpData = mFile.getData() + pRecord->offset;
+			file.mSize = static_cast<std::size_t>(pRecord->size);
+			file.advise(0, file.mSize, hint);
+
+			return true;
+		}
+
+		file.mDecompressed.resize(static_cast<std::size_t>(pRecord->size));
+		if (!util::Lz4::decompress(mFile.getData() + pRecord->offset, static_cast<std::size_t>(pRecord->storedSize), file.mDecompressed.data(),
+			file.mDecompressed.size()))
+		{
+			file.close();
+			return false;
+		}
+
+		file.mpData = file.mDecompressed.data();
+		file.mSize = file.mDecompressed.size();
+
+		return true;
+	}
+
+	uint64 ResourceArchive::hashPath(const std::string& path)
+	{
+		return util::hashBytes(path.data(), path.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <qubeengine/io/ResourceLocator.h>
+
+#include <cstdlib>
+#include <filesystem>
+
+namespace qe::io
+{
+	bool ResourceLocator::findResDirectory(std::string& directory)
+	{
+		std::error_code error;
+
+		const char* pOverride = std::getenv(ENVIRONMENT_VARIABLE);
+		if (pOverride && *pOverride)
+		{
+			if (!std::filesystem::is_directory(pOverride, error))
+			{
+				return false;
+			}
+
+			directory = (std::filesystem::path(pOverride) / "").generic_string();
+			return true;
+		}
+
+		std::filesystem::path current = std::filesystem::current_path(error);
+		if (error)
+		{
+			return false;
+		}
+
+		//Walks up until the root, whose parent is itself.
+		while (true)
+		{
+			std::filesystem::path candidate = current / "res";
+			if (std::filesystem::is_directory(candidate / "scenes", error))
+			{
+				directory = (candidate / "").generic_string();
+				return true;
+			}
+
+			if (current == current.parent_path() || current.empty())
+			{
+				return false;
+			}
+
+			current = current.parent_path();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <qubeengine/io/TextureCache.h>
+
+#include <qubeengine/texture/BlockCompressor.h>
+#include <qubeengine/texture/MipChain.h>
+#include <qubeengine/util/Hash.h>
+
+#include <cstdio>
+#include <fstream>
+
+namespace qe::io
+{
+	uint64 TextureCache::computeSourceKey(const FileView& source)
+	{
+		//The format version is part of the key, so cooking changes invalidate every cache.
+		return hashValue(VERSION, hashBytes(source.getData(), source.getSize()));
+	}
+
+	bool TextureCache::write(const std::string& path, uint64 sourceKey, const Contents& contents)
+	{
+		if (contents.levelCount == 0 || contents.levelCount > MAX_LEVEL_COUNT)
+		{
+			return false;
+		}
+
+		Header header = {};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.sourceKey = sourceKey;
+		header.format = contents.format;
+		header.width = contents.width;
+		header.height = contents.height;
+		header.levelCount = contents.levelCount;
+		header.dataOffset = (sizeof(Header) + BLOB_ALIGNMENT - 1) & ~(BLOB_ALIGNMENT - 1);
+
+		for (uint32 level = 0; level <= contents.levelCount; ++level)
+		{
+			header.levelOffsets[level] = contents.pLevelOffsets[level];
+		}
+
+		//Written next to the destination first, so a cache that is cut short never replaces a good one.
+		std::string tempPath = path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				return false;
+			}
+
+			const char zeros[BLOB_ALIGNMENT] = {};
+			file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			file.write(zeros, static_cast<std::streamsize>(header.dataOffset - sizeof(Header)));
+			file.write(static_cast<const char*>(contents.pData), static_cast<std::streamsize>(contents.pLevelOffsets[contents.levelCount]));
+
+			if (!file.good())
+			{
+				file.close();
+				std::remove(tempPath.c_str());
+				return false;
+			}
+		}
+
+		std::remove(path.c_str());
+
+		return std::rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+
+	bool TextureCache::open(const FileSystem& fileSystem, const std::string& path, uint64 sourceKey)
+	{
+		close();
+
+		if (!fileSystem.open(path, mFile) || mFile.getSize() < sizeof(Header))
+		{
+			mFile.close();
+			return false;
+		}
+
+		const Header* pHeader = reinterpret_cast<const Header*>(mFile.getData());
+
+		bool isValid = pHeader->magic == MAGIC && pHeader->version == VERSION && pHeader->sourceKey == sourceKey &&
+			pHeader->format <= static_cast<uint32>(texture::TextureFormat::Bc7) && pHeader->width > 0 && pHeader->height > 0 &&
+			pHeader->levelCount > 0 && pHeader->levelCount <= MAX_LEVEL_COUNT &&
+			pHeader->levelCount <= texture::MipChain::getLevelCount(pHeader->width, pHeader->height) &&
+			pHeader->dataOffset >= sizeof(Header) && pHeader->levelOffsets[0] == 0;
+
+		//Every level is copied into the image with the extent of its mip level, so it has to hold that many
+		//texels or blocks and start on one. The last level ends inside the file.
+		texture::TextureFormat format = static_cast<texture::TextureFormat>(pHeader->format);
+		std::size_t blockSize = isValid ? texture::BlockCompressor::getLevelSize(format, 1, 1) : 1;
+
+		for (uint32 level = 0; isValid && level < pHeader->levelCount; ++level)
+		{
+			std::size_t levelSize = texture::BlockCompressor::getLevelSize(format, texture::MipChain::getLevelExtent(pHeader->width, level),
+				texture::MipChain::getLevelExtent(pHeader->height, level));
+
+			isValid = pHeader->levelOffsets[level] % blockSize == 0 && pHeader->levelOffsets[level] < pHeader->levelOffsets[level + 1] &&
+				pHeader->levelOffsets[level + 1] - pHeader->levelOffsets[level] >= levelSize;
+		}
+
+		if (!isValid || pHeader->dataOffset + pHeader->levelOffsets[pHeader->levelCount] > mFile.getSize())
+		{
+			mFile.close();
+			return false;
+		}
+
+		mpHeader = pHeader;
+
+		return true;
+	}
+
+	void TextureCache::close()
+	{
+		mFile.close();
+		mpHeader = nullptr;
+	}
+
+	bool TextureCache::isOpen() const
+	{
+		return mpHeader != nullptr;
+	}
+
+	uint32 TextureCache::getFormat() const
+	{
+		return mpHeader->format;
+	}
+
+	uint32 TextureCache::getWidth() const
+	{
+		return mpHeader->width;
+	}
+
+	uint32 TextureCache::getHeight() const
+	{
+		return mpHeader->height;
+	}
+
+	uint32 TextureCache::getLevelCount() const
+	{
+		return mpHeader->levelCount;
+	}
+
+	const void* TextureCache::getData() const
+	{
+		return mFile.getData() + mpHeader->dataOffset;
+	}
+
+	std::size_t TextureCache::getLevelOffset(uint32 level) const
+	{
+		return static_cast<std::size_t>(mpHeader->levelOffsets[level]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <qubeengine/asset/AssetCooker.h>
+#include <qubeengine/io/ResourceArchive.h>
+#include <qubeengine/io/ResourceLocator.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace qe;
+
+static void printUsage()
+{
+	std::cout << "Usage: QubeAssetCooker [--res <directory>] [--cache <directory>] [--format rgba8|bc1|bc7] [--shader-compiler <path>]" << std::endl;
+	std::cout << "                       [--archive [--compress]]" << std::endl;
+	std::cout << "Cooks the meshes, textures and shaders under the resource directory, by default the res directory found" << std::endl;
+	std::cout << "above the working directory or set in " << io::ResourceLocator::ENVIRONMENT_VARIABLE << ", into the" << std::endl;
+	std::cout << "cache directory, by default cooked inside the resource directory. Unchanged assets are not cooked again." << std::endl;
+	std::cout << "With --archive, everything the runtime loads is packed into " << io::ResourceArchive::FILE_NAME << " in the resource" << std::endl;
+	std::cout << "directory, compressed where that pays off with --compress." << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	std::string resDirectory;
+	std::string cacheDirectory;
+	asset::CookSettings settings;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		bool hasValue = i + 1 < argc;
+
+		if (std::strcmp(argv[i], "--res") == 0 && hasValue)
+		{
+			resDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--cache") == 0 && hasValue)
+		{
+			cacheDirectory = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--format") == 0 && hasValue)
+		{
+			std::string format = argv[++i];
+
+			if (format == "rgba8")
+			{
+				settings.textureFormat = texture::TextureFormat::Rgba8;
+			}
+			else if (format == "bc1")
+			{
+				settings.textureFormat = texture::TextureFormat::Bc1;
+			}
+			else if (format == "bc7")
+			{
+				settings.textureFormat = texture::TextureFormat::Bc7;
+			}
+			else
+			{
+				printUsage();
+				return EXIT_FAILURE;
+			}
+		}
+		else if (std::strcmp(argv[i], "--shader-compiler") == 0 && hasValue)
+		{
+			settings.shaderCompiler = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--archive") == 0)
+		{
+			settings.packArchive = true;
+		}
+		else if (std::strcmp(argv[i], "--compress") == 0)
+		{
+			settings.compressArchive = true;
+		}
+		else
+		{
+			printUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (resDirectory.empty() && !io::ResourceLocator::findResDirectory(resDirectory))
+	{
+		std::cout << "Failed to find the resource directory, pass it with --res." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (cacheDirectory.empty())
+	{
+		cacheDirectory = resDirectory + "/cooked";
+	}
+
+	//The main thread only waits for the cooks, so every core gets a worker.
+	thread::JobSystem jobSystem(std::thread::hardware_concurrency());
+	asset::AssetCooker cooker(resDirectory, cacheDirectory, settings, jobSystem);
+
+	return cooker.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include <qubeengine/mesh/MeshCooker.h>
+
+#include <qubeengine/io/MeshCache.h>
+#include <qubeengine/io/ObjParser.h>
+#include <qubeengine/mesh/MeshOptimizer.h>
+#include <qubeengine/mesh/MeshSimplifier.h>
+#include <qubeengine/mesh/VertexWelder.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace qe::mesh
+{
+	void MeshCooker::cook(const io::FileView& source, CookedMesh& mesh, thread::JobSystem* pJobSystem)
+	{
+		std::vector<Vertex> vertices;
+		std::vector<uint32> indices;
+
+		mesh.submeshes.clear();
+		parse(source, vertices, indices, mesh.submeshes, pJobSystem);
+		pack(vertices, indices, mesh);
+	}
+
+	bool MeshCooker::write(const std::string& path, uint64 sourceKey, const CookedMesh& mesh)
+	{
+		io::MeshCache::Contents contents = {};
+		contents.pVertices = mesh.vertices.data();
+		contents.vertexFormat = mesh.vertexLayout.getKey();
+		contents.vertexStride = mesh.vertexLayout.getStride();
+		contents.vertexCount = mesh.vertexCount;
+		contents.pIndices = mesh.indices.data();
+		contents.indexSize = mesh.indexSize;
+		contents.indexCount = static_cast<uint32>(mesh.indices.size() / mesh.indexSize);
+		contents.pSubmeshes = mesh.submeshes.data();
+		contents.submeshStride = sizeof(Submesh);
+		contents.submeshCount = static_cast<uint32>(mesh.submeshes.size());
+
+		return io::MeshCache::write(path, sourceKey, contents);
+	}
+
+	void MeshCooker::parse(const io::FileView& source, std::vector<Vertex>& vertices, std::vector<uint32>& indices,
+		std::vector<Submesh>& submeshes, thread::JobSystem* pJobSystem)
+	{
+		//The file is split into chunks that are parsed on the job system.
+		io::ObjModel model;
+		io::ObjParser::parse(source, model, pJobSystem);
+
+		std::vector<Vertex> corners;
+		std::vector<Vertex> uniqueVertices;
+		std::vector<Vertex> optimizedVertices;
+		std::vector<uint32> shapeIndices;
+		std::vector<uint32> optimizedIndices;
+
+		//Cache efficiency of the OBJ face order and after the vertex cache and overdraw stages.
+		VertexCacheStats cacheStats[3] = {};
+		uint64 lodCount = 0;
+		uint64 fullTriangleCount = 0;
+		uint64 coarsestTriangleCount = 0;
+
+		for (const io::ObjShape& shape : model.shapes)
+		{
+			if (shape.indices.empty())
+			{
+				continue;
+			}
+
+			Submesh submesh = {};
+			submesh.firstIndex = static_cast<uint32>(indices.size());
+			submesh.vertexOffset = static_cast<int32>(vertices.size());
+			submesh.bounds = scene::Aabb::empty();
+
+			//Every corner becomes a vertex, zero initialized since the welder compares them byte for byte.
+			corners.assign(shape.indices.size(), Vertex{});
+
+			for (std::size_t i = 0; i < shape.indices.size(); ++i)
+			{
+				const io::ObjIndex& index = shape.indices[i];
+				Vertex& vertex = corners[i];
+
+				vertex.pos =
+				{
+					model.positions[(uint64)3 * index.position + 0],
+					model.positions[(uint64)3 * index.position + 1],
+					model.positions[(uint64)3 * index.position + 2]
+				};
+
+				//Faces without texture coordinates sample the corner of the texture.
+				if (index.texCoord >= 0)
+				{
+					vertex.texCoord =
+					{
+						model.texCoords[(uint64)2 * index.texCoord + 0],
+						1.0f - model.texCoords[(uint64)2 * index.texCoord + 1]
+					};
+				}
+			}
+
+			//Every object gets its own vertices so it can be drawn and culled on its own.
+			VertexWelder::weld(corners, uniqueVertices, shapeIndices, pJobSystem);
+
+			//OBJ faces come in authoring order. Reorder them for the vertex cache, draw outward facing clusters
+			//first and lay out the vertices in the order the indices first use them.
+			uint32 indexCount = static_cast<uint32>(shapeIndices.size());
+			uint32 vertexCount = static_cast<uint32>(uniqueVertices.size());
+			optimizedIndices.resize(indexCount);
+			optimizedVertices.resize(vertexCount);
+
+			cacheStats[0] += MeshOptimizer::analyzeVertexCache(shapeIndices.data(), indexCount, vertexCount);
+			MeshOptimizer::optimizeVertexCache(shapeIndices.data(), indexCount, vertexCount, optimizedIndices.data());
+			cacheStats[1] += MeshOptimizer::analyzeVertexCache(optimizedIndices.data(), indexCount, vertexCount);
+			MeshOptimizer::optimizeOverdraw(optimizedIndices.data(), indexCount, &uniqueVertices[0].pos.x, sizeof(Vertex), vertexCount, shapeIndices.data());
+			cacheStats[2] += MeshOptimizer::analyzeVertexCache(shapeIndices.data(), indexCount, vertexCount);
+			MeshOptimizer::optimizeVertexFetch(shapeIndices.data(), indexCount, uniqueVertices.data(), vertexCount, sizeof(Vertex), optimizedVertices.data());
+
+			vertices.insert(vertices.end(), optimizedVertices.begin(), optimizedVertices.end());
+			indices.insert(indices.end(), shapeIndices.begin(), shapeIndices.end());
+
+			for (const Vertex& vertex : optimizedVertices)
+			{
+				submesh.bounds.expand(vertex.pos);
+			}
+
+			submesh.indexCount = static_cast<uint32>(indices.size()) - submesh.firstIndex;
+			submesh.vertexCount = static_cast<uint32>(vertices.size()) - submesh.vertexOffset;
+
+			glm::vec3 center = submesh.bounds.getCenter();
+			submesh.boundingRadius = 0.0f;
+
+			for (uint32 i = 0; i < submesh.vertexCount; ++i)
+			{
+				submesh.boundingRadius = std::max(submesh.boundingRadius, glm::length(vertices[submesh.vertexOffset + i].pos - center));
+			}
+
+			generateLods(indices, vertices, submesh);
+
+			lodCount += submesh.lodCount;
+			fullTriangleCount += submesh.indexCount / 3;
+			coarsestTriangleCount += (submesh.lodCount > 0 ? submesh.lods[submesh.lodCount - 1].indexCount : submesh.indexCount) / 3;
+
+			submeshes.push_back(submesh);
+		}
+
+		std::cout << "Loaded " << submeshes.size() << " submeshes with " << vertices.size() << " vertices!" << std::endl;
+		std::cout << "Generated " << lodCount << " levels of detail, " << fullTriangleCount << " triangles down to " << coarsestTriangleCount << 
+			" at the coarsest level!" << std::endl;
+
+		//The vertex fetch stage only moves vertices, the cache statistics stay those of the overdraw stage.
+		char report[160];
+		std::snprintf(report, sizeof(report), "ACMR: %.3f -> %.3f (vertex cache) -> %.3f (overdraw) | ATVR: %.3f -> %.3f -> %.3f",
+			cacheStats[0].getAcmr(), cacheStats[1].getAcmr(), cacheStats[2].getAcmr(), cacheStats[0].getAtvr(), cacheStats[1].getAtvr(), cacheStats[2].getAtvr());
+		std::cout << "Optimized mesh | " << report << std::endl;
+	}
+
+	void MeshCooker::generateLods(std::vector<uint32>& indices, const std::vector<Vertex>& vertices, Submesh& submesh)
+	{
+		const Vertex* pVertices = &vertices[submesh.vertexOffset];
+		std::vector<uint32> fullIndices(indices.begin() + submesh.firstIndex, indices.begin() + submesh.firstIndex + submesh.indexCount);
+		std::vector<uint32> simplifiedIndices(submesh.indexCount);
+		std::vector<uint32> optimizedIndices;
+
+		float maxError = LOD_MAX_ERROR * submesh.boundingRadius;
+		uint32 previousIndexCount = submesh.indexCount;
+		float previousError = 0.0f;
+
+		submesh.lodCount = 0;
+
+		//Every level starts from the full submesh, so its error is measured against that and not against
+		//the level before it.
+		while (submesh.lodCount < Submesh::MAX_LOD_COUNT)
+		{
+			uint32 targetIndexCount = static_cast<uint32>(previousIndexCount * LOD_REDUCTION) / 3 * 3;
+			float error;
+			uint32 indexCount = MeshSimplifier::simplify(fullIndices.data(), submesh.indexCount, &pVertices[0].pos.x, &pVertices[0].texCoord.x, sizeof(Vertex),
+				submesh.vertexCount, targetIndexCount, maxError, simplifiedIndices.data(), error);
+
+			if (indexCount == 0 || indexCount > previousIndexCount * LOD_MIN_REDUCTION)
+			{
+				break;
+			}
+
+			optimizedIndices.resize(indexCount);
+			MeshOptimizer::optimizeVertexCache(simplifiedIndices.data(), indexCount, submesh.vertexCount, optimizedIndices.data());
+
+			SubmeshLod& lod = submesh.lods[submesh.lodCount++];
+			lod.firstIndex = static_cast<uint32>(indices.size());
+			lod.indexCount = indexCount;
+			lod.error = std::max(error, previousError);
+			indices.insert(indices.end(), optimizedIndices.begin(), optimizedIndices.end());
+
+			previousIndexCount = indexCount;
+			previousError = lod.error;
+		}
+	}
+
+	void MeshCooker::pack(const std::vector<Vertex>& vertices, const std::vector<uint32>& indices, CookedMesh& mesh)
+	{
+		//Indices are relative to the vertex offset of their submesh, so 16 bits are enough while no submesh
+		//has more vertices than that. Primitive restart is off, so 0xFFFF is an ordinary index.
+		uint32 maxVertexCount = 0;
+		for (const Submesh& submesh : mesh.submeshes)
+		{
+			maxVertexCount = std::max(maxVertexCount, submesh.vertexCount);
+		}
+
+		mesh.indexSize = maxVertexCount <= UINT16_MAX + 1 ? 2 : 4;
+
+		if (mesh.indexSize == 2)
+		{
+			mesh.indices.resize(sizeof(uint16) * indices.size());
+			uint16* pIndices = reinterpret_cast<uint16*>(mesh.indices.data());
+
+			for (std::size_t i = 0; i < indices.size(); ++i)
+			{
+				pIndices[i] = static_cast<uint16>(indices[i]);
+			}
+		}
+		else
+		{
+			mesh.indices.resize(sizeof(uint32) * indices.size());
+			std::memcpy(mesh.indices.data(), indices.data(), mesh.indices.size());
+		}
+
+		//Positions are quantized across the bounds of their submesh, the same bounds the vertex shader gets
+		//through the mesh buffer.
+		if (!vertices.empty())
+		{
+			mesh.vertexLayout = render::VertexLayout::choose(&vertices[0].texCoord.x, sizeof(Vertex), vertices.size());
+		}
+
+		uint32 stride = mesh.vertexLayout.getStride();
+		mesh.vertexCount = static_cast<uint32>(vertices.size());
+		mesh.vertices.resize((std::size_t)stride * vertices.size());
+
+		for (const Submesh& submesh : mesh.submeshes)
+		{
+			const Vertex& firstVertex = vertices[submesh.vertexOffset];
+			mesh.vertexLayout.pack(&firstVertex.pos.x, &firstVertex.texCoord.x, sizeof(Vertex), submesh.vertexCount, submesh.bounds.min, submesh.bounds.max,
+				mesh.vertices.data() + (std::size_t)stride * submesh.vertexOffset);
+		}
+
+		std::size_t unpackedSize = sizeof(Vertex) * vertices.size() + sizeof(uint32) * indices.size();
+		std::cout << "Packed the model into " << (mesh.vertices.size() + mesh.indices.size()) / 1024 << " KB instead of " <<
+			unpackedSize / 1024 << " KB, " << stride << " bytes per vertex and " << 8 * mesh.indexSize << " bit indices!" << std::endl;
+	}
+}
\ No newline at end of file
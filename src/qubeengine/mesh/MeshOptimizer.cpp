@@ -0,0 +1,363 @@
+#include <qubeengine/mesh/MeshOptimizer.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace qe::mesh
+{
+	float VertexCacheStats::getAcmr() const
+	{
+		return triangleCount ? static_cast<float>(transformedVertexCount) / triangleCount : 0.0f;
+	}
+
+	float VertexCacheStats::getAtvr() const
+	{
+		return vertexCount ? static_cast<float>(transformedVertexCount) / vertexCount : 0.0f;
+	}
+
+	VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& other)
+	{
+		transformedVertexCount += other.transformedVertexCount;
+		triangleCount += other.triangleCount;
+		vertexCount += other.vertexCount;
+
+		return *this;
+	}
+
+	MeshOptimizer::CacheSimulator::CacheSimulator(uint32 vertexCount, uint32 cacheSize)
+		: timestamps(vertexCount, 0), time(cacheSize + 1), cacheSize(cacheSize)
+	{
+	}
+
+	void MeshOptimizer::CacheSimulator::reset()
+	{
+		//Moving the clock past the cache size ages out every vertex without touching the timestamps.
+		time += cacheSize + 1;
+	}
+
+	uint32 MeshOptimizer::CacheSimulator::addTriangle(const uint32* pTriangle)
+	{
+		uint32 misses = 0;
+
+		for (uint32 corner = 0; corner < 3; ++corner)
+		{
+			uint32 vertex = pTriangle[corner];
+
+			if (time - timestamps[vertex] > cacheSize)
+			{
+				timestamps[vertex] = time++;
+				++misses;
+			}
+		}
+
+		return misses;
+	}
+
+	VertexCacheStats MeshOptimizer::analyzeVertexCache(const uint32* pIndices, uint32 indexCount, uint32 vertexCount, uint32 cacheSize)
+	{
+		VertexCacheStats stats = {};
+		stats.triangleCount = indexCount / 3;
+
+		CacheSimulator cache(vertexCount, cacheSize);
+		std::vector<uint8> referenced(vertexCount, 0);
+
+		for (uint32 triangle = 0; triangle < stats.triangleCount; ++triangle)
+		{
+			stats.transformedVertexCount += cache.addTriangle(pIndices + 3 * triangle);
+		}
+
+		for (uint32 i = 0; i < stats.triangleCount * 3; ++i)
+		{
+			stats.vertexCount += referenced[pIndices[i]] == 0;
+			referenced[pIndices[i]] = 1;
+		}
+
+		return stats;
+	}
+
+	void MeshOptimizer::optimizeVertexCache(const uint32* pIndices, uint32 indexCount, uint32 vertexCount, uint32* pDestination, uint32 cacheSize)
+	{
+		uint32 triangleCount = indexCount / 3;
+
+		//The triangles around every vertex, and how many of them are not emitted yet.
+		std::vector<uint32> liveTriangles(vertexCount, 0);
+		for (uint32 i = 0; i < triangleCount * 3; ++i)
+		{
+			liveTriangles[pIndices[i]]++;
+		}
+
+		std::vector<uint32> adjacencyStarts(vertexCount + 1, 0);
+		for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			adjacencyStarts[vertex + 1] = adjacencyStarts[vertex] + liveTriangles[vertex];
+		}
+
+		std::vector<uint32> adjacency(triangleCount * 3);
+		std::vector<uint32> fillCounts(adjacencyStarts.begin(), adjacencyStarts.end() - 1);
+		for (uint32 i = 0; i < triangleCount * 3; ++i)
+		{
+			adjacency[fillCounts[pIndices[i]]++] = i / 3;
+		}
+
+		std::vector<uint32> timestamps(vertexCount, 0);
+		std::vector<uint8> emitted(triangleCount, 0);
+		std::vector<uint32> deadEnds;
+		std::vector<uint32> candidates;
+		deadEnds.reserve(triangleCount * 3);
+
+		uint32 time = cacheSize + 1;
+		uint32 cursor = 0;
+		uint32 outputCount = 0;
+
+		while (cursor < vertexCount && liveTriangles[cursor] == 0)
+		{
+			++cursor;
+		}
+
+		uint32 fanVertex = cursor < vertexCount ? cursor : UINT32_MAX;
+
+		while (fanVertex != UINT32_MAX)
+		{
+			//Emit every remaining triangle around the fan vertex.
+			candidates.clear();
+
+			for (uint32 i = adjacencyStarts[fanVertex]; i < adjacencyStarts[fanVertex + 1]; ++i)
+			{
+				uint32 triangle = adjacency[i];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+
+				emitted[triangle] = 1;
+
+				for (uint32 corner = 0; corner < 3; ++corner)
+				{
+					uint32 vertex = pIndices[3 * triangle + corner];
+
+					pDestination[outputCount++] = vertex;
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+
+					if (time - timestamps[vertex] > cacheSize)
+					{
+						timestamps[vertex] = time++;
+					}
+				}
+			}
+
+			//Continue with the oldest vertex that is still cached after its own fan is emitted.
+			fanVertex = UINT32_MAX;
+			int64 bestPriority = -1;
+
+			for (uint32 vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+				{
+					continue;
+				}
+
+				int64 priority = 0;
+				uint32 age = time - timestamps[vertex];
+
+				if (age + 2 * liveTriangles[vertex] <= cacheSize)
+				{
+					priority = age;
+				}
+
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					fanVertex = vertex;
+				}
+			}
+
+			//Dead end, go back to the most recently used vertex with triangles left, then to the input order.
+			while (fanVertex == UINT32_MAX && !deadEnds.empty())
+			{
+				uint32 vertex = deadEnds.back();
+				deadEnds.pop_back();
+
+				if (liveTriangles[vertex] > 0)
+				{
+					fanVertex = vertex;
+				}
+			}
+
+			while (fanVertex == UINT32_MAX && cursor < vertexCount)
+			{
+				if (liveTriangles[cursor] > 0)
+				{
+					fanVertex = cursor;
+				}
+
+				++cursor;
+			}
+		}
+	}
+
+	void MeshOptimizer::optimizeOverdraw(const uint32* pIndices, uint32 indexCount, const float* pPositions, uint32 positionStride, uint32 vertexCount,
+		uint32* pDestination, float threshold, uint32 cacheSize)
+	{
+		uint32 triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		std::vector<uint32> clusters;
+		findClusters(pIndices, indexCount, vertexCount, threshold, cacheSize, clusters);
+		clusters.push_back(triangleCount);
+
+		const uint8* pPositionBytes = reinterpret_cast<const uint8*>(pPositions);
+		auto getPosition = [&](uint32 vertex)
+		{
+			const float* pPosition = reinterpret_cast<const float*>(pPositionBytes + (std::size_t)vertex * positionStride);
+			return glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+		};
+
+		//Area weighted centroids and the summed normals of the clusters, the length of a cross product is
+		//twice the area of its triangle.
+		uint32 clusterCount = static_cast<uint32>(clusters.size()) - 1;
+		std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+		std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+		std::vector<float> areas(clusterCount, 0.0f);
+
+		glm::vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+
+		for (uint32 cluster = 0; cluster < clusterCount; ++cluster)
+		{
+			for (uint32 triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+			{
+				glm::vec3 p0 = getPosition(pIndices[3 * triangle + 0]);
+				glm::vec3 p1 = getPosition(pIndices[3 * triangle + 1]);
+				glm::vec3 p2 = getPosition(pIndices[3 * triangle + 2]);
+
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+
+				centroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+				normals[cluster] += normal;
+				areas[cluster] += area;
+			}
+
+			meshCentroid += centroids[cluster];
+			meshArea += areas[cluster];
+		}
+
+		if (meshArea > 0.0f)
+		{
+			meshCentroid = meshCentroid / meshArea;
+		}
+
+		//How far a cluster lies out along its own normal.
+		std::vector<float> sortKeys(clusterCount, 0.0f);
+		std::vector<uint32> order(clusterCount);
+
+		for (uint32 cluster = 0; cluster < clusterCount; ++cluster)
+		{
+			float normalLength = glm::length(normals[cluster]);
+			if (areas[cluster] > 0.0f && normalLength > 0.0f)
+			{
+				sortKeys[cluster] = glm::dot(centroids[cluster] / areas[cluster] - meshCentroid, normals[cluster] / normalLength);
+			}
+
+			order[cluster] = cluster;
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](uint32 a, uint32 b)
+		{
+			return sortKeys[a] > sortKeys[b];
+		});
+
+		uint32 outputCount = 0;
+		for (uint32 cluster : order)
+		{
+			uint32 clusterIndexCount = 3 * (clusters[cluster + 1] - clusters[cluster]);
+			std::memcpy(pDestination + outputCount, pIndices + 3 * clusters[cluster], clusterIndexCount * sizeof(uint32));
+			outputCount += clusterIndexCount;
+		}
+	}
+
+	uint32 MeshOptimizer::optimizeVertexFetch(uint32* pIndices, uint32 indexCount, const void* pVertices, uint32 vertexCount, uint32 vertexSize, void* pDestination)
+	{
+		const uint8* pSource = static_cast<const uint8*>(pVertices);
+		uint8* pTarget = static_cast<uint8*>(pDestination);
+
+		std::vector<uint32> remap(vertexCount, UINT32_MAX);
+		uint32 nextVertex = 0;
+
+		for (uint32 i = 0; i < indexCount; ++i)
+		{
+			uint32& newIndex = remap[pIndices[i]];
+
+			if (newIndex == UINT32_MAX)
+			{
+				std::memcpy(pTarget + (std::size_t)nextVertex * vertexSize, pSource + (std::size_t)pIndices[i] * vertexSize, vertexSize);
+				newIndex = nextVertex++;
+			}
+
+			pIndices[i] = newIndex;
+		}
+
+		return nextVertex;
+	}
+
+	void MeshOptimizer::findClusters(const uint32* pIndices, uint32 indexCount, uint32 vertexCount, float threshold, uint32 cacheSize, std::vector<uint32>& clusters)
+	{
+		uint32 triangleCount = indexCount / 3;
+		CacheSimulator cache(vertexCount, cacheSize);
+
+		//A triangle that misses all its vertices has nothing in common with the ones before it.
+		std::vector<uint32> hardBoundaries;
+		for (uint32 triangle = 0; triangle < triangleCount; ++triangle)
+		{
+			if (cache.addTriangle(pIndices + 3 * triangle) == 3 || triangle == 0)
+			{
+				hardBoundaries.push_back(triangle);
+			}
+		}
+
+		hardBoundaries.push_back(triangleCount);
+		clusters.clear();
+
+		for (std::size_t i = 0; i + 1 < hardBoundaries.size(); ++i)
+		{
+			uint32 begin = hardBoundaries[i];
+			uint32 end = hardBoundaries[i + 1];
+
+			cache.reset();
+			uint32 clusterMisses = 0;
+
+			for (uint32 triangle = begin; triangle < end; ++triangle)
+			{
+				clusterMisses += cache.addTriangle(pIndices + 3 * triangle);
+			}
+
+			//Split as soon as the part so far is within the threshold of the cache efficiency of the whole cluster.
+			float maxAcmr = threshold * clusterMisses / (end - begin);
+			uint32 start = begin;
+			uint32 misses = 0;
+
+			cache.reset();
+			clusters.push_back(begin);
+
+			for (uint32 triangle = begin; triangle + 1 < end; ++triangle)
+			{
+				misses += cache.addTriangle(pIndices + 3 * triangle);
+
+				if (misses <= maxAcmr * (triangle + 1 - start))
+				{
+					clusters.push_back(triangle + 1);
+					start = triangle + 1;
+					misses = 0;
+					cache.reset();
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
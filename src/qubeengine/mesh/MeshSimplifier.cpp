@@ -0,0 +1,540 @@
+#include <qubeengine/mesh/MeshSimplifier.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace qe::mesh
+{
+	//Position and texture coordinate.
+	static const uint32 ATTRIBUTE_COUNT = 5;
+
+	static inline const float* getAttribute(const float* pAttributes, uint32 vertexStride, uint32 vertex)
+	{
+		return reinterpret_cast<const float*>(reinterpret_cast<const uint8*>(pAttributes) + (std::size_t)vertexStride * vertex);
+	}
+
+	static inline double dot(const double* pA, const double* pB)
+	{
+		double result = 0.0;
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			result += pA[i] * pB[i];
+		}
+
+		return result;
+	}
+
+	void MeshSimplifier::Quadric::addTriangle(const double* pP, const double* pQ, const double* pR)
+	{
+		//Two orthonormal directions spanning the triangle. The quadric is the squared distance to the plane
+		//they span through pP, weighted by the area of the triangle.
+		double e1[ATTRIBUTE_COUNT];
+		double e2[ATTRIBUTE_COUNT];
+
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			e1[i] = pQ[i] - pP[i];
+			e2[i] = pR[i] - pP[i];
+		}
+
+		double length1 = std::sqrt(dot(e1, e1));
+		if (length1 < 1e-12)
+		{
+			return;
+		}
+
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			e1[i] /= length1;
+		}
+
+		double projection = dot(e2, e1);
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			e2[i] -= projection * e1[i];
+		}
+
+		double length2 = std::sqrt(dot(e2, e2));
+		if (length2 < 1e-12)
+		{
+			return;
+		}
+
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			e2[i] /= length2;
+		}
+
+		double area = 0.5 * length1 * length2;
+		double pe1 = dot(pP, e1);
+		double pe2 = dot(pP, e2);
+
+		uint32 k = 0;
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			for (uint32 j = i; j < ATTRIBUTE_COUNT; ++j)
+			{
+				a[k++] += area * ((i == j ? 1.0 : 0.0) - e1[i] * e1[j] - e2[i] * e2[j]);
+			}
+
+			b[i] += area * (pe1 * e1[i] + pe2 * e2[i] - pP[i]);
+		}
+
+		c += area * (dot(pP, pP) - pe1 * pe1 - pe2 * pe2);
+		weight += area;
+	}
+
+	MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other)
+	{
+		for (uint32 i = 0; i < 15; ++i)
+		{
+			a[i] += other.a[i];
+		}
+
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			b[i] += other.b[i];
+		}
+
+		c += other.c;
+		weight += other.weight;
+
+		return *this;
+	}
+
+	double MeshSimplifier::Quadric::evaluate(const double* pPoint) const
+	{
+		double result = c;
+		uint32 k = 0;
+
+		for (uint32 i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			for (uint32 j = i; j < ATTRIBUTE_COUNT; ++j)
+			{
+				double term = a[k++] * pPoint[i] * pPoint[j];
+				result += i == j ? term : 2.0 * term;
+			}
+
+			result += 2.0 * b[i] * pPoint[i];
+		}
+
+		//Rounding can take the distance of a point on all planes slightly below zero.
+		return weight > 0.0 ? std::max(result, 0.0) / weight : 0.0;
+	}
+
+	uint32 MeshSimplifier::simplify(const uint32* pIndices, uint32 indexCount, const float* pPositions, const float* pTexCoords, uint32 vertexStride,
+		uint32 vertexCount, uint32 targetIndexCount, float maxError, uint32* pDestination, float& error)
+	{
+		std::vector<uint32> indices(pIndices, pIndices + indexCount);
+		error = 0.0f;
+
+		//Positions are scaled into the unit cube, so the weight of texture coordinates does not depend on the
+		//size of the mesh.
+		glm::vec3 boundsMin(INFINITY);
+		glm::vec3 boundsMax(-INFINITY);
+
+		for (uint32 index : indices)
+		{
+			const float* pPosition = getAttribute(pPositions, vertexStride, index);
+			boundsMin = glm::min(boundsMin, glm::vec3(pPosition[0], pPosition[1], pPosition[2]));
+			boundsMax = glm::max(boundsMax, glm::vec3(pPosition[0], pPosition[1], pPosition[2]));
+		}
+
+		glm::vec3 extent = boundsMax - boundsMin;
+		double scale = std::max(extent.x, std::max(extent.y, extent.z));
+
+		if (indexCount <= targetIndexCount || !(scale > 0.0))
+		{
+			std::memcpy(pDestination, pIndices, sizeof(uint32) * indexCount);
+			return indexCount;
+		}
+
+		std::vector<double> attributes((std::size_t)ATTRIBUTE_COUNT * vertexCount);
+		for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			const float* pPosition = getAttribute(pPositions, vertexStride, vertex);
+			const float* pTexCoord = getAttribute(pTexCoords, vertexStride, vertex);
+			double* pAttributes = &attributes[(std::size_t)ATTRIBUTE_COUNT * vertex];
+
+			pAttributes[0] = (pPosition[0] - boundsMin.x) / scale;
+			pAttributes[1] = (pPosition[1] - boundsMin.y) / scale;
+			pAttributes[2] = (pPosition[2] - boundsMin.z) / scale;
+			pAttributes[3] = pTexCoord[0] * ATTRIBUTE_WEIGHT;
+			pAttributes[4] = pTexCoord[1] * ATTRIBUTE_WEIGHT;
+		}
+
+		//Vertices with the same position are the sides of a texture seam. Sorting by position puts them next to
+		//each other, the first one of a run names the position.
+		std::vector<uint32> sortedVertices(vertexCount);
+		for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			sortedVertices[vertex] = vertex;
+		}
+
+		auto comparePositions = [pPositions, vertexStride](uint32 a, uint32 b)
+		{
+			return std::memcmp(getAttribute(pPositions, vertexStride, a), getAttribute(pPositions, vertexStride, b), 3 * sizeof(float));
+		};
+
+		std::sort(sortedVertices.begin(), sortedVertices.end(), [&](uint32 a, uint32 b) { return comparePositions(a, b) < 0; });
+
+		std::vector<uint32> positionIds(vertexCount);
+		for (uint32 i = 0; i < vertexCount; ++i)
+		{
+			bool isSamePosition = i > 0 && comparePositions(sortedVertices[i - 1], sortedVertices[i]) == 0;
+			positionIds[sortedVertices[i]] = isSamePosition ? positionIds[sortedVertices[i - 1]] : sortedVertices[i];
+		}
+
+		std::vector<VertexKind> kinds;
+		std::vector<uint32> twins;
+		classifyVertices(indices.data(), indexCount, positionIds, kinds, twins);
+
+		std::vector<Quadric> quadrics(vertexCount);
+		std::memset(quadrics.data(), 0, sizeof(Quadric) * quadrics.size());
+
+		for (std::size_t i = 0; i < indices.size(); i += 3)
+		{
+			Quadric triangle = {};
+			triangle.addTriangle(&attributes[(std::size_t)ATTRIBUTE_COUNT * indices[i]], &attributes[(std::size_t)ATTRIBUTE_COUNT * indices[i + 1]],
+				&attributes[(std::size_t)ATTRIBUTE_COUNT * indices[i + 2]]);
+
+			for (uint32 corner = 0; corner < 3; ++corner)
+			{
+				quadrics[indices[i + corner]] += triangle;
+			}
+		}
+
+		double maxCost = (double)maxError / scale;
+		maxCost *= maxCost;
+		double largestCost = 0.0;
+
+		std::vector<uint32> triangleOffsets(vertexCount + 1);
+		std::vector<uint32> triangles;
+		std::vector<Collapse> collapses;
+		std::vector<uint32> remap(vertexCount);
+		std::vector<bool> isTouched(vertexCount);
+
+		//Every pass collapses the cheapest edges whose neighbourhoods do not overlap, then rebuilds the index
+		//list. Passes end when the target is reached or no edge may be collapsed anymore.
+		while (indices.size() > targetIndexCount)
+		{
+			//Triangles around every vertex.
+			std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+			for (uint32 index : indices)
+			{
+				++triangleOffsets[index + 1];
+			}
+
+			for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+			{
+				triangleOffsets[vertex + 1] += triangleOffsets[vertex];
+			}
+
+			triangles.resize(indices.size());
+			std::vector<uint32> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+			for (std::size_t i = 0; i < indices.size(); ++i)
+			{
+				triangles[fill[indices[i]]++] = static_cast<uint32>(i / 3);
+			}
+
+			//A seam vertex takes its twin along onto the vertex at the same place as its target, on the other
+			//side of the seam.
+			auto findTwinTarget = [&](uint32 from, uint32 to)
+			{
+				uint32 twin = twins[from];
+				for (uint32 t = triangleOffsets[twin]; t < triangleOffsets[twin + 1]; ++t)
+				{
+					for (uint32 corner = 0; corner < 3; ++corner)
+					{
+						uint32 vertex = indices[(std::size_t)3 * triangles[t] + corner];
+						if (vertex != twin && positionIds[vertex] == positionIds[to])
+						{
+							return vertex;
+						}
+					}
+				}
+
+				return UINT32_MAX;
+			};
+
+			auto getCost = [&](uint32 from, uint32 to)
+			{
+				Quadric quadric = quadrics[from];
+				quadric += quadrics[to];
+				return quadric.evaluate(&attributes[(std::size_t)ATTRIBUTE_COUNT * to]);
+			};
+
+			collapses.clear();
+			for (std::size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (uint32 corner = 0; corner < 3; ++corner)
+				{
+					uint32 a = indices[i + corner];
+					uint32 b = indices[i + (corner + 1) % 3];
+
+					for (uint32 direction = 0; direction < 2; ++direction)
+					{
+						uint32 from = direction == 0 ? a : b;
+						uint32 to = direction == 0 ? b : a;
+
+						if (kinds[from] == VertexKind::Locked)
+						{
+							continue;
+						}
+
+						double cost = getCost(from, to);
+						if (kinds[from] == VertexKind::Seam)
+						{
+							uint32 twinTarget = findTwinTarget(from, to);
+							if (twinTarget == UINT32_MAX)
+							{
+								continue;
+							}
+
+							cost = std::max(cost, getCost(twins[from], twinTarget));
+						}
+
+						if (cost <= maxCost)
+						{
+							collapses.push_back({ cost, from, to });
+						}
+					}
+				}
+			}
+
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+			for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+			{
+				remap[vertex] = vertex;
+			}
+
+			std::fill(isTouched.begin(), isTouched.end(), false);
+			std::size_t triangleCount = indices.size() / 3;
+			std::size_t targetTriangleCount = targetIndexCount / 3;
+			std::size_t removedTriangleCount = 0;
+
+			//Marks the vertices around one that moves, their triangles change with it.
+			auto touch = [&](uint32 vertex)
+			{
+				for (uint32 t = triangleOffsets[vertex]; t < triangleOffsets[vertex + 1]; ++t)
+				{
+					for (uint32 corner = 0; corner < 3; ++corner)
+					{
+						isTouched[indices[(std::size_t)3 * triangles[t] + corner]] = true;
+					}
+				}
+			};
+
+			auto countRemoved = [&](uint32 from, uint32 to)
+			{
+				std::size_t count = 0;
+				for (uint32 t = triangleOffsets[from]; t < triangleOffsets[from + 1]; ++t)
+				{
+					const uint32* pTriangle = &indices[(std::size_t)3 * triangles[t]];
+					count += pTriangle[0] == to || pTriangle[1] == to || pTriangle[2] == to;
+				}
+
+				return count;
+			};
+
+			for (const Collapse& collapse : collapses)
+			{
+				if (triangleCount - removedTriangleCount <= targetTriangleCount)
+				{
+					break;
+				}
+
+				uint32 from = collapse.from;
+				uint32 to = collapse.to;
+
+				if (isTouched[from] || isTouched[to] || flipsTriangles(from, to, indices, triangleOffsets, triangles, pPositions, vertexStride))
+				{
+					continue;
+				}
+
+				uint32 twin = UINT32_MAX;
+				uint32 twinTarget = UINT32_MAX;
+
+				if (kinds[from] == VertexKind::Seam)
+				{
+					twin = twins[from];
+					twinTarget = findTwinTarget(from, to);
+
+					if (isTouched[twin] || isTouched[twinTarget] ||
+						flipsTriangles(twin, twinTarget, indices, triangleOffsets, triangles, pPositions, vertexStride))
+					{
+						continue;
+					}
+				}
+
+				removedTriangleCount += countRemoved(from, to);
+				touch(from);
+				remap[from] = to;
+				quadrics[to] += quadrics[from];
+
+				//Where the seam ends in to, the twin target is to itself and both sides collapse onto it.
+				if (twin != UINT32_MAX)
+				{
+					removedTriangleCount += countRemoved(twin, twinTarget);
+					touch(twin);
+					remap[twin] = twinTarget;
+					quadrics[twinTarget] += quadrics[twin];
+				}
+
+				largestCost = std::max(largestCost, collapse.cost);
+			}
+
+			if (removedTriangleCount == 0)
+			{
+				break;
+			}
+
+			//Targets never move in the pass that collapses onto them, so one lookup is enough.
+			std::size_t writeIndex = 0;
+			for (std::size_t i = 0; i < indices.size(); i += 3)
+			{
+				uint32 a = remap[indices[i]];
+				uint32 b = remap[indices[i + 1]];
+				uint32 c = remap[indices[i + 2]];
+
+				if (a != b && b != c && c != a)
+				{
+					indices[writeIndex++] = a;
+					indices[writeIndex++] = b;
+					indices[writeIndex++] = c;
+				}
+			}
+
+			indices.resize(writeIndex);
+		}
+
+		std::memcpy(pDestination, indices.data(), sizeof(uint32) * indices.size());
+		error = static_cast<float>(std::sqrt(largestCost) * scale);
+
+		return static_cast<uint32>(indices.size());
+	}
+
+	void MeshSimplifier::classifyVertices(const uint32* pIndices, uint32 indexCount, const std::vector<uint32>& positionIds, std::vector<VertexKind>& kinds,
+		std::vector<uint32>& twins)
+	{
+		uint32 vertexCount = static_cast<uint32>(positionIds.size());
+
+		//Edges between positions, so the two sides of a seam count as one edge. Every edge of a closed
+		//surface has exactly two triangles.
+		std::unordered_map<uint64, uint32> edgeTriangleCounts;
+		for (uint32 i = 0; i < indexCount; i += 3)
+		{
+			for (uint32 corner = 0; corner < 3; ++corner)
+			{
+				uint32 a = positionIds[pIndices[i + corner]];
+				uint32 b = positionIds[pIndices[i + (corner + 1) % 3]];
+				++edgeTriangleCounts[(uint64)std::min(a, b) << 32 | std::max(a, b)];
+			}
+		}
+
+		std::vector<bool> isPositionLocked(vertexCount, false);
+		for (const auto& edge : edgeTriangleCounts)
+		{
+			if (edge.second != 2)
+			{
+				isPositionLocked[edge.first >> 32] = true;
+				isPositionLocked[edge.first & UINT32_MAX] = true;
+			}
+		}
+
+		//Vertices the indices use at every position. Unused vertices never move and are never moved onto.
+		std::vector<bool> isUsed(vertexCount, false);
+		for (uint32 i = 0; i < indexCount; ++i)
+		{
+			isUsed[pIndices[i]] = true;
+		}
+
+		std::vector<uint32> positionVertexCounts(vertexCount, 0);
+		std::vector<uint32> lastVertices(vertexCount, UINT32_MAX);
+		twins.assign(vertexCount, UINT32_MAX);
+
+		for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			if (!isUsed[vertex])
+			{
+				continue;
+			}
+
+			uint32 positionId = positionIds[vertex];
+			if (lastVertices[positionId] != UINT32_MAX)
+			{
+				twins[vertex] = lastVertices[positionId];
+				twins[lastVertices[positionId]] = vertex;
+			}
+
+			lastVertices[positionId] = vertex;
+			++positionVertexCounts[positionId];
+		}
+
+		kinds.assign(vertexCount, VertexKind::Locked);
+		for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			uint32 positionId = positionIds[vertex];
+			if (!isUsed[vertex] || isPositionLocked[positionId])
+			{
+				continue;
+			}
+
+			if (positionVertexCounts[positionId] == 1)
+			{
+				kinds[vertex] = VertexKind::Free;
+			}
+			else if (positionVertexCounts[positionId] == 2)
+			{
+				kinds[vertex] = VertexKind::Seam;
+			}
+		}
+	}
+
+	bool MeshSimplifier::flipsTriangles(uint32 from, uint32 to, const std::vector<uint32>& indices, const std::vector<uint32>& triangleOffsets,
+		const std::vector<uint32>& triangles, const float* pPositions, uint32 vertexStride)
+	{
+		auto getPosition = [pPositions, vertexStride](uint32 vertex)
+		{
+			const float* pPosition = getAttribute(pPositions, vertexStride, vertex);
+			return glm::vec3(pPosition[0], pPosition[1], pPosition[2]);
+		};
+
+		glm::vec3 target = getPosition(to);
+
+		for (uint32 t = triangleOffsets[from]; t < triangleOffsets[from + 1]; ++t)
+		{
+			const uint32* pTriangle = &indices[(std::size_t)3 * triangles[t]];
+
+			//Triangles on the edge disappear.
+			if (pTriangle[0] == to || pTriangle[1] == to || pTriangle[2] == to)
+			{
+				continue;
+			}
+
+			glm::vec3 corners[3];
+			glm::vec3 movedCorners[3];
+			for (uint32 corner = 0; corner < 3; ++corner)
+			{
+				corners[corner] = getPosition(pTriangle[corner]);
+				movedCorners[corner] = pTriangle[corner] == from ? target : corners[corner];
+			}
+
+			glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+			glm::vec3 movedNormal = glm::cross(movedCorners[1] - movedCorners[0], movedCorners[2] - movedCorners[0]);
+
+			//Triangles that collapse to a line count as flipped as well.
+			if (glm::dot(normal, movedNormal) <= 0.0f)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
\ No newline at end of file
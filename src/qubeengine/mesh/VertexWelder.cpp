@@ -0,0 +1,148 @@
+#include <qubeengine/mesh/VertexWelder.h>
+
+#include <qubeengine/thread/JobSystem.h>
+#include <qubeengine/util/Hash.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace qe::mesh
+{
+	uint32 VertexWelder::buildRemap(const void* pVertices, uint32 vertexCount, uint32 vertexSize, uint32* pRemap, thread::JobSystem* pJobSystem)
+	{
+		if (vertexCount == 0)
+		{
+			return 0;
+		}
+
+		const uint8* pBytes = static_cast<const uint8*>(pVertices);
+		std::vector<uint64> hashes(vertexCount);
+
+		//The top bits of the hash pick the partition, the low bits the slot within its table.
+		uint32 partitionBits = 0;
+		if (pJobSystem && vertexCount >= PARALLEL_THRESHOLD)
+		{
+			while ((1u << partitionBits) < 2 * (pJobSystem->getThreadCount() + 1) && partitionBits < 6)
+			{
+				++partitionBits;
+			}
+		}
+
+		auto hashRange = [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				hashes[i] = hashWords(pBytes + i * vertexSize, vertexSize);
+			}
+		};
+
+		if (partitionBits == 0)
+		{
+			hashRange(0, vertexCount);
+			findFirstOccurrences(pBytes, vertexSize, hashes.data(), nullptr, vertexCount, pRemap);
+		}
+		else
+		{
+			pJobSystem->parallelFor(vertexCount, PARALLEL_THRESHOLD / 4, hashRange);
+
+			//Sort the vertices into their partitions, keeping them in order within each one.
+			uint32 partitionCount = 1u << partitionBits;
+			uint32 partitionShift = 64 - partitionBits;
+			std::vector<uint32> partitionStarts(partitionCount + 1, 0);
+
+			for (uint32 i = 0; i < vertexCount; ++i)
+			{
+				partitionStarts[(hashes[i] >> partitionShift) + 1]++;
+			}
+
+			for (uint32 partition = 0; partition < partitionCount; ++partition)
+			{
+				partitionStarts[partition + 1] += partitionStarts[partition];
+			}
+
+			std::vector<uint32> members(vertexCount);
+			std::vector<uint32> fillCounts(partitionStarts.begin(), partitionStarts.end() - 1);
+
+			for (uint32 i = 0; i < vertexCount; ++i)
+			{
+				members[fillCounts[hashes[i] >> partitionShift]++] = i;
+			}
+
+			pJobSystem->parallelFor(partitionCount, 1, [&](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t partition = begin; partition < end; ++partition)
+				{
+					uint32 first = partitionStarts[partition];
+					findFirstOccurrences(pBytes, vertexSize, hashes.data(), members.data() + first, partitionStarts[partition + 1] - first, pRemap);
+				}
+			});
+		}
+
+		//First occurrences always come before their duplicates, so the remap can be numbered in place.
+		uint32 uniqueCount = 0;
+		for (uint32 i = 0; i < vertexCount; ++i)
+		{
+			uint32 firstOccurrence = pRemap[i];
+			pRemap[i] = firstOccurrence == i ? uniqueCount++ : pRemap[firstOccurrence];
+		}
+
+		return uniqueCount;
+	}
+
+	void VertexWelder::remapVertices(const void* pVertices, uint32 vertexCount, uint32 vertexSize, const uint32* pRemap, void* pDestination)
+	{
+		const uint8* pSource = static_cast<const uint8*>(pVertices);
+		uint8* pTarget = static_cast<uint8*>(pDestination);
+		uint32 nextVertex = 0;
+
+		for (uint32 i = 0; i < vertexCount; ++i)
+		{
+			if (pRemap[i] == nextVertex)
+			{
+				std::memcpy(pTarget + (std::size_t)nextVertex * vertexSize, pSource + (std::size_t)i * vertexSize, vertexSize);
+				++nextVertex;
+			}
+		}
+	}
+
+	void VertexWelder::findFirstOccurrences(const uint8* pVertices, uint32 vertexSize, const uint64* pHashes, const uint32* pMembers,
+		uint32 memberCount, uint32* pFirstOccurrences)
+	{
+		//At most half full, so probe sequences stay short.
+		std::size_t capacity = 16;
+		while (capacity < (std::size_t)memberCount * 2)
+		{
+			capacity *= 2;
+		}
+
+		std::size_t mask = capacity - 1;
+		std::vector<Entry> table(capacity, { UINT32_MAX, 0 });
+
+		for (uint32 member = 0; member < memberCount; ++member)
+		{
+			uint32 vertex = pMembers ? pMembers[member] : member;
+			uint64 hash = pHashes[vertex];
+			uint32 tag = static_cast<uint32>(hash >> 24);
+			const uint8* pVertex = pVertices + (std::size_t)vertex * vertexSize;
+
+			for (std::size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+			{
+				Entry& entry = table[slot];
+
+				if (entry.vertex == UINT32_MAX)
+				{
+					entry.vertex = vertex;
+					entry.tag = tag;
+					pFirstOccurrences[vertex] = vertex;
+					break;
+				}
+
+				if (entry.tag == tag && std::memcmp(pVertices + (std::size_t)entry.vertex * vertexSize, pVertex, vertexSize) == 0)
+				{
+					pFirstOccurrences[vertex] = entry.vertex;
+					break;
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
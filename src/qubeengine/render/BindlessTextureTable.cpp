@@ -0,0 +1,162 @@
+#include <qubeengine/render/BindlessTextureTable.h>
+
+#include <stdexcept>
+
+namespace qe::render
+{
+	bool BindlessTextureTable::isSupported(VkPhysicalDevice physicalDevice)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		if (properties.apiVersion < VK_API_VERSION_1_2)
+		{
+			return false;
+		}
+
+		VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &indexingFeatures;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+		return indexingFeatures.shaderSampledImageArrayNonUniformIndexing &&
+			indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+			indexingFeatures.descriptorBindingUpdateUnusedWhilePending &&
+			indexingFeatures.descriptorBindingPartiallyBound &&
+			indexingFeatures.descriptorBindingVariableDescriptorCount &&
+			indexingFeatures.runtimeDescriptorArray;
+	}
+
+	void BindlessTextureTable::fillFeatures(VkPhysicalDeviceDescriptorIndexingFeatures& features)
+	{
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+		features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+		features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		features.descriptorBindingPartiallyBound = VK_TRUE;
+		features.descriptorBindingVariableDescriptorCount = VK_TRUE;
+		features.runtimeDescriptorArray = VK_TRUE;
+	}
+
+	BindlessTextureTable::BindlessTextureTable(VkDevice device, uint32 capacity, VkImageView fallbackView, VkSampler fallbackSampler) :
+		mDevice(device),
+		mCapacity(capacity)
+	{
+		VkDescriptorSetLayoutBinding textureBinding = {};
+		textureBinding.binding = 0;
+		textureBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		textureBinding.descriptorCount = mCapacity;
+		textureBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount = 1;
+		bindingFlagsInfo.pBindingFlags = &bindingFlags;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+		layoutInfo.bindingCount = 1;
+		layoutInfo.pBindings = &textureBinding;
+
+		if (vkCreateDescriptorSetLayout(mDevice, &layoutInfo, nullptr, &mLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create bindless descriptor set layout.");
+		}
+
+		VkDescriptorPoolSize poolSize = {};
+		poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSize.descriptorCount = mCapacity;
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+		poolInfo.maxSets = 1;
+
+		if (vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &mPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create bindless descriptor pool.");
+		}
+
+		VkDescriptorSetVariableDescriptorCountAllocateInfo countInfo = {};
+		countInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+		countInfo.descriptorSetCount = 1;
+		countInfo.pDescriptorCounts = &mCapacity;
+
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.pNext = &countInfo;
+		allocInfo.descriptorPool = mPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &mLayout;
+
+		if (vkAllocateDescriptorSets(mDevice, &allocInfo, &mSet) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate bindless descriptor set.");
+		}
+
+		addTexture(fallbackView, fallbackSampler);
+	}
+
+	BindlessTextureTable::~BindlessTextureTable()
+	{
+		vkDestroyDescriptorPool(mDevice, mPool, nullptr);
+		vkDestroyDescriptorSetLayout(mDevice, mLayout, nullptr);
+	}
+
+	uint32 BindlessTextureTable::addTexture(VkImageView view, VkSampler sampler)
+	{
+		if (mTextureCount == mCapacity)
+		{
+			throw std::runtime_error("Failed to add texture, the bindless texture table is full.");
+		}
+
+		uint32 index = mTextureCount++;
+		setTexture(index, view, sampler);
+
+		return index;
+	}
+
+	void BindlessTextureTable::setTexture(uint32 index, VkImageView view, VkSampler sampler)
+	{
+		VkDescriptorImageInfo imageInfo = {};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = view;
+		imageInfo.sampler = sampler;
+
+		VkWriteDescriptorSet descriptorWrite = {};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = mSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.dstArrayElement = index;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.pImageInfo = &imageInfo;
+
+		vkUpdateDescriptorSets(mDevice, 1, &descriptorWrite, 0, nullptr);
+	}
+
+	VkDescriptorSetLayout BindlessTextureTable::getLayout() const
+	{
+		return mLayout;
+	}
+
+	VkDescriptorSet BindlessTextureTable::getSet() const
+	{
+		return mSet;
+	}
+
+	uint32 BindlessTextureTable::getTextureCount() const
+	{
+		return mTextureCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include <qubeengine/render/DescriptorAllocator.h>
+#include <qubeengine/util/Hash.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace qe::render
+{
+	DescriptorBinding DescriptorBinding::buffer(uint32 binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		DescriptorBinding descriptor = {};
+		descriptor.binding = binding;
+		descriptor.type = type;
+		descriptor.bufferInfo.buffer = buffer;
+		descriptor.bufferInfo.offset = offset;
+		descriptor.bufferInfo.range = range;
+
+		return descriptor;
+	}
+
+	DescriptorBinding DescriptorBinding::image(uint32 binding, VkDescriptorType type, VkImageView view, VkSampler sampler, VkImageLayout layout)
+	{
+		DescriptorBinding descriptor = {};
+		descriptor.binding = binding;
+		descriptor.type = type;
+		descriptor.imageInfo.imageView = view;
+		descriptor.imageInfo.sampler = sampler;
+		descriptor.imageInfo.imageLayout = layout;
+
+		return descriptor;
+	}
+
+	bool DescriptorBinding::isImage() const
+	{
+		return type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER || type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ||
+			type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE || type == VK_DESCRIPTOR_TYPE_SAMPLER;
+	}
+
+	bool DescriptorBinding::operator==(const DescriptorBinding& other) const
+	{
+		return binding == other.binding && type == other.type &&
+			bufferInfo.buffer == other.bufferInfo.buffer && bufferInfo.offset == other.bufferInfo.offset && bufferInfo.range == other.bufferInfo.range &&
+			imageInfo.imageView == other.imageInfo.imageView && imageInfo.sampler == other.imageInfo.sampler && imageInfo.imageLayout == other.imageInfo.imageLayout;
+	}
+
+	DescriptorAllocator::DescriptorAllocator(VkDevice device, uint32 frameCount) :
+		mDevice(device),
+		mFramePools(frameCount)
+	{}
+
+	DescriptorAllocator::~DescriptorAllocator()
+	{
+		for (PoolList& poolList : mFramePools)
+		{
+			for (VkDescriptorPool pool : poolList.pools)
+			{
+				vkDestroyDescriptorPool(mDevice, pool, nullptr);
+			}
+		}
+
+		for (VkDescriptorPool pool : mPersistentPools.pools)
+		{
+			vkDestroyDescriptorPool(mDevice, pool, nullptr);
+		}
+	}
+
+	void DescriptorAllocator::beginFrame(uint32 frameIndex)
+	{
+		resetPoolList(mFramePools[frameIndex]);
+	}
+
+	void DescriptorAllocator::resetPersistent()
+	{
+		resetPoolList(mPersistentPools);
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocate(VkDescriptorSetLayout layout, uint32 frameIndex)
+	{
+		PoolList& poolList = getPoolList(frameIndex);
+
+		VkDescriptorSetAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &layout;
+
+		while (true)
+		{
+			if (poolList.currentPool == poolList.pools.size())
+			{
+				poolList.pools.push_back(createPool(poolList.nextPoolSets));
+				poolList.nextPoolSets = std::min(poolList.nextPoolSets * 2, MAX_POOL_SETS);
+			}
+
+			allocInfo.descriptorPool = poolList.pools[poolList.currentPool];
+
+			VkDescriptorSet set;
+			VkResult result = vkAllocateDescriptorSets(mDevice, &allocInfo, &set);
+
+			if (result == VK_SUCCESS)
+			{
+				return set;
+			}
+			else if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL)
+			{
+				++poolList.currentPool;
+			}
+			else
+			{
+				throw std::runtime_error("Failed to allocate descriptor set.");
+			}
+		}
+	}
+
+	VkDescriptorSet DescriptorAllocator::getSet(VkDescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings, uint32 frameIndex)
+	{
+		PoolList& poolList = getPoolList(frameIndex);
+		uint64 hash = hashSet(layout, bindings);
+
+		auto range = poolList.cache.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (it->second.layout == layout && it->second.bindings == bindings)
+			{
+				return it->second.set;
+			}
+		}
+
+		VkDescriptorSet set = allocate(layout, frameIndex);
+
+		std::vector<VkWriteDescriptorSet> descriptorWrites(bindings.size());
+		for (std::size_t i = 0; i < bindings.size(); ++i)
+		{
+			descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[i].dstSet = set;
+			descriptorWrites[i].dstBinding = bindings[i].binding;
+			descriptorWrites[i].dstArrayElement = 0;
+			descriptorWrites[i].descriptorType = bindings[i].type;
+			descriptorWrites[i].descriptorCount = 1;
+
+			if (bindings[i].isImage())
+			{
+				descriptorWrites[i].pImageInfo = &bindings[i].imageInfo;
+			}
+			else
+			{
+				descriptorWrites[i].pBufferInfo = &bindings[i].bufferInfo;
+			}
+		}
+
+		vkUpdateDescriptorSets(mDevice, static_cast<uint32>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		poolList.cache.insert({ hash, CachedSet{ layout, bindings, set } });
+
+		return set;
+	}
+
+	std::size_t DescriptorAllocator::getPoolCount() const
+	{
+		std::size_t count = mPersistentPools.pools.size();
+		for (const PoolList& poolList : mFramePools)
+		{
+			count += poolList.pools.size();
+		}
+
+		return count;
+	}
+
+	DescriptorAllocator::PoolList& DescriptorAllocator::getPoolList(uint32 frameIndex)
+	{
+		return frameIndex == PERSISTENT ? mPersistentPools : mFramePools[frameIndex];
+	}
+
+	VkDescriptorPool DescriptorAllocator::createPool(uint32 setCount)
+	{
+		//Rough mix of descriptors per set. A pool that runs out of one type early just means the next
+		//allocation moves on to a fresh pool.
+		std::array<VkDescriptorPoolSize, 5> poolSizes = {};
+		poolSizes[0] = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, setCount };
+		poolSizes[1] = { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, setCount * 4 };
+		poolSizes[2] = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, setCount * 2 };
+		poolSizes[3] = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, setCount };
+		poolSizes[4] = { VK_DESCRIPTOR_TYPE_SAMPLER, setCount };
+
+		VkDescriptorPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = setCount;
+
+		VkDescriptorPool pool;
+		if (vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create descriptor pool.");
+		}
+
+		return pool;
+	}
+
+	void DescriptorAllocator::resetPoolList(PoolList& poolList)
+	{
+		//Only the pools that were allocated from since the last reset can hold sets.
+		std::size_t usedPools = std::min(poolList.currentPool + 1, poolList.pools.size());
+		for (std::size_t i = 0; i < usedPools; ++i)
+		{
+			vkResetDescriptorPool(mDevice, poolList.pools[i], 0);
+		}
+
+		poolList.currentPool = 0;
+		poolList.cache.clear();
+	}
+
+	uint64 DescriptorAllocator::hashSet(VkDescriptorSetLayout layout, const std::vector<DescriptorBinding>& bindings)
+	{
+		uint64 hash = util::hashValue(layout);
+
+		for (const DescriptorBinding& binding : bindings)
+		{
+			hash = util::hashValue(binding.binding, hash);
+			hash = util::hashValue(binding.type, hash);
+			hash = util::hashValue(binding.bufferInfo.buffer, hash);
+			hash = util::hashValue(binding.bufferInfo.offset, hash);
+			hash = util::hashValue(binding.bufferInfo.range, hash);
+			hash = util::hashValue(binding.imageInfo.imageView, hash);
+			hash = util::hashValue(binding.imageInfo.sampler, hash);
+			hash = util::hashValue(binding.imageInfo.imageLayout, hash);
+		}
+
+		return hash;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include <qubeengine/render/GpuProfiler.h>
+
+#include <qubeengine/util/Profiler.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace qe::render
+{
+	GpuProfiler::GpuProfiler(VkDevice device, VkPhysicalDevice physicalDevice, uint32 queueFamily, uint32 frameCount, uint32 maxZones) :
+		mDevice(device),
+		mFrameCount(frameCount),
+		mQueriesPerFrame(2 + 2 * maxZones)
+	{
+		uint32 queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		uint32 validBits = queueFamilies[queueFamily].timestampValidBits;
+		if (validBits == 0)
+		{
+			return;
+		}
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		mTimestampPeriod = properties.limits.timestampPeriod;
+		mTimestampMask = validBits >= 64 ? UINT64_MAX : (1ull << validBits) - 1;
+
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount = mQueriesPerFrame * mFrameCount;
+
+		if (vkCreateQueryPool(mDevice, &queryPoolInfo, nullptr, &mQueryPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create timestamp query pool.");
+		}
+
+		//Profilers are recreated with the swapchain, the trace keeps using one track for the queue.
+		static const uint32 sTrack = util::Profiler::instance().addTrack("GPU Graphics Queue");
+		mTrack = sTrack;
+
+		mFrameZones.resize(mFrameCount);
+		mFrameQueryCounts.assign(mFrameCount, 0);
+		mResults.resize(mQueriesPerFrame);
+		mIsEnabled = true;
+	}
+
+	GpuProfiler::~GpuProfiler()
+	{
+		vkDestroyQueryPool(mDevice, mQueryPool, nullptr);
+	}
+
+	bool GpuProfiler::isEnabled() const
+	{
+		return mIsEnabled;
+	}
+
+	void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32 frameIndex)
+	{
+		if (!mIsEnabled)
+		{
+			return;
+		}
+
+		//Queries 0 and 1 of the range time the whole frame, the zones follow in pairs.
+		mFrameZones[frameIndex].clear();
+		mFrameQueryCounts[frameIndex] = 2;
+
+		uint32 firstQuery = getFirstQuery(frameIndex);
+		vkCmdResetQueryPool(commandBuffer, mQueryPool, firstQuery, mQueriesPerFrame);
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mQueryPool, firstQuery);
+	}
+
+	void GpuProfiler::endFrame(VkCommandBuffer commandBuffer, uint32 frameIndex)
+	{
+		if (!mIsEnabled)
+		{
+			return;
+		}
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPool, getFirstQuery(frameIndex) + 1);
+	}
+
+	uint32 GpuProfiler::beginZone(VkCommandBuffer commandBuffer, uint32 frameIndex, const std::string& name)
+	{
+		if (!mIsEnabled || mFrameQueryCounts[frameIndex] + 2 > mQueriesPerFrame)
+		{
+			return UINT32_MAX;
+		}
+
+		Zone zone;
+		zone.name = name;
+		zone.beginQuery = mFrameQueryCounts[frameIndex];
+		zone.endQuery = zone.beginQuery + 1;
+		mFrameQueryCounts[frameIndex] += 2;
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, mQueryPool, getFirstQuery(frameIndex) + zone.beginQuery);
+		mFrameZones[frameIndex].push_back(zone);
+
+		return static_cast<uint32>(mFrameZones[frameIndex].size() - 1);
+	}
+
+	void GpuProfiler::endZone(VkCommandBuffer commandBuffer, uint32 frameIndex, uint32 zone)
+	{
+		if (!mIsEnabled || zone == UINT32_MAX)
+		{
+			return;
+		}
+
+		//Bottom of pipe waits until every earlier command has finished all of its stages.
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, mQueryPool,
+			getFirstQuery(frameIndex) + mFrameZones[frameIndex][zone].endQuery);
+	}
+
+	void GpuProfiler::submitted(uint32 frameIndex, uint64 timelineValue, double cpuTime)
+	{
+		if (!mIsEnabled)
+		{
+			return;
+		}
+
+		mPendingFrames.push_back({ frameIndex, timelineValue, cpuTime });
+	}
+
+	void GpuProfiler::collect(uint64 completedTimelineValue)
+	{
+		//Submissions complete in order, so the first frame that is not done ends the search.
+		while (!mPendingFrames.empty() && mPendingFrames.front().timelineValue <= completedTimelineValue)
+		{
+			readFrame(mPendingFrames.front());
+			mPendingFrames.pop_front();
+		}
+	}
+
+	double GpuProfiler::getLastFrameTime() const
+	{
+		return mLastFrameTime;
+	}
+
+	uint32 GpuProfiler::getFirstQuery(uint32 frameIndex) const
+	{
+		return frameIndex * mQueriesPerFrame;
+	}
+
+	void GpuProfiler::readFrame(const PendingFrame& frame)
+	{
+		uint32 queryCount = mFrameQueryCounts[frame.frameIndex];
+
+		//No wait flag, a frame whose results are not there yet is dropped rather than stalling the CPU.
+		VkResult result = vkGetQueryPoolResults(mDevice, mQueryPool, getFirstQuery(frame.frameIndex), queryCount,
+			queryCount * sizeof(uint64), mResults.data(), sizeof(uint64), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+		{
+			return;
+		}
+
+		uint64 frameBegin = mResults[0] & mTimestampMask;
+		auto toMicroseconds = [&](uint32 query)
+		{
+			return static_cast<double>(((mResults[query] & mTimestampMask) - frameBegin) & mTimestampMask) * mTimestampPeriod / 1000.0;
+		};
+
+		//The GPU clock has its own origin. A frame starts no earlier than its submission and not before
+		//the previous frame ended, which is close enough to line the GPU track up with the CPU one.
+		double frameStart = std::max(frame.cpuTime, mLastFrameEnd);
+		double frameDuration = toMicroseconds(1);
+		mLastFrameEnd = frameStart + frameDuration;
+		mLastFrameTime = frameDuration;
+
+		util::Profiler& profiler = util::Profiler::instance();
+		if (!profiler.isCapturing())
+		{
+			return;
+		}
+
+		profiler.addZone("GpuFrame", mTrack, frameStart, frameDuration);
+		for (const Zone& zone : mFrameZones[frame.frameIndex])
+		{
+			double zoneStart = toMicroseconds(zone.beginQuery);
+			profiler.addZone(zone.name, mTrack, frameStart + zoneStart, toMicroseconds(zone.endQuery) - zoneStart);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include <qubeengine/render/PipelineCache.h>
+
+#include <qubeengine/io/FileSystem.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace qe::render
+{
+	PipelineCache::PipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const io::FileSystem& fileSystem, const std::string& path) :
+		mDevice(device),
+		mPath(path)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		//Drivers have to reject data they did not write themselves, but not all of them check it carefully.
+		io::FileView file;
+		bool isValid = fileSystem.open(path, file) && file.getSize() >= sizeof(Header);
+
+		if (isValid)
+		{
+			Header header;
+			std::memcpy(&header, file.getData(), sizeof(Header));
+
+			isValid = header.headerSize >= sizeof(Header) && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+				header.vendorId == properties.vendorID && header.deviceId == properties.deviceID &&
+				std::memcmp(header.cacheUuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+		}
+
+		VkPipelineCacheCreateInfo createInfo = {};
+		createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		createInfo.initialDataSize = isValid ? file.getSize() : 0;
+		createInfo.pInitialData = isValid ? file.getData() : nullptr;
+
+		if (vkCreatePipelineCache(mDevice, &createInfo, nullptr, &mCache) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline cache.");
+		}
+		else
+		{
+			std::cout << "Successfully created pipeline cache" << (isValid ? " from " + path : "") << "!" << std::endl;
+		}
+	}
+
+	PipelineCache::~PipelineCache()
+	{
+		vkDestroyPipelineCache(mDevice, mCache, nullptr);
+	}
+
+	VkPipelineCache PipelineCache::get() const
+	{
+		return mCache;
+	}
+
+	bool PipelineCache::save() const
+	{
+		std::size_t size = 0;
+		if (vkGetPipelineCacheData(mDevice, mCache, &size, nullptr) != VK_SUCCESS || size == 0)
+		{
+			return false;
+		}
+
+		std::vector<char> data(size);
+		if (vkGetPipelineCacheData(mDevice, mCache, &size, data.data()) != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(std::filesystem::path(mPath).parent_path(), error);
+
+		//Written next to the destination first, so a cache that is cut short never replaces a good one.
+		std::string tempPath = mPath + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file.is_open())
+			{
+				return false;
+			}
+
+			file.write(data.data(), static_cast<std::streamsize>(size));
+
+			if (!file.good())
+			{
+				file.close();
+				std::remove(tempPath.c_str());
+				return false;
+			}
+		}
+
+		std::remove(mPath.c_str());
+
+		return std::rename(tempPath.c_str(), mPath.c_str()) == 0;
+	}
+}
\ No newline at end of file
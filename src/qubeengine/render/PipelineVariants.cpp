@@ -0,0 +1,111 @@
+#include <qubeengine/render/PipelineVariants.h>
+
+#include <qubeengine/thread/JobSystem.h>
+#include <qubeengine/util/Hash.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace qe::render
+{
+	bool PipelineKey::operator==(const PipelineKey& other) const
+	{
+		return std::memcmp(this, &other, sizeof(PipelineKey)) == 0;
+	}
+
+	VkSpecializationInfo PipelineKey::getSpecializationInfo(VkSpecializationMapEntry (&entries)[MAX_CONSTANTS]) const
+	{
+		for (uint32 i = 0; i < MAX_CONSTANTS; ++i)
+		{
+			entries[i].constantID = i;
+			entries[i].offset = i * sizeof(uint32);
+			entries[i].size = sizeof(uint32);
+		}
+
+		VkSpecializationInfo info = {};
+		info.mapEntryCount = MAX_CONSTANTS;
+		info.pMapEntries = entries;
+		info.dataSize = sizeof(constants);
+		info.pData = constants;
+
+		return info;
+	}
+
+	std::size_t PipelineKeyHash::operator()(const PipelineKey& key) const
+	{
+		return static_cast<std::size_t>(util::hashBytes(&key, sizeof(PipelineKey)));
+	}
+
+	PipelineVariants::PipelineVariants(VkDevice device) :
+		mDevice(device)
+	{
+	}
+
+	PipelineVariants::~PipelineVariants()
+	{
+		for (const auto& [key, pipeline] : mPipelines)
+		{
+			vkDestroyPipeline(mDevice, pipeline, nullptr);
+		}
+	}
+
+	void PipelineVariants::build(const std::vector<PipelineKey>& keys, VkPipelineCache cache, thread::JobSystem& jobSystem, const BuildFunction& function)
+	{
+		std::vector<PipelineKey> missingKeys;
+		for (const PipelineKey& key : keys)
+		{
+			if (mPipelines.count(key) == 0 && std::find(missingKeys.begin(), missingKeys.end(), key) == missingKeys.end())
+			{
+				missingKeys.push_back(key);
+			}
+		}
+
+		//Drivers spend most of the time in here compiling, so every variant gets its own job.
+		std::vector<VkPipeline> pipelines(missingKeys.size(), VK_NULL_HANDLE);
+		std::vector<std::exception_ptr> errors(missingKeys.size());
+
+		jobSystem.parallelFor(missingKeys.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				try
+				{
+					pipelines[i] = function(missingKeys[i], cache);
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			}
+		});
+
+		for (std::size_t i = 0; i < missingKeys.size(); ++i)
+		{
+			if (pipelines[i] != VK_NULL_HANDLE)
+			{
+				mPipelines.emplace(missingKeys[i], pipelines[i]);
+			}
+		}
+
+		for (const std::exception_ptr& pError : errors)
+		{
+			if (pError)
+			{
+				std::rethrow_exception(pError);
+			}
+		}
+	}
+
+	VkPipeline PipelineVariants::find(const PipelineKey& key) const
+	{
+		auto it = mPipelines.find(key);
+
+		return it != mPipelines.end() ? it->second : VK_NULL_HANDLE;
+	}
+
+	std::size_t PipelineVariants::getCount() const
+	{
+		return mPipelines.size();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include <qubeengine/render/QueueTimeline.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace qe::render
+{
+	bool QueueTimeline::isSupported(VkPhysicalDevice physicalDevice)
+	{
+		if (requiresExtension(physicalDevice))
+		{
+			uint32 extensionCount = 0;
+			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+
+			std::vector<VkExtensionProperties> extensions(extensionCount);
+			vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensions.data());
+
+			bool hasExtension = false;
+			for (const VkExtensionProperties& extension : extensions)
+			{
+				hasExtension |= std::strcmp(extension.extensionName, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0;
+			}
+
+			if (!hasExtension)
+			{
+				return false;
+			}
+		}
+
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &timelineFeatures;
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+		return timelineFeatures.timelineSemaphore;
+	}
+
+	bool QueueTimeline::requiresExtension(VkPhysicalDevice physicalDevice)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		return properties.apiVersion < VK_API_VERSION_1_2;
+	}
+
+	void QueueTimeline::fillFeatures(VkPhysicalDeviceTimelineSemaphoreFeatures& features)
+	{
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+		features.timelineSemaphore = VK_TRUE;
+	}
+
+	QueueTimeline::QueueTimeline(VkDevice device, VkQueue queue) :
+		mDevice(device),
+		mQueue(queue)
+	{
+		mpWaitSemaphores = (PFN_vkWaitSemaphores)vkGetDeviceProcAddr(mDevice, "vkWaitSemaphores");
+		mpGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValue)vkGetDeviceProcAddr(mDevice, "vkGetSemaphoreCounterValue");
+
+		if (!mpWaitSemaphores || !mpGetSemaphoreCounterValue)
+		{
+			mpWaitSemaphores = (PFN_vkWaitSemaphores)vkGetDeviceProcAddr(mDevice, "vkWaitSemaphoresKHR");
+			mpGetSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValue)vkGetDeviceProcAddr(mDevice, "vkGetSemaphoreCounterValueKHR");
+		}
+
+		if (!mpWaitSemaphores || !mpGetSemaphoreCounterValue)
+		{
+			throw std::runtime_error("Failed to load timeline semaphore functions.");
+		}
+
+		VkSemaphoreTypeCreateInfo typeInfo = {};
+		typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext = &typeInfo;
+
+		if (vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, &mSemaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create timeline semaphore.");
+		}
+	}
+
+	QueueTimeline::~QueueTimeline()
+	{
+		waitIdle();
+		vkDestroySemaphore(mDevice, mSemaphore, nullptr);
+	}
+
+	uint64 QueueTimeline::submit(const std::vector<VkCommandBuffer>& commandBuffers, const std::vector<Wait>& waits,
+		const std::vector<VkSemaphore>& binarySignals)
+	{
+		uint64 signalValue = mSubmittedValue + 1;
+
+		std::vector<VkSemaphore> waitSemaphores;
+		std::vector<uint64> waitValues;
+		std::vector<VkPipelineStageFlags> waitStages;
+		for (const Wait& wait : waits)
+		{
+			waitSemaphores.push_back(wait.semaphore);
+			waitValues.push_back(wait.value);
+			waitStages.push_back(wait.stages);
+		}
+
+		//The timeline comes first, binary semaphores ignore their value.
+		std::vector<VkSemaphore> signalSemaphores = { mSemaphore };
+		std::vector<uint64> signalValues = { signalValue };
+		for (VkSemaphore semaphore : binarySignals)
+		{
+			signalSemaphores.push_back(semaphore);
+			signalValues.push_back(0);
+		}
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = static_cast<uint32>(waitValues.size());
+		timelineInfo.pWaitSemaphoreValues = waitValues.data();
+		timelineInfo.signalSemaphoreValueCount = static_cast<uint32>(signalValues.size());
+		timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = static_cast<uint32>(waitSemaphores.size());
+		submitInfo.pWaitSemaphores = waitSemaphores.data();
+		submitInfo.pWaitDstStageMask = waitStages.data();
+		submitInfo.commandBufferCount = static_cast<uint32>(commandBuffers.size());
+		submitInfo.pCommandBuffers = commandBuffers.data();
+		submitInfo.signalSemaphoreCount = static_cast<uint32>(signalSemaphores.size());
+		submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+		if (vkQueueSubmit(mQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to submit to queue timeline.");
+		}
+
+		mSubmittedValue = signalValue;
+
+		return signalValue;
+	}
+
+	void QueueTimeline::wait(uint64 value) const
+	{
+		if (value == 0 || value > mSubmittedValue)
+		{
+			return;
+		}
+
+		VkSemaphoreWaitInfo waitInfo = {};
+		waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+		waitInfo.semaphoreCount = 1;
+		waitInfo.pSemaphores = &mSemaphore;
+		waitInfo.pValues = &value;
+
+		if (mpWaitSemaphores(mDevice, &waitInfo, UINT64_MAX) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to wait on queue timeline.");
+		}
+	}
+
+	void QueueTimeline::waitIdle() const
+	{
+		wait(mSubmittedValue);
+	}
+
+	uint64 QueueTimeline::getCompletedValue() const
+	{
+		uint64 value = 0;
+		mpGetSemaphoreCounterValue(mDevice, mSemaphore, &value);
+
+		return value;
+	}
+
+	uint64 QueueTimeline::getSubmittedValue() const
+	{
+		return mSubmittedValue;
+	}
+
+	VkQueue QueueTimeline::getQueue() const
+	{
+		return mQueue;
+	}
+
+	VkSemaphore QueueTimeline::getSemaphore() const
+	{
+		return mSemaphore;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,780 @@
+#include <qubeengine/render/RenderGraph.h>
+#include <qubeengine/render/GpuProfiler.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace qe::render
+{
+	RenderGraph::RenderGraph(VkDevice device, VkPhysicalDevice physicalDevice) :
+		mDevice(device),
+		mPhysicalDevice(physicalDevice)
+	{}
+
+	RenderGraph::~RenderGraph()
+	{
+		for (Pass& pass : mPasses)
+		{
+			for (VkFramebuffer framebuffer : pass.framebuffers)
+			{
+				vkDestroyFramebuffer(mDevice, framebuffer, nullptr);
+			}
+
+			if (pass.renderPass != VK_NULL_HANDLE)
+			{
+				vkDestroyRenderPass(mDevice, pass.renderPass, nullptr);
+			}
+		}
+
+		for (Resource& resource : mResources)
+		{
+			if (resource.isImported)
+			{
+				continue;
+			}
+
+			for (VkImageView view : resource.views)
+			{
+				vkDestroyImageView(mDevice, view, nullptr);
+			}
+
+			for (VkImage image : resource.images)
+			{
+				vkDestroyImage(mDevice, image, nullptr);
+			}
+		}
+
+		for (VkDeviceMemory memory : mTransientMemory)
+		{
+			vkFreeMemory(mDevice, memory, nullptr);
+		}
+	}
+
+	ResourceHandle RenderGraph::importImage(const std::string& name, const std::vector<VkImage>& images, const std::vector<VkImageView>& views,
+		VkFormat format, VkExtent2D extent, VkImageLayout finalLayout, VkPipelineStageFlags firstUseStages)
+	{
+		Resource resource = {};
+		resource.name = name;
+		resource.isImage = true;
+		resource.isImported = true;
+		resource.format = format;
+		resource.extent = extent;
+		resource.finalLayout = finalLayout;
+		resource.firstUseStages = firstUseStages;
+		resource.images = images;
+		resource.views = views;
+		mResources.push_back(resource);
+
+		return static_cast<ResourceHandle>(mResources.size() - 1);
+	}
+
+	ResourceHandle RenderGraph::importBuffer(const std::string& name, const std::vector<VkBuffer>& buffers)
+	{
+		Resource resource = {};
+		resource.name = name;
+		resource.isImage = false;
+		resource.isImported = true;
+		resource.buffers = buffers;
+		mResources.push_back(resource);
+
+		return static_cast<ResourceHandle>(mResources.size() - 1);
+	}
+
+	ResourceHandle RenderGraph::createImage(const std::string& name, VkFormat format, VkExtent2D extent)
+	{
+		Resource resource = {};
+		resource.name = name;
+		resource.isImage = true;
+		resource.isImported = false;
+		resource.format = format;
+		resource.extent = extent;
+		mResources.push_back(resource);
+
+		return static_cast<ResourceHandle>(mResources.size() - 1);
+	}
+
+	uint32 RenderGraph::addPass(const std::string& name, PassType type, RecordFunction record)
+	{
+		Pass pass = {};
+		pass.name = name;
+		pass.type = type;
+		pass.record = std::move(record);
+		mPasses.push_back(std::move(pass));
+
+		return static_cast<uint32>(mPasses.size() - 1);
+	}
+
+	void RenderGraph::read(uint32 passIndex, ResourceHandle resource, Access access)
+	{
+		AccessInfo info = getAccessInfo(access);
+		ResourceUse& use = findOrAddUse(passIndex, resource);
+
+		//Buffers have no layout, the one their accesses map to only matters for images.
+		if (mResources[resource].isImage && use.info.layout != VK_IMAGE_LAYOUT_UNDEFINED && use.info.layout != info.layout)
+		{
+			throw std::runtime_error("Render graph pass " + mPasses[passIndex].name + " uses " + mResources[resource].name + " in two layouts.");
+		}
+
+		use.info.stages |= info.stages;
+		use.info.access |= info.access;
+		use.info.layout = info.layout;
+		use.info.imageUsage |= info.imageUsage;
+		use.isAttachment |= (access == Access::DepthAttachmentRead);
+		use.isRead = true;
+		mResources[resource].usage |= info.imageUsage;
+	}
+
+	void RenderGraph::write(uint32 passIndex, ResourceHandle resource, Access access, const VkClearValue* pClearValue)
+	{
+		AccessInfo info = getAccessInfo(access);
+		ResourceUse& use = findOrAddUse(passIndex, resource);
+
+		if (mResources[resource].isImage && use.info.layout != VK_IMAGE_LAYOUT_UNDEFINED && use.info.layout != info.layout)
+		{
+			throw std::runtime_error("Render graph pass " + mPasses[passIndex].name + " uses " + mResources[resource].name + " in two layouts.");
+		}
+
+		bool isAttachment = (access == Access::ColorAttachmentWrite || access == Access::DepthAttachmentWrite);
+
+		use.info.stages |= info.stages;
+		use.info.access |= info.access;
+		use.info.layout = info.layout;
+		use.info.imageUsage |= info.imageUsage;
+		use.info.isWrite = true;
+		use.isAttachment |= isAttachment;
+		mResources[resource].usage |= info.imageUsage;
+
+		if (pClearValue)
+		{
+			use.hasClearValue = true;
+			use.clearValue = *pClearValue;
+		}
+		else if (isAttachment)
+		{
+			//Without a clear the attachment is loaded, so whatever was rendered into it before is needed.
+			use.isRead = true;
+		}
+	}
+
+	void RenderGraph::markOutput(ResourceHandle resource)
+	{
+		mResources[resource].isOutput = true;
+	}
+
+	void RenderGraph::compile(uint32 frameCount)
+	{
+		cullPasses();
+		computeLifetimes();
+		allocateTransientImages();
+		computeBarriers();
+		createRenderPasses(frameCount);
+
+		std::cout << "Successfully compiled render graph with " << mPassOrder.size() << " of " << mPasses.size()
+			<< " passes and " << mTransientMemory.size() << " transient memory blocks!" << std::endl;
+	}
+
+	void RenderGraph::execute(VkCommandBuffer commandBuffer, std::size_t imageIndex) const
+	{
+		for (uint32 passIndex : mPassOrder)
+		{
+			const Pass& pass = mPasses[passIndex];
+			uint32 zone = mpProfiler ? mpProfiler->beginZone(commandBuffer, static_cast<uint32>(imageIndex), pass.name) : UINT32_MAX;
+			recordBarriers(commandBuffer, pass.barriers, imageIndex);
+
+			if (pass.type == PassType::Graphics)
+			{
+				VkRenderPassBeginInfo renderPassInfo = {};
+				renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+				renderPassInfo.renderPass = pass.renderPass;
+				renderPassInfo.framebuffer = pass.framebuffers[imageIndex];
+				renderPassInfo.renderArea.offset = { 0, 0 };
+				renderPassInfo.renderArea.extent = pass.extent;
+				renderPassInfo.clearValueCount = static_cast<uint32>(pass.clearValues.size());
+				renderPassInfo.pClearValues = pass.clearValues.data();
+
+				vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+				pass.record(commandBuffer, imageIndex);
+				vkCmdEndRenderPass(commandBuffer);
+			}
+			else
+			{
+				pass.record(commandBuffer, imageIndex);
+			}
+
+			if (mpProfiler)
+			{
+				mpProfiler->endZone(commandBuffer, static_cast<uint32>(imageIndex), zone);
+			}
+		}
+
+		recordBarriers(commandBuffer, mFinalBarriers, imageIndex);
+	}
+
+	void RenderGraph::setProfiler(GpuProfiler* pProfiler)
+	{
+		mpProfiler = pProfiler;
+	}
+
+	VkRenderPass RenderGraph::getRenderPass(uint32 passIndex) const
+	{
+		if (mPasses[passIndex].renderPass == VK_NULL_HANDLE)
+		{
+			throw std::runtime_error("Render graph pass " + mPasses[passIndex].name + " has no render pass.");
+		}
+
+		return mPasses[passIndex].renderPass;
+	}
+
+	bool RenderGraph::isPassCulled(uint32 passIndex) const
+	{
+		return mPasses[passIndex].isCulled;
+	}
+
+	RenderGraph::AccessInfo RenderGraph::getAccessInfo(Access access)
+	{
+		switch (access)
+		{
+		case Access::ColorAttachmentWrite:
+			return { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true };
+		case Access::DepthAttachmentWrite:
+			return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+				VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true };
+		case Access::DepthAttachmentRead:
+			//Same layout as writing, so a pass can test against depth laid down by an earlier one without a transition.
+			return { VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+				VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false };
+		case Access::VertexShaderRead:
+			return { VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false };
+		case Access::FragmentShaderRead:
+			return { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, false };
+		case Access::ComputeShaderRead:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT,
+				VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, false };
+		case Access::ComputeShaderWrite:
+			return { VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, true };
+		case Access::IndirectRead:
+			return { VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT,
+				VK_IMAGE_LAYOUT_UNDEFINED, 0, false };
+		case Access::TransferRead:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false };
+		case Access::TransferWrite:
+			return { VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true };
+		}
+
+		throw std::invalid_argument("Unknown render graph access.");
+	}
+
+	bool RenderGraph::isDepthFormat(VkFormat format)
+	{
+		return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_X8_D24_UNORM_PACK32 || format == VK_FORMAT_D32_SFLOAT ||
+			format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+	}
+
+	RenderGraph::ResourceUse& RenderGraph::findOrAddUse(uint32 passIndex, ResourceHandle resource)
+	{
+		std::vector<ResourceUse>& uses = mPasses[passIndex].uses;
+
+		for (ResourceUse& use : uses)
+		{
+			if (use.resource == resource)
+			{
+				return use;
+			}
+		}
+
+		ResourceUse use = {};
+		use.resource = resource;
+		use.info.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		uses.push_back(use);
+
+		return uses.back();
+	}
+
+	void RenderGraph::cullPasses()
+	{
+		//Walk backwards from the outputs. A pass is kept when it writes something a kept pass (or the frame)
+		//still needs. A write that does not read the old contents ends the need for them, so earlier writers
+		//of the same resource are only kept if something in between reads what they wrote.
+		std::vector<bool> isNeeded(mResources.size(), false);
+		for (std::size_t i = 0; i < mResources.size(); ++i)
+		{
+			isNeeded[i] = mResources[i].isOutput;
+		}
+
+		for (std::size_t i = mPasses.size(); i-- > 0;)
+		{
+			Pass& pass = mPasses[i];
+
+			pass.isCulled = std::none_of(pass.uses.begin(), pass.uses.end(),
+				[&isNeeded](const ResourceUse& use) { return use.info.isWrite && isNeeded[use.resource]; });
+
+			if (pass.isCulled)
+			{
+				std::cout << "Culled render graph pass: " << pass.name << std::endl;
+				continue;
+			}
+
+			for (const ResourceUse& use : pass.uses)
+			{
+				if (use.info.isWrite && !use.isRead)
+				{
+					isNeeded[use.resource] = false;
+				}
+			}
+
+			for (const ResourceUse& use : pass.uses)
+			{
+				if (use.isRead)
+				{
+					isNeeded[use.resource] = true;
+				}
+			}
+		}
+
+		mPassOrder.clear();
+		for (uint32 i = 0; i < mPasses.size(); ++i)
+		{
+			if (!mPasses[i].isCulled)
+			{
+				mPassOrder.push_back(i);
+			}
+		}
+	}
+
+	void RenderGraph::computeLifetimes()
+	{
+		for (uint32 order = 0; order < mPassOrder.size(); ++order)
+		{
+			for (const ResourceUse& use : mPasses[mPassOrder[order]].uses)
+			{
+				Resource& resource = mResources[use.resource];
+				resource.firstPass = std::min(resource.firstPass, order);
+				resource.lastPass = std::max(resource.lastPass, order);
+			}
+		}
+	}
+
+	void RenderGraph::allocateTransientImages()
+	{
+		struct MemoryBlock
+		{
+			VkDeviceSize size;
+			uint32 memoryType;
+			std::vector<ResourceHandle> resources;
+		};
+
+		std::vector<ResourceHandle> transientImages;
+		std::vector<VkMemoryRequirements> requirements(mResources.size());
+
+		for (ResourceHandle handle = 0; handle < mResources.size(); ++handle)
+		{
+			Resource& resource = mResources[handle];
+
+			//Images only touched by culled passes are never created.
+			if (resource.isImported || resource.firstPass == UINT32_MAX)
+			{
+				continue;
+			}
+
+			VkImageCreateInfo imageInfo = {};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.extent.width = resource.extent.width;
+			imageInfo.extent.height = resource.extent.height;
+			imageInfo.extent.depth = 1;
+			imageInfo.mipLevels = 1;
+			imageInfo.arrayLayers = 1;
+			imageInfo.format = resource.format;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			imageInfo.usage = resource.usage;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+			VkImage image;
+			if (vkCreateImage(mDevice, &imageInfo, nullptr, &image) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create render graph image: " + resource.name);
+			}
+
+			resource.images.push_back(image);
+			vkGetImageMemoryRequirements(mDevice, image, &requirements[handle]);
+			transientImages.push_back(handle);
+		}
+
+		//Biggest first, so every block is sized by its first image and later ones fit at offset 0.
+		std::sort(transientImages.begin(), transientImages.end(),
+			[&requirements](ResourceHandle a, ResourceHandle b) { return requirements[a].size > requirements[b].size; });
+
+		std::vector<MemoryBlock> blocks;
+
+		for (ResourceHandle handle : transientImages)
+		{
+			const Resource& resource = mResources[handle];
+			uint32 memoryType = findMemoryType(requirements[handle].memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			auto fits = [&](const MemoryBlock& block)
+			{
+				if (block.memoryType != memoryType || block.size < requirements[handle].size)
+				{
+					return false;
+				}
+
+				return std::none_of(block.resources.begin(), block.resources.end(), [&](ResourceHandle other)
+				{
+					return mResources[other].firstPass <= resource.lastPass && resource.firstPass <= mResources[other].lastPass;
+				});
+			};
+
+			auto blockIt = std::find_if(blocks.begin(), blocks.end(), fits);
+			if (blockIt == blocks.end())
+			{
+				blocks.push_back({ requirements[handle].size, memoryType, {} });
+				blockIt = blocks.end() - 1;
+			}
+
+			blockIt->resources.push_back(handle);
+		}
+
+		for (const MemoryBlock& block : blocks)
+		{
+			VkMemoryAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocInfo.allocationSize = block.size;
+			allocInfo.memoryTypeIndex = block.memoryType;
+
+			VkDeviceMemory memory;
+			if (vkAllocateMemory(mDevice, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to allocate render graph memory.");
+			}
+
+			mTransientMemory.push_back(memory);
+
+			//Every image that shares the block has to wait for all of them from the previous frame, since any
+			//of them may have been the last to touch the memory.
+			VkPipelineStageFlags blockStages = 0;
+			VkAccessFlags blockWriteAccess = 0;
+
+			for (ResourceHandle handle : block.resources)
+			{
+				for (uint32 passIndex : mPassOrder)
+				{
+					for (const ResourceUse& use : mPasses[passIndex].uses)
+					{
+						if (use.resource == handle)
+						{
+							blockStages |= use.info.stages;
+							blockWriteAccess |= use.info.isWrite ? use.info.access : 0;
+						}
+					}
+				}
+			}
+
+			for (ResourceHandle handle : block.resources)
+			{
+				Resource& resource = mResources[handle];
+				vkBindImageMemory(mDevice, resource.images[0], memory, 0);
+
+				resource.firstUseStages = blockStages;
+				resource.firstUseAccess = blockWriteAccess;
+
+				VkImageViewCreateInfo viewInfo = {};
+				viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				viewInfo.image = resource.images[0];
+				viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				viewInfo.format = resource.format;
+				viewInfo.subresourceRange.aspectMask = getAspectMask(resource.format);
+				viewInfo.subresourceRange.baseMipLevel = 0;
+				viewInfo.subresourceRange.levelCount = 1;
+				viewInfo.subresourceRange.baseArrayLayer = 0;
+				viewInfo.subresourceRange.layerCount = 1;
+
+				VkImageView view;
+				if (vkCreateImageView(mDevice, &viewInfo, nullptr, &view) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to create render graph image view: " + resource.name);
+				}
+
+				resource.views.push_back(view);
+			}
+		}
+	}
+
+	void RenderGraph::computeBarriers()
+	{
+		//Every resource starts the frame with its contents discarded. Imported images wait on whatever the
+		//caller hands them over with, transient images on the previous frame's use of their memory.
+		std::vector<ResourceState> states(mResources.size());
+		for (std::size_t i = 0; i < mResources.size(); ++i)
+		{
+			states[i].stages = mResources[i].firstUseStages;
+			states[i].access = mResources[i].firstUseAccess;
+			states[i].isWrite = mResources[i].firstUseAccess != 0;
+		}
+
+		for (uint32 passIndex : mPassOrder)
+		{
+			Pass& pass = mPasses[passIndex];
+
+			for (const ResourceUse& use : pass.uses)
+			{
+				ResourceState& state = states[use.resource];
+				bool isLayoutChange = mResources[use.resource].isImage && state.layout != use.info.layout;
+
+				//First touch of a buffer nobody has used yet this frame.
+				if (!isLayoutChange && state.stages == 0)
+				{
+					state.stages = use.info.stages;
+					state.access = use.info.access;
+					state.isWrite = use.info.isWrite;
+					continue;
+				}
+
+				//Reads after reads need nothing, but a later write has to wait for all of them.
+				if (!isLayoutChange && !state.isWrite && !use.info.isWrite)
+				{
+					state.stages |= use.info.stages;
+					state.access |= use.info.access;
+					continue;
+				}
+
+				pass.barriers.srcStages |= state.stages;
+				pass.barriers.dstStages |= use.info.stages;
+
+				//Write after read only needs the execution dependency from the stage masks.
+				if (state.isWrite || isLayoutChange)
+				{
+					pass.barriers.barriers.push_back({ use.resource, state.isWrite ? state.access : 0,
+						use.info.access, state.layout, use.info.layout });
+				}
+
+				state.stages = use.info.stages;
+				state.access = use.info.access;
+				state.layout = use.info.layout;
+				state.isWrite = use.info.isWrite;
+			}
+		}
+
+		for (ResourceHandle handle = 0; handle < mResources.size(); ++handle)
+		{
+			const Resource& resource = mResources[handle];
+			const ResourceState& state = states[handle];
+
+			if (resource.isImported && resource.isImage && resource.finalLayout != VK_IMAGE_LAYOUT_UNDEFINED &&
+				state.layout != resource.finalLayout)
+			{
+				mFinalBarriers.srcStages |= state.stages;
+				mFinalBarriers.dstStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+				mFinalBarriers.barriers.push_back({ handle, state.isWrite ? state.access : 0, 0, state.layout, resource.finalLayout });
+			}
+		}
+	}
+
+	void RenderGraph::createRenderPasses(uint32 frameCount)
+	{
+		for (uint32 order = 0; order < mPassOrder.size(); ++order)
+		{
+			Pass& pass = mPasses[mPassOrder[order]];
+
+			if (pass.type != PassType::Graphics)
+			{
+				continue;
+			}
+
+			std::vector<VkAttachmentDescription> attachments;
+			std::vector<VkAttachmentReference> colorAttachmentRefs;
+			VkAttachmentReference depthAttachmentRef = {};
+			bool hasDepthAttachment = false;
+			std::vector<ResourceHandle> attachmentResources;
+
+			for (const ResourceUse& use : pass.uses)
+			{
+				if (!use.isAttachment)
+				{
+					continue;
+				}
+
+				const Resource& resource = mResources[use.resource];
+
+				//Nothing before this pass wrote the attachment, so there is nothing to load. Nothing after
+				//reads it, so unless someone outside the frame does it does not have to be stored either.
+				VkAttachmentDescription attachment = {};
+				attachment.format = resource.format;
+				attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+				attachment.loadOp = use.hasClearValue ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+					(resource.firstPass == order ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD);
+				attachment.storeOp = (resource.isImported || resource.lastPass > order) ?
+					VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+				//The graph moves attachments into their layout with its own barriers before the pass.
+				attachment.initialLayout = use.info.layout;
+				attachment.finalLayout = use.info.layout;
+
+				VkAttachmentReference reference = {};
+				reference.attachment = static_cast<uint32>(attachments.size());
+				reference.layout = use.info.layout;
+
+				if (isDepthFormat(resource.format))
+				{
+					depthAttachmentRef = reference;
+					hasDepthAttachment = true;
+				}
+				else
+				{
+					colorAttachmentRefs.push_back(reference);
+				}
+
+				attachments.push_back(attachment);
+				attachmentResources.push_back(use.resource);
+				pass.clearValues.push_back(use.clearValue);
+				pass.extent = resource.extent;
+			}
+
+			VkSubpassDescription subpass = {};
+			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpass.colorAttachmentCount = static_cast<uint32>(colorAttachmentRefs.size());
+			subpass.pColorAttachments = colorAttachmentRefs.data();
+			subpass.pDepthStencilAttachment = hasDepthAttachment ? &depthAttachmentRef : nullptr;
+
+			VkRenderPassCreateInfo renderPassInfo = {};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			renderPassInfo.attachmentCount = static_cast<uint32>(attachments.size());
+			renderPassInfo.pAttachments = attachments.data();
+			renderPassInfo.subpassCount = 1;
+			renderPassInfo.pSubpasses = &subpass;
+
+			if (vkCreateRenderPass(mDevice, &renderPassInfo, nullptr, &pass.renderPass) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create render pass for render graph pass: " + pass.name);
+			}
+
+			pass.framebuffers.resize(frameCount);
+
+			for (uint32 frame = 0; frame < frameCount; ++frame)
+			{
+				std::vector<VkImageView> views;
+				for (ResourceHandle handle : attachmentResources)
+				{
+					views.push_back(getView(mResources[handle], frame));
+				}
+
+				VkFramebufferCreateInfo framebufferInfo = {};
+				framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+				framebufferInfo.renderPass = pass.renderPass;
+				framebufferInfo.attachmentCount = static_cast<uint32>(views.size());
+				framebufferInfo.pAttachments = views.data();
+				framebufferInfo.width = pass.extent.width;
+				framebufferInfo.height = pass.extent.height;
+				framebufferInfo.layers = 1;
+
+				if (vkCreateFramebuffer(mDevice, &framebufferInfo, nullptr, &pass.framebuffers[frame]) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to create framebuffer for render graph pass: " + pass.name);
+				}
+			}
+		}
+	}
+
+	void RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const BarrierBatch& batch, std::size_t imageIndex) const
+	{
+		if (batch.dstStages == 0)
+		{
+			return;
+		}
+
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+
+		for (const Barrier& barrier : batch.barriers)
+		{
+			const Resource& resource = mResources[barrier.resource];
+
+			if (resource.isImage)
+			{
+				VkImageMemoryBarrier imageBarrier = {};
+				imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageBarrier.srcAccessMask = barrier.srcAccess;
+				imageBarrier.dstAccessMask = barrier.dstAccess;
+				imageBarrier.oldLayout = barrier.oldLayout;
+				imageBarrier.newLayout = barrier.newLayout;
+				imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.image = getImage(resource, imageIndex);
+				imageBarrier.subresourceRange.aspectMask = getAspectMask(resource.format);
+				imageBarrier.subresourceRange.baseMipLevel = 0;
+				imageBarrier.subresourceRange.levelCount = 1;
+				imageBarrier.subresourceRange.baseArrayLayer = 0;
+				imageBarrier.subresourceRange.layerCount = 1;
+				imageBarriers.push_back(imageBarrier);
+			}
+			else
+			{
+				VkBufferMemoryBarrier bufferBarrier = {};
+				bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				bufferBarrier.srcAccessMask = barrier.srcAccess;
+				bufferBarrier.dstAccessMask = barrier.dstAccess;
+				bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				bufferBarrier.buffer = resource.buffers[resource.buffers.size() == 1 ? 0 : imageIndex];
+				bufferBarrier.offset = 0;
+				bufferBarrier.size = VK_WHOLE_SIZE;
+				bufferBarriers.push_back(bufferBarrier);
+			}
+		}
+
+		VkPipelineStageFlags srcStages = batch.srcStages != 0 ? batch.srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer, srcStages, batch.dstStages, 0, 0, nullptr,
+			static_cast<uint32>(bufferBarriers.size()), bufferBarriers.data(),
+			static_cast<uint32>(imageBarriers.size()), imageBarriers.data());
+	}
+
+	uint32 RenderGraph::findMemoryType(uint32 typeFilter, VkMemoryPropertyFlags properties) const
+	{
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice, &memProperties);
+
+		for (uint32 i = 0; i < memProperties.memoryTypeCount; ++i)
+		{
+			if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				return i;
+			}
+		}
+
+		throw std::runtime_error("Failed to find suitable memory type for render graph image.");
+	}
+
+	VkImageAspectFlags RenderGraph::getAspectMask(VkFormat format)
+	{
+		if (!isDepthFormat(format))
+		{
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+
+		bool hasStencil = format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
+		return hasStencil ? (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT) : VK_IMAGE_ASPECT_DEPTH_BIT;
+	}
+
+	VkImage RenderGraph::getImage(const Resource& resource, std::size_t imageIndex) const
+	{
+		return resource.images[resource.images.size() == 1 ? 0 : imageIndex];
+	}
+
+	VkImageView RenderGraph::getView(const Resource& resource, std::size_t imageIndex) const
+	{
+		return resource.views[resource.views.size() == 1 ? 0 : imageIndex];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include <qubeengine/render/ShaderCompiler.h>
+
+#include <qubeengine/io/FileView.h>
+#include <qubeengine/util/Hash.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef QUBEENGINE_HAS_SHADERC
+#include <shaderc/shaderc.h>
+#endif
+
+namespace qe::render
+{
+	struct ShaderStage
+	{
+		const char* pExtension;
+		const char* pName; //As glslangValidator -S takes it
+#ifdef QUBEENGINE_HAS_SHADERC
+		shaderc_shader_kind kind;
+#endif
+	};
+
+#ifdef QUBEENGINE_HAS_SHADERC
+	static const ShaderStage SHADER_STAGES[] = {
+		{ ".vert", "vert", shaderc_vertex_shader },
+		{ ".frag", "frag", shaderc_fragment_shader },
+		{ ".comp", "comp", shaderc_compute_shader },
+		{ ".geom", "geom", shaderc_geometry_shader },
+		{ ".tesc", "tesc", shaderc_tess_control_shader },
+		{ ".tese", "tese", shaderc_tess_evaluation_shader }
+	};
+#else
+	static const ShaderStage SHADER_STAGES[] = {
+		{ ".vert", "vert" },
+		{ ".frag", "frag" },
+		{ ".comp", "comp" },
+		{ ".geom", "geom" },
+		{ ".tesc", "tesc" },
+		{ ".tese", "tese" }
+	};
+#endif
+
+	static inline const ShaderStage* findStage(const std::string& path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		for (const ShaderStage& stage : SHADER_STAGES)
+		{
+			if (extension == stage.pExtension)
+			{
+				return &stage;
+			}
+		}
+
+		return nullptr;
+	}
+
+	static inline bool writeFile(const std::string& path, const void* pData, std::size_t size)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+
+		file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+
+		return file.good();
+	}
+
+	static inline std::string quote(const std::string& text)
+	{
+		return "\"" + text + "\"";
+	}
+
+	ShaderCompiler::ShaderCompiler(const std::string& validatorPath) :
+		mValidatorPath(validatorPath.empty() ? findValidator() : validatorPath)
+	{
+#ifdef QUBEENGINE_HAS_SHADERC
+		mpCompiler = shaderc_compiler_initialize();
+		if (!mpCompiler)
+		{
+			throw std::runtime_error("Failed to initialize shader compiler.");
+		}
+#endif
+	}
+
+	ShaderCompiler::~ShaderCompiler()
+	{
+#ifdef QUBEENGINE_HAS_SHADERC
+		shaderc_compiler_release(static_cast<shaderc_compiler_t>(mpCompiler));
+#endif
+	}
+
+	bool ShaderCompiler::isShader(const std::string& path)
+	{
+		return findStage(path) != nullptr;
+	}
+
+	uint64 ShaderCompiler::computeSourceKey(const std::string& sourcePath, const io::FileView& source)
+	{
+		std::string stage = std::filesystem::path(sourcePath).extension().string();
+
+		return util::hashBytes(stage.data(), stage.size(), util::hashValue(VERSION, util::hashBytes(source.getData(), source.getSize())));
+	}
+
+	bool ShaderCompiler::compile(const std::string& sourcePath, const io::FileView& source, const std::string& outputPath) const
+	{
+		const ShaderStage* pStage = findStage(sourcePath);
+		if (!pStage)
+		{
+			std::cout << "Failed to compile " << sourcePath << ", it is not a shader stage." << std::endl;
+			return false;
+		}
+
+		//Compiled next to the destination first, like the caches.
+		std::string tempPath = outputPath + ".tmp";
+		bool isCompiled;
+
+#ifdef QUBEENGINE_HAS_SHADERC
+		//Options are not shared between threads, the compiler is.
+		shaderc_compile_options_t options = shaderc_compile_options_initialize();
+		shaderc_compilation_result_t result = shaderc_compile_into_spv(static_cast<shaderc_compiler_t>(mpCompiler),
+			reinterpret_cast<const char*>(source.getData()), source.getSize(), pStage->kind, sourcePath.c_str(), "main", options);
+		shaderc_compile_options_release(options);
+
+		isCompiled = shaderc_result_get_compilation_status(result) == shaderc_compilation_status_success;
+		if (isCompiled)
+		{
+			isCompiled = writeFile(tempPath, shaderc_result_get_bytes(result), shaderc_result_get_length(result));
+		}
+		else
+		{
+			std::cout << shaderc_result_get_error_message(result);
+		}
+
+		shaderc_result_release(result);
+#else
+		//The validator reads the source from a copy of the contents that were hashed, since the file may have
+		//been edited again in the meantime. The stage is passed because the copy has no shader extension.
+		std::string sourceCopyPath = outputPath + ".glsl.tmp";
+		std::string command = quote(mValidatorPath) + " -V -S " + pStage->pName + " " + quote(sourceCopyPath) + " -o " + quote(tempPath);
+
+#ifdef WIN32
+		//cmd.exe removes the first and last quote of a command that starts with one.
+		command = quote(command);
+#endif
+
+		isCompiled = writeFile(sourceCopyPath, source.getData(), source.getSize()) && std::system(command.c_str()) == 0;
+		std::remove(sourceCopyPath.c_str());
+#endif
+
+		if (!isCompiled)
+		{
+			std::remove(tempPath.c_str());
+			std::cout << "Failed to compile shader " << sourcePath << "." << std::endl;
+			return false;
+		}
+
+		std::remove(outputPath.c_str());
+
+		return std::rename(tempPath.c_str(), outputPath.c_str()) == 0;
+	}
+
+	std::string ShaderCompiler::findValidator()
+	{
+#ifdef WIN32
+		const std::string validatorName = "glslangValidator.exe";
+#else
+		const std::string validatorName = "glslangValidator";
+#endif
+
+		//The SDK keeps its tools in Bin on Windows and in bin everywhere else.
+		const char* pSdkPath = std::getenv("VULKAN_SDK");
+		if (pSdkPath)
+		{
+			for (const char* pDirectory : { "Bin", "bin" })
+			{
+				std::error_code error;
+				std::filesystem::path path = std::filesystem::path(pSdkPath) / pDirectory / validatorName;
+
+				if (std::filesystem::exists(path, error))
+				{
+					return path.string();
+				}
+			}
+		}
+
+		return validatorName;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include <qubeengine/render/ShaderLibrary.h>
+
+#include <qubeengine/io/AssetManifest.h>
+#include <qubeengine/io/FileSystem.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+namespace qe::render
+{
+	static inline std::string toHex(uint64 value)
+	{
+		char text[17];
+		std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+
+		return text;
+	}
+
+	ShaderLibrary::ShaderLibrary(const io::FileSystem& fileSystem, const io::AssetManifest& manifest, const std::string& shaderDirectory,
+		const std::string& cacheDirectory, thread::JobSystem& jobSystem) :
+		mFileSystem(fileSystem),
+		mManifest(manifest),
+		mShaderDirectory(shaderDirectory),
+		mCacheDirectory(cacheDirectory),
+		mJobSystem(jobSystem),
+		mLastPoll(std::chrono::steady_clock::now())
+	{
+	}
+
+	ShaderLibrary::~ShaderLibrary()
+	{
+		//The compile jobs use the library.
+		for (Reload& reload : mReloads)
+		{
+			reload.binaryPath.wait();
+		}
+	}
+
+	std::string ShaderLibrary::getBinaryPath(const std::string& sourceName)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (const Shader& shader : mShaders)
+			{
+				if (shader.sourceName == sourceName)
+				{
+					return shader.binaryPath;
+				}
+			}
+		}
+
+		//The stamp is taken before compiling, so an edit made in the meantime is picked up by the next poll.
+		std::string sourcePath = mShaderDirectory + sourceName;
+		Shader shader;
+		shader.sourceName = sourceName;
+		shader.hasSource = io::AssetManifest::getSourceStamp(sourcePath, shader.sourceSize, shader.sourceTime);
+		shader.binaryPath = findBinary(sourcePath);
+
+		if (shader.binaryPath.empty())
+		{
+			throw std::runtime_error("Failed to load shader " + sourcePath + ".");
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mShaders.push_back(shader);
+
+		return shader.binaryPath;
+	}
+
+	bool ShaderLibrary::update()
+	{
+		//Shaders edited together usually belong together, so their binaries are swapped in one go.
+		if (!mReloads.empty())
+		{
+			for (Reload& reload : mReloads)
+			{
+				if (reload.binaryPath.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				{
+					return false;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			bool isReloaded = false;
+
+			for (Reload& reload : mReloads)
+			{
+				Shader& shader = mShaders[reload.shader];
+				std::string binaryPath = reload.binaryPath.get();
+
+				if (!binaryPath.empty() && binaryPath != shader.binaryPath)
+				{
+					shader.binaryPath = binaryPath;
+					isReloaded = true;
+					std::cout << "Successfully reloaded shader " << shader.sourceName << "!" << std::endl;
+				}
+			}
+
+			mReloads.clear();
+
+			return isReloaded;
+		}
+
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (now - mLastPoll < POLL_INTERVAL)
+		{
+			return false;
+		}
+
+		mLastPoll = now;
+
+		//The size catches edits within the resolution of the write time.
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (std::size_t i = 0; i < mShaders.size(); ++i)
+		{
+			Shader& shader = mShaders[i];
+			std::string sourcePath = mShaderDirectory + shader.sourceName;
+			uint64 sourceSize;
+			int64 sourceTime;
+
+			if (!shader.hasSource || !io::AssetManifest::getSourceStamp(sourcePath, sourceSize, sourceTime) ||
+				(sourceSize == shader.sourceSize && sourceTime == shader.sourceTime))
+			{
+				continue;
+			}
+
+			shader.sourceSize = sourceSize;
+			shader.sourceTime = sourceTime;
+			mReloads.push_back({ i, mJobSystem.submit([this, sourcePath]() { return findBinary(sourcePath); }) });
+		}
+
+		return false;
+	}
+
+	std::string ShaderLibrary::findBinary(const std::string& sourcePath) const
+	{
+		//The manifest does not list sources that changed since they were cooked.
+		std::string cookedPath;
+		uint64 cookedKey;
+		if (mManifest.find(sourcePath, io::AssetKind::Shader, cookedPath, cookedKey))
+		{
+			return cookedPath;
+		}
+
+		io::FileView source;
+		if (!mFileSystem.open(sourcePath, source))
+		{
+			std::cout << "Failed to open shader " << sourcePath << "." << std::endl;
+			return "";
+		}
+
+		uint64 key = ShaderCompiler::computeSourceKey(sourcePath, source);
+		std::string binaryPath = (std::filesystem::path(mCacheDirectory) / (toHex(key) + ".spv")).string();
+
+		io::FileView binary;
+		if (mFileSystem.open(binaryPath, binary))
+		{
+			return binaryPath;
+		}
+
+		std::error_code error;
+		std::filesystem::create_directories(mCacheDirectory, error);
+
+		if (!mCompiler.compile(sourcePath, source, binaryPath))
+		{
+			return "";
+		}
+
+		std::cout << "Successfully compiled shader " << sourcePath << " to " << binaryPath << "!" << std::endl;
+
+		return binaryPath;
+	}
+}
\ No newline at end of file
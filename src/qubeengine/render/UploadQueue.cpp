@@ -0,0 +1,473 @@
+#include <qubeengine/render/UploadQueue.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace qe::render
+{
+	UploadQueue::UploadQueue(VkDevice device, uint32 transferFamily, QueueTimeline& transferTimeline, uint32 graphicsFamily, QueueTimeline& graphicsTimeline) :
+		mDevice(device),
+		mTransferFamily(transferFamily),
+		mGraphicsFamily(graphicsFamily),
+		mTransferTimeline(transferTimeline),
+		mGraphicsTimeline(graphicsTimeline)
+	{
+		mTransferCommandPool = createCommandPool(mTransferFamily);
+
+		if (isDedicated())
+		{
+			mGraphicsCommandPool = createCommandPool(mGraphicsFamily);
+		}
+	}
+
+	UploadQueue::~UploadQueue()
+	{
+		waitIdle();
+
+		if (mIsRecording)
+		{
+			destroyBatch(mCurrentBatch);
+		}
+
+		vkDestroyCommandPool(mDevice, mTransferCommandPool, nullptr);
+
+		if (mGraphicsCommandPool != VK_NULL_HANDLE)
+		{
+			vkDestroyCommandPool(mDevice, mGraphicsCommandPool, nullptr);
+		}
+	}
+
+	bool UploadQueue::isDedicated() const
+	{
+		return mTransferFamily != mGraphicsFamily;
+	}
+
+	void UploadQueue::uploadBuffer(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkBuffer dstBuffer, VkDeviceSize size, VkBufferUsageFlags dstUsage)
+	{
+		beginBatch();
+		mCurrentBatch.stagingBuffers.push_back({ stagingBuffer, stagingMemory });
+
+		VkBufferCopy copyRegion = {};
+		copyRegion.size = size;
+		vkCmdCopyBuffer(mCurrentBatch.transferCommandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+
+		VkPipelineStageFlags dstStages;
+		VkAccessFlags dstAccess;
+		getBufferScope(dstUsage, dstStages, dstAccess);
+
+		VkBufferMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.buffer = dstBuffer;
+		barrier.offset = 0;
+		barrier.size = size;
+
+		if (isDedicated())
+		{
+			//Release on the transfer queue. Its destination scope is ignored, the acquire below provides it.
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = mTransferFamily;
+			barrier.dstQueueFamilyIndex = mGraphicsFamily;
+			vkCmdPipelineBarrier(mCurrentBatch.transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+			//Acquire on the graphics queue, after the transfer timeline reached the batch.
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = dstAccess;
+			vkCmdPipelineBarrier(mCurrentBatch.acquireCommandBuffer, dstStages, dstStages,
+				0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+			mCurrentBatch.acquireStages |= dstStages;
+		}
+		else
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = dstAccess;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			vkCmdPipelineBarrier(mCurrentBatch.transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages,
+				0, 0, nullptr, 1, &barrier, 0, nullptr);
+		}
+	}
+
+	void UploadQueue::uploadImage(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkImage dstImage, uint32 width, uint32 height, uint32 mipLevels)
+	{
+		VkBufferImageCopy region = {};
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { width, height, 1 };
+		copyImage(stagingBuffer, stagingMemory, dstImage, &region, 1, mipLevels);
+
+		if (mipLevels == 1)
+		{
+			releaseImage(dstImage, 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+			return;
+		}
+
+		releaseImage(dstImage, mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT);
+		generateMips(dstImage, width, height, mipLevels);
+	}
+
+	void UploadQueue::uploadImageLevels(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkImage dstImage, const std::vector<VkBufferImageCopy>& regions)
+	{
+		uint32 levelCount = 0;
+		for (const VkBufferImageCopy& region : regions)
+		{
+			levelCount = std::max(levelCount, region.imageSubresource.mipLevel + 1);
+		}
+
+		copyImage(stagingBuffer, stagingMemory, dstImage, regions.data(), static_cast<uint32>(regions.size()), levelCount);
+		releaseImage(dstImage, levelCount, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	}
+
+	void UploadQueue::updateBuffer(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkBuffer dstBuffer, VkDeviceSize size, VkBufferUsageFlags dstUsage)
+	{
+		beginBatch();
+		mCurrentBatch.stagingBuffers.push_back({ stagingBuffer, stagingMemory });
+
+		VkCommandBuffer commandBuffer = getGraphicsCommandBuffer();
+
+		VkPipelineStageFlags dstStages;
+		VkAccessFlags dstAccess;
+		getBufferScope(dstUsage, dstStages, dstAccess);
+
+		//Earlier submissions on the graphics queue finish reading before the copy writes.
+		VkBufferMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.buffer = dstBuffer;
+		barrier.offset = 0;
+		barrier.size = size;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, dstStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		VkBufferCopy copyRegion = {};
+		copyRegion.size = size;
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = dstAccess;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+		if (isDedicated())
+		{
+			mCurrentBatch.acquireStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+		}
+	}
+
+	void UploadQueue::flush()
+	{
+		if (!mIsRecording)
+		{
+			return;
+		}
+
+		Batch& batch = mCurrentBatch;
+		vkEndCommandBuffer(batch.transferCommandBuffer);
+		batch.transferValue = mTransferTimeline.submit({ batch.transferCommandBuffer });
+
+		if (isDedicated())
+		{
+			//Everything the graphics queue submits after this sees the acquired resources.
+			vkEndCommandBuffer(batch.acquireCommandBuffer);
+			batch.acquireValue = mGraphicsTimeline.submit({ batch.acquireCommandBuffer },
+				{ { mTransferTimeline.getSemaphore(), batch.transferValue, batch.acquireStages } });
+		}
+
+		mPendingBatches.push_back(batch);
+		mCurrentBatch = Batch();
+		mIsRecording = false;
+	}
+
+	void UploadQueue::collect()
+	{
+		if (mPendingBatches.empty())
+		{
+			return;
+		}
+
+		uint64 transferCompleted = mTransferTimeline.getCompletedValue();
+		uint64 graphicsCompleted = mGraphicsTimeline.getCompletedValue();
+
+		std::size_t remaining = 0;
+		for (std::size_t i = 0; i < mPendingBatches.size(); ++i)
+		{
+			if (mPendingBatches[i].transferValue <= transferCompleted && mPendingBatches[i].acquireValue <= graphicsCompleted)
+			{
+				destroyBatch(mPendingBatches[i]);
+			}
+			else
+			{
+				mPendingBatches[remaining++] = mPendingBatches[i];
+			}
+		}
+
+		mPendingBatches.resize(remaining);
+	}
+
+	void UploadQueue::waitIdle()
+	{
+		for (Batch& batch : mPendingBatches)
+		{
+			mTransferTimeline.wait(batch.transferValue);
+			mGraphicsTimeline.wait(batch.acquireValue);
+			destroyBatch(batch);
+		}
+
+		mPendingBatches.clear();
+	}
+
+	void UploadQueue::getBufferScope(VkBufferUsageFlags usage, VkPipelineStageFlags& stages, VkAccessFlags& access)
+	{
+		stages = 0;
+		access = 0;
+
+		if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+		{
+			stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+			access |= VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+		}
+		if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+		{
+			stages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+			access |= VK_ACCESS_INDEX_READ_BIT;
+		}
+		if (usage & (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT))
+		{
+			stages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+			access |= VK_ACCESS_SHADER_READ_BIT;
+		}
+		if (usage & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)
+		{
+			stages |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+			access |= VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		}
+		if (usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
+		{
+			stages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+			access |= VK_ACCESS_TRANSFER_READ_BIT;
+		}
+
+		if (stages == 0)
+		{
+			stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			access = VK_ACCESS_MEMORY_READ_BIT;
+		}
+	}
+
+	void UploadQueue::copyImage(VkBuffer stagingBuffer, VkDeviceMemory stagingMemory, VkImage dstImage, const VkBufferImageCopy* pRegions, uint32 regionCount, uint32 levelCount)
+	{
+		beginBatch();
+		mCurrentBatch.stagingBuffers.push_back({ stagingBuffer, stagingMemory });
+
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = dstImage;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		vkCmdPipelineBarrier(mCurrentBatch.transferCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		vkCmdCopyBufferToImage(mCurrentBatch.transferCommandBuffer, stagingBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, regionCount, pRegions);
+	}
+
+	void UploadQueue::releaseImage(VkImage dstImage, uint32 levelCount, VkImageLayout newLayout, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+	{
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = dstImage;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+		//The layout transition is part of the ownership transfer and must be identical in both halves.
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = newLayout;
+
+		if (isDedicated())
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = 0;
+			barrier.srcQueueFamilyIndex = mTransferFamily;
+			barrier.dstQueueFamilyIndex = mGraphicsFamily;
+			vkCmdPipelineBarrier(mCurrentBatch.transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = dstAccess;
+			vkCmdPipelineBarrier(mCurrentBatch.acquireCommandBuffer, dstStages, dstStages,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			mCurrentBatch.acquireStages |= dstStages;
+		}
+		else
+		{
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = dstAccess;
+			vkCmdPipelineBarrier(mCurrentBatch.transferCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+		}
+	}
+
+	void UploadQueue::generateMips(VkImage dstImage, uint32 width, uint32 height, uint32 mipLevels)
+	{
+		VkCommandBuffer commandBuffer = getGraphicsCommandBuffer();
+
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.image = dstImage;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+
+		int32 levelWidth = static_cast<int32>(width);
+		int32 levelHeight = static_cast<int32>(height);
+
+		//Every level is blitted from the one above it, which is then done and handed to the fragment shader.
+		for (uint32 level = 1; level < mipLevels; ++level)
+		{
+			barrier.subresourceRange.baseMipLevel = level - 1;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			int32 nextWidth = std::max(levelWidth / 2, 1);
+			int32 nextHeight = std::max(levelHeight / 2, 1);
+
+			VkImageBlit blit = {};
+			blit.srcOffsets[0] = { 0, 0, 0 };
+			blit.srcOffsets[1] = { levelWidth, levelHeight, 1 };
+			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.srcSubresource.mipLevel = level - 1;
+			blit.srcSubresource.baseArrayLayer = 0;
+			blit.srcSubresource.layerCount = 1;
+			blit.dstOffsets[0] = { 0, 0, 0 };
+			blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+			blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			blit.dstSubresource.mipLevel = level;
+			blit.dstSubresource.baseArrayLayer = 0;
+			blit.dstSubresource.layerCount = 1;
+			vkCmdBlitImage(commandBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &blit, VK_FILTER_LINEAR);
+
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+
+		barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+
+	VkCommandBuffer UploadQueue::getGraphicsCommandBuffer() const
+	{
+		return isDedicated() ? mCurrentBatch.acquireCommandBuffer : mCurrentBatch.transferCommandBuffer;
+	}
+
+	void UploadQueue::beginBatch()
+	{
+		if (mIsRecording)
+		{
+			return;
+		}
+
+		VkCommandBufferBeginInfo beginInfo = {};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		mCurrentBatch.transferCommandBuffer = allocateCommandBuffer(mTransferCommandPool);
+		vkBeginCommandBuffer(mCurrentBatch.transferCommandBuffer, &beginInfo);
+
+		if (isDedicated())
+		{
+			mCurrentBatch.acquireCommandBuffer = allocateCommandBuffer(mGraphicsCommandPool);
+			vkBeginCommandBuffer(mCurrentBatch.acquireCommandBuffer, &beginInfo);
+		}
+
+		mIsRecording = true;
+	}
+
+	void UploadQueue::destroyBatch(Batch& batch)
+	{
+		vkFreeCommandBuffers(mDevice, mTransferCommandPool, 1, &batch.transferCommandBuffer);
+
+		if (batch.acquireCommandBuffer != VK_NULL_HANDLE)
+		{
+			vkFreeCommandBuffers(mDevice, mGraphicsCommandPool, 1, &batch.acquireCommandBuffer);
+		}
+
+		for (const StagingBuffer& staging : batch.stagingBuffers)
+		{
+			vkDestroyBuffer(mDevice, staging.buffer, nullptr);
+			vkFreeMemory(mDevice, staging.memory, nullptr);
+		}
+	}
+
+	VkCommandBuffer UploadQueue::allocateCommandBuffer(VkCommandPool pool)
+	{
+		VkCommandBufferAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = pool;
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer commandBuffer;
+		if (vkAllocateCommandBuffers(mDevice, &allocInfo, &commandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate upload command buffer.");
+		}
+
+		return commandBuffer;
+	}
+
+	VkCommandPool UploadQueue::createCommandPool(uint32 queueFamily)
+	{
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = queueFamily;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		VkCommandPool pool;
+		if (vkCreateCommandPool(mDevice, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create upload command pool.");
+		}
+
+		return pool;
+	}
+}
\ No newline at end of file
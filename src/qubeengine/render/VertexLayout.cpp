@@ -0,0 +1,323 @@
+#include <qubeengine/render/VertexLayout.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace qe::render
+{
+	//Half floats step by at most 2^-10 up to this magnitude, below a texel of a 1024 texture.
+	static constexpr float MAX_HALF_TEX_COORD = 2.0f;
+
+	static inline uint16 floatToHalf(float value)
+	{
+		uint32 bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		uint16 sign = static_cast<uint16>((bits >> 16) & 0x8000);
+		uint32 magnitude = bits & 0x7FFFFFFF;
+
+		//Too large, infinite or NaN.
+		if (magnitude >= 0x477FF000)
+		{
+			return sign | (magnitude > 0x7F800000 ? 0x7E00 : 0x7C00);
+		}
+
+		//Too small even for a denormal half.
+		if (magnitude < 0x33000000)
+		{
+			return sign;
+		}
+
+		int32 exponent = static_cast<int32>(magnitude >> 23) - 127 + 15;
+		uint32 mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+
+		//Denormals shift the implicit one into the mantissa. Round to nearest, a carry into the exponent
+		//gives the next larger half, which is correct.
+		uint32 shift = exponent > 0 ? 13 : static_cast<uint32>(14 - exponent);
+		uint32 half = mantissa >> shift;
+		if (exponent > 0)
+		{
+			half = (static_cast<uint32>(exponent) << 10) | (half & 0x3FF);
+		}
+
+		half += (mantissa >> (shift - 1)) & 1;
+
+		return sign | static_cast<uint16>(half);
+	}
+
+	static inline uint16 floatToUnorm16(float value)
+	{
+		return static_cast<uint16>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+	}
+
+	static inline float halfToFloat(uint16 half)
+	{
+		uint32 sign = static_cast<uint32>(half & 0x8000) << 16;
+		uint32 exponent = (half >> 10) & 0x1F;
+		uint32 mantissa = half & 0x3FF;
+
+		//Denormals are exact in float, so they are scaled instead of shifted into shape.
+		if (exponent == 0)
+		{
+			float value = std::ldexp(static_cast<float>(mantissa), -24);
+			return sign ? -value : value;
+		}
+
+		uint32 bits = sign | (exponent == 0x1F ? 0x7F800000 | (mantissa << 13) : ((exponent + 127 - 15) << 23) | (mantissa << 13));
+
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+
+		return value;
+	}
+
+	VertexLayout::VertexLayout(PositionFormat positionFormat, TexCoordFormat texCoordFormat)
+		: mPositionFormat(positionFormat), mTexCoordFormat(texCoordFormat)
+	{
+	}
+
+	VertexLayout VertexLayout::choose(const float* pTexCoords, uint32 stride, std::size_t vertexCount)
+	{
+		const uint8* pBytes = reinterpret_cast<const uint8*>(pTexCoords);
+		float minTexCoord = 0.0f;
+		float maxTexCoord = 0.0f;
+
+		for (std::size_t i = 0; i < vertexCount; ++i)
+		{
+			const float* pTexCoord = reinterpret_cast<const float*>(pBytes + i * stride);
+			minTexCoord = std::min({ minTexCoord, pTexCoord[0], pTexCoord[1] });
+			maxTexCoord = std::max({ maxTexCoord, pTexCoord[0], pTexCoord[1] });
+		}
+
+		TexCoordFormat texCoordFormat = TexCoordFormat::Float2;
+		if (minTexCoord >= 0.0f && maxTexCoord <= 1.0f)
+		{
+			texCoordFormat = TexCoordFormat::Unorm16x2;
+		}
+		else if (minTexCoord >= -MAX_HALF_TEX_COORD && maxTexCoord <= MAX_HALF_TEX_COORD)
+		{
+			texCoordFormat = TexCoordFormat::Half2;
+		}
+
+		return VertexLayout(PositionFormat::Unorm16x4, texCoordFormat);
+	}
+
+	VertexLayout VertexLayout::combine(const VertexLayout& a, const VertexLayout& b)
+	{
+		PositionFormat positionFormat = a.mPositionFormat == PositionFormat::Float3 || b.mPositionFormat == PositionFormat::Float3 ?
+			PositionFormat::Float3 : PositionFormat::Unorm16x4;
+
+		//Half floats hold unorm coordinates as exactly as choose asks of them, the other way around they do not fit.
+		TexCoordFormat texCoordFormat = a.mTexCoordFormat;
+		if (a.mTexCoordFormat != b.mTexCoordFormat)
+		{
+			texCoordFormat = a.mTexCoordFormat == TexCoordFormat::Float2 || b.mTexCoordFormat == TexCoordFormat::Float2 ?
+				TexCoordFormat::Float2 : TexCoordFormat::Half2;
+		}
+
+		return VertexLayout(positionFormat, texCoordFormat);
+	}
+
+	uint32 VertexLayout::getKey() const
+	{
+		return static_cast<uint32>(mPositionFormat) | (static_cast<uint32>(mTexCoordFormat) << 8);
+	}
+
+	bool VertexLayout::fromKey(uint32 key, VertexLayout& layout)
+	{
+		uint32 positionFormat = key & 0xFF;
+		uint32 texCoordFormat = (key >> 8) & 0xFF;
+
+		if (positionFormat > static_cast<uint32>(PositionFormat::Unorm16x4) || texCoordFormat > static_cast<uint32>(TexCoordFormat::Unorm16x2) ||
+			(key >> 16) != 0)
+		{
+			return false;
+		}
+
+		layout = VertexLayout(static_cast<PositionFormat>(positionFormat), static_cast<TexCoordFormat>(texCoordFormat));
+
+		return true;
+	}
+
+	PositionFormat VertexLayout::getPositionFormat() const
+	{
+		return mPositionFormat;
+	}
+
+	TexCoordFormat VertexLayout::getTexCoordFormat() const
+	{
+		return mTexCoordFormat;
+	}
+
+	uint32 VertexLayout::getStride() const
+	{
+		uint32 positionSize = mPositionFormat == PositionFormat::Float3 ? 12 : 8;
+		uint32 texCoordSize = mTexCoordFormat == TexCoordFormat::Float2 ? 8 : 4;
+
+		return positionSize + texCoordSize;
+	}
+
+	VkVertexInputBindingDescription VertexLayout::getBindingDescription(uint32 binding) const
+	{
+		VkVertexInputBindingDescription bindingDescription = {};
+		bindingDescription.binding = binding;
+		bindingDescription.stride = getStride();
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> VertexLayout::getAttributeDescriptions(uint32 binding) const
+	{
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+
+		attributeDescriptions[0].binding = binding;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = mPositionFormat == PositionFormat::Float3 ? VK_FORMAT_R32G32B32_SFLOAT : VK_FORMAT_R16G16B16A16_UNORM;
+		attributeDescriptions[0].offset = 0;
+
+		attributeDescriptions[1].binding = binding;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].offset = mPositionFormat == PositionFormat::Float3 ? 12 : 8;
+
+		switch (mTexCoordFormat)
+		{
+		case TexCoordFormat::Float2:
+			attributeDescriptions[1].format = VK_FORMAT_R32G32_SFLOAT;
+			break;
+		case TexCoordFormat::Half2:
+			attributeDescriptions[1].format = VK_FORMAT_R16G16_SFLOAT;
+			break;
+		case TexCoordFormat::Unorm16x2:
+			attributeDescriptions[1].format = VK_FORMAT_R16G16_UNORM;
+			break;
+		}
+
+		return attributeDescriptions;
+	}
+
+	void VertexLayout::getDequantization(const glm::vec3& boundsMin, const glm::vec3& boundsMax, glm::vec3& offset, glm::vec3& scale) const
+	{
+		if (mPositionFormat == PositionFormat::Float3)
+		{
+			offset = glm::vec3(0.0f);
+			scale = glm::vec3(1.0f);
+			return;
+		}
+
+		offset = boundsMin;
+		scale = boundsMax - boundsMin;
+	}
+
+	void VertexLayout::pack(const float* pPositions, const float* pTexCoords, uint32 stride, uint32 vertexCount,
+		const glm::vec3& boundsMin, const glm::vec3& boundsMax, void* pDestination) const
+	{
+		const uint8* pPositionBytes = reinterpret_cast<const uint8*>(pPositions);
+		const uint8* pTexCoordBytes = reinterpret_cast<const uint8*>(pTexCoords);
+		uint8* pTarget = static_cast<uint8*>(pDestination);
+
+		//Flat axes store zero.
+		glm::vec3 extent = boundsMax - boundsMin;
+		float inverseExtent[3];
+		for (uint32 axis = 0; axis < 3; ++axis)
+		{
+			inverseExtent[axis] = extent[axis] > 0.0f ? 1.0f / extent[axis] : 0.0f;
+		}
+
+		for (uint32 i = 0; i < vertexCount; ++i)
+		{
+			const float* pPosition = reinterpret_cast<const float*>(pPositionBytes + (std::size_t)i * stride);
+			const float* pTexCoord = reinterpret_cast<const float*>(pTexCoordBytes + (std::size_t)i * stride);
+
+			if (mPositionFormat == PositionFormat::Float3)
+			{
+				std::memcpy(pTarget, pPosition, 3 * sizeof(float));
+				pTarget += 3 * sizeof(float);
+			}
+			else
+			{
+				uint16 position[4] = {};
+				for (uint32 axis = 0; axis < 3; ++axis)
+				{
+					position[axis] = floatToUnorm16((pPosition[axis] - boundsMin[axis]) * inverseExtent[axis]);
+				}
+
+				std::memcpy(pTarget, position, sizeof(position));
+				pTarget += sizeof(position);
+			}
+
+			if (mTexCoordFormat == TexCoordFormat::Float2)
+			{
+				std::memcpy(pTarget, pTexCoord, 2 * sizeof(float));
+				pTarget += 2 * sizeof(float);
+			}
+			else
+			{
+				uint16 texCoord[2];
+				for (uint32 component = 0; component < 2; ++component)
+				{
+					texCoord[component] = mTexCoordFormat == TexCoordFormat::Half2 ? floatToHalf(pTexCoord[component]) : floatToUnorm16(pTexCoord[component]);
+				}
+
+				std::memcpy(pTarget, texCoord, sizeof(texCoord));
+				pTarget += sizeof(texCoord);
+			}
+		}
+	}
+	void VertexLayout::repack(const VertexLayout& sourceLayout, const void* pSource, uint32 vertexCount,
+		const glm::vec3& boundsMin, const glm::vec3& boundsMax, void* pDestination) const
+	{
+		const uint8* pBytes = static_cast<const uint8*>(pSource);
+		uint32 sourceStride = sourceLayout.getStride();
+		uint32 texCoordOffset = sourceLayout.mPositionFormat == PositionFormat::Float3 ? 12 : 8;
+
+		glm::vec3 offset;
+		glm::vec3 scale;
+		sourceLayout.getDequantization(boundsMin, boundsMax, offset, scale);
+
+		//Unpacked to full precision first, five floats per vertex, then packed like a loaded mesh.
+		std::vector<float> vertices((std::size_t)5 * vertexCount);
+
+		for (uint32 i = 0; i < vertexCount; ++i)
+		{
+			const uint8* pVertex = pBytes + (std::size_t)i * sourceStride;
+			float* pTarget = &vertices[(std::size_t)5 * i];
+
+			if (sourceLayout.mPositionFormat == PositionFormat::Float3)
+			{
+				std::memcpy(pTarget, pVertex, 3 * sizeof(float));
+			}
+			else
+			{
+				uint16 position[4];
+				std::memcpy(position, pVertex, sizeof(position));
+
+				for (uint32 axis = 0; axis < 3; ++axis)
+				{
+					pTarget[axis] = offset[axis] + position[axis] / 65535.0f * scale[axis];
+				}
+			}
+
+			if (sourceLayout.mTexCoordFormat == TexCoordFormat::Float2)
+			{
+				std::memcpy(pTarget + 3, pVertex + texCoordOffset, 2 * sizeof(float));
+			}
+			else
+			{
+				uint16 texCoord[2];
+				std::memcpy(texCoord, pVertex + texCoordOffset, sizeof(texCoord));
+
+				for (uint32 component = 0; component < 2; ++component)
+				{
+					pTarget[3 + component] = sourceLayout.mTexCoordFormat == TexCoordFormat::Half2 ? halfToFloat(texCoord[component]) : texCoord[component] / 65535.0f;
+				}
+			}
+		}
+
+		if (vertexCount > 0)
+		{
+			pack(&vertices[0], &vertices[3], 5 * sizeof(float), vertexCount, boundsMin, boundsMax, pDestination);
+		}
+	}
+}
\ No newline at end of file
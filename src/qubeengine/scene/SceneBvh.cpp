@@ -0,0 +1,396 @@
+#include <qubeengine/scene/SceneBvh.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <numeric>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QUBEENGINE_BVH_SSE
+#endif
+
+namespace qe::scene
+{
+	//Unused node slots get a box that every plane rejects. Large but finite, so a zero plane component 
+	//multiplies out to zero instead of NaN.
+	static const float EMPTY_SLOT_EXTENT = 1e30f;
+
+	void Aabb::expand(const glm::vec3& point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void Aabb::expand(const Aabb& other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+
+	glm::vec3 Aabb::getCenter() const
+	{
+		return (min + max) * 0.5f;
+	}
+
+	Aabb Aabb::empty()
+	{
+		Aabb box;
+		box.min = glm::vec3(std::numeric_limits<float>::max());
+		box.max = glm::vec3(-std::numeric_limits<float>::max());
+		return box;
+	}
+
+	Aabb Aabb::transform(const Aabb& box, const glm::mat4& matrix)
+	{
+		glm::vec3 center = box.getCenter();
+		glm::vec3 extent = (box.max - box.min) * 0.5f;
+
+		glm::vec3 newCenter = glm::vec3(matrix * glm::vec4(center, 1.0f));
+		glm::vec3 newExtent = 
+			glm::abs(glm::vec3(matrix[0])) * extent.x + 
+			glm::abs(glm::vec3(matrix[1])) * extent.y + 
+			glm::abs(glm::vec3(matrix[2])) * extent.z;
+
+		Aabb result;
+		result.min = newCenter - newExtent;
+		result.max = newCenter + newExtent;
+		return result;
+	}
+
+	void SceneBvh::build(const std::vector<Aabb>& objectBounds)
+	{
+		clear();
+		mObjectCount = objectBounds.size();
+
+		if (objectBounds.empty())
+		{
+			return;
+		}
+
+		std::vector<uint32> objects(objectBounds.size());
+		std::iota(objects.begin(), objects.end(), 0);
+
+		std::vector<glm::vec3> centroids(objectBounds.size());
+		for (std::size_t i = 0; i < objectBounds.size(); ++i)
+		{
+			centroids[i] = objectBounds[i].getCenter();
+		}
+
+		//A full eight wide tree has roughly one node per seven objects.
+		mNodes.reserve(objectBounds.size() / (NODE_WIDTH - 1) + 1);
+		buildNode(objects, 0, static_cast<uint32>(objects.size()), objectBounds, centroids);
+	}
+
+	void SceneBvh::clear()
+	{
+		mNodes.clear();
+		mObjectCount = 0;
+	}
+
+	void SceneBvh::cullFrustum(const glm::vec4 planes[6], std::vector<uint32>& visibleObjects, thread::JobSystem* pJobSystem) const
+	{
+		if (mNodes.empty())
+		{
+			return;
+		}
+
+		if (!pJobSystem || pJobSystem->getThreadCount() == 0)
+		{
+			cullNode(0, planes, visibleObjects);
+			return;
+		}
+
+		//Walk the top of the tree on this thread until there are enough intersected subtrees to keep 
+		//every worker busy, then cull those subtrees in parallel.
+		const std::size_t targetSubtreeCount = static_cast<std::size_t>(pJobSystem->getThreadCount() + 1) * 4;
+		std::vector<uint32> subtrees = { 0 };
+
+		for (int level = 0; level < 3 && !subtrees.empty() && subtrees.size() < targetSubtreeCount; ++level)
+		{
+			std::vector<uint32> nextSubtrees;
+			for (uint32 nodeIndex : subtrees)
+			{
+				visitChildren(nodeIndex, planes, visibleObjects, &nextSubtrees);
+			}
+
+			subtrees.swap(nextSubtrees);
+		}
+
+		std::vector<std::vector<uint32>> subtreeResults(subtrees.size());
+		pJobSystem->parallelFor(subtrees.size(), 1, [this, planes, &subtrees, &subtreeResults](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				cullNode(subtrees[i], planes, subtreeResults[i]);
+			}
+		});
+
+		for (const std::vector<uint32>& result : subtreeResults)
+		{
+			visibleObjects.insert(visibleObjects.end(), result.begin(), result.end());
+		}
+	}
+
+	std::size_t SceneBvh::getNodeCount() const
+	{
+		return mNodes.size();
+	}
+
+	std::size_t SceneBvh::getObjectCount() const
+	{
+		return mObjectCount;
+	}
+
+	uint32 SceneBvh::buildNode(std::vector<uint32>& objects, uint32 begin, uint32 end,
+		const std::vector<Aabb>& objectBounds, const std::vector<glm::vec3>& centroids)
+	{
+		uint32 nodeIndex = static_cast<uint32>(mNodes.size());
+		mNodes.emplace_back();
+
+		//Split the range in halves along the longest centroid axis, always halving the largest range, 
+		//until there is one range per child slot.
+		std::vector<std::pair<uint32, uint32>> ranges = { { begin, end } };
+
+		while (ranges.size() < NODE_WIDTH)
+		{
+			auto largest = std::max_element(ranges.begin(), ranges.end(), 
+				[](const std::pair<uint32, uint32>& a, const std::pair<uint32, uint32>& b) { return a.second - a.first < b.second - b.first; });
+
+			uint32 rangeBegin = largest->first;
+			uint32 rangeEnd = largest->second;
+
+			if (rangeEnd - rangeBegin < 2)
+			{
+				break;
+			}
+
+			Aabb centroidBounds = Aabb::empty();
+			for (uint32 i = rangeBegin; i < rangeEnd; ++i)
+			{
+				centroidBounds.expand(centroids[objects[i]]);
+			}
+
+			glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+			int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+			uint32 middle = rangeBegin + (rangeEnd - rangeBegin) / 2;
+
+			std::nth_element(objects.begin() + rangeBegin, objects.begin() + middle, objects.begin() + rangeEnd, 
+				[&centroids, axis](uint32 a, uint32 b) { return centroids[a][axis] < centroids[b][axis]; });
+
+			*largest = { rangeBegin, middle };
+			ranges.push_back({ middle, rangeEnd });
+		}
+
+		std::array<int32, NODE_WIDTH> children = {};
+		std::array<Aabb, NODE_WIDTH> childBounds = {};
+
+		for (std::size_t slot = 0; slot < ranges.size(); ++slot)
+		{
+			uint32 rangeBegin = ranges[slot].first;
+			uint32 rangeEnd = ranges[slot].second;
+
+			if (rangeEnd - rangeBegin == 1)
+			{
+				children[slot] = ~static_cast<int32>(objects[rangeBegin]);
+				childBounds[slot] = objectBounds[objects[rangeBegin]];
+			}
+			else
+			{
+				childBounds[slot] = Aabb::empty();
+				for (uint32 i = rangeBegin; i < rangeEnd; ++i)
+				{
+					childBounds[slot].expand(objectBounds[objects[i]]);
+				}
+
+				children[slot] = static_cast<int32>(buildNode(objects, rangeBegin, rangeEnd, objectBounds, centroids));
+			}
+		}
+
+		//The recursion above may have reallocated mNodes, so the node is only looked up now.
+		Node& node = mNodes[nodeIndex];
+		node.childCount = static_cast<uint32>(ranges.size());
+
+		for (uint32 slot = 0; slot < NODE_WIDTH; ++slot)
+		{
+			bool isUsed = slot < node.childCount;
+
+			node.minX[slot] = isUsed ? childBounds[slot].min.x : EMPTY_SLOT_EXTENT;
+			node.minY[slot] = isUsed ? childBounds[slot].min.y : EMPTY_SLOT_EXTENT;
+			node.minZ[slot] = isUsed ? childBounds[slot].min.z : EMPTY_SLOT_EXTENT;
+			node.maxX[slot] = isUsed ? childBounds[slot].max.x : -EMPTY_SLOT_EXTENT;
+			node.maxY[slot] = isUsed ? childBounds[slot].max.y : -EMPTY_SLOT_EXTENT;
+			node.maxZ[slot] = isUsed ? childBounds[slot].max.z : -EMPTY_SLOT_EXTENT;
+			node.children[slot] = isUsed ? children[slot] : 0;
+		}
+
+		return nodeIndex;
+	}
+
+	void SceneBvh::testNode(const Node& node, const glm::vec4 planes[6], uint32& visibleMask, uint32& insideMask)
+	{
+		//For every plane only two corners of a box matter: the one furthest along the plane normal (if it is 
+		//behind the plane the box is outside) and the one furthest against it (if that one is behind the plane 
+		//the box intersects it). Which min/max array holds those corners only depends on the normal's signs, 
+		//so they are picked once per plane instead of per box.
+#if defined(__AVX__)
+		__m256 outside = _mm256_setzero_ps();
+		__m256 intersecting = _mm256_setzero_ps();
+		const __m256 zero = _mm256_setzero_ps();
+
+		for (int i = 0; i < 6; ++i)
+		{
+			const glm::vec4& plane = planes[i];
+			__m256 nx = _mm256_set1_ps(plane.x);
+			__m256 ny = _mm256_set1_ps(plane.y);
+			__m256 nz = _mm256_set1_ps(plane.z);
+			__m256 d = _mm256_set1_ps(plane.w);
+
+			__m256 farDistance = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(nx, _mm256_load_ps(plane.x >= 0.0f ? node.maxX : node.minX)),
+				_mm256_mul_ps(ny, _mm256_load_ps(plane.y >= 0.0f ? node.maxY : node.minY))), _mm256_add_ps(
+				_mm256_mul_ps(nz, _mm256_load_ps(plane.z >= 0.0f ? node.maxZ : node.minZ)), d));
+
+			__m256 nearDistance = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(nx, _mm256_load_ps(plane.x >= 0.0f ? node.minX : node.maxX)),
+				_mm256_mul_ps(ny, _mm256_load_ps(plane.y >= 0.0f ? node.minY : node.maxY))), _mm256_add_ps(
+				_mm256_mul_ps(nz, _mm256_load_ps(plane.z >= 0.0f ? node.minZ : node.maxZ)), d));
+
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(farDistance, zero, _CMP_LT_OQ));
+			intersecting = _mm256_or_ps(intersecting, _mm256_cmp_ps(nearDistance, zero, _CMP_LT_OQ));
+		}
+
+		uint32 outsideMask = static_cast<uint32>(_mm256_movemask_ps(outside));
+		uint32 intersectingMask = static_cast<uint32>(_mm256_movemask_ps(intersecting));
+#elif defined(QUBEENGINE_BVH_SSE)
+		uint32 outsideMask = 0;
+		uint32 intersectingMask = 0;
+		const __m128 zero = _mm_setzero_ps();
+
+		for (uint32 half = 0; half < NODE_WIDTH; half += 4)
+		{
+			__m128 outside = _mm_setzero_ps();
+			__m128 intersecting = _mm_setzero_ps();
+
+			for (int i = 0; i < 6; ++i)
+			{
+				const glm::vec4& plane = planes[i];
+				__m128 nx = _mm_set1_ps(plane.x);
+				__m128 ny = _mm_set1_ps(plane.y);
+				__m128 nz = _mm_set1_ps(plane.z);
+				__m128 d = _mm_set1_ps(plane.w);
+
+				__m128 farDistance = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(nx, _mm_load_ps((plane.x >= 0.0f ? node.maxX : node.minX) + half)),
+					_mm_mul_ps(ny, _mm_load_ps((plane.y >= 0.0f ? node.maxY : node.minY) + half))), _mm_add_ps(
+					_mm_mul_ps(nz, _mm_load_ps((plane.z >= 0.0f ? node.maxZ : node.minZ) + half)), d));
+
+				__m128 nearDistance = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(nx, _mm_load_ps((plane.x >= 0.0f ? node.minX : node.maxX) + half)),
+					_mm_mul_ps(ny, _mm_load_ps((plane.y >= 0.0f ? node.minY : node.maxY) + half))), _mm_add_ps(
+					_mm_mul_ps(nz, _mm_load_ps((plane.z >= 0.0f ? node.minZ : node.maxZ) + half)), d));
+
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(farDistance, zero));
+				intersecting = _mm_or_ps(intersecting, _mm_cmplt_ps(nearDistance, zero));
+			}
+
+			outsideMask |= static_cast<uint32>(_mm_movemask_ps(outside)) << half;
+			intersectingMask |= static_cast<uint32>(_mm_movemask_ps(intersecting)) << half;
+		}
+#else
+		uint32 outsideMask = 0;
+		uint32 intersectingMask = 0;
+
+		for (uint32 slot = 0; slot < NODE_WIDTH; ++slot)
+		{
+			for (int i = 0; i < 6; ++i)
+			{
+				const glm::vec4& plane = planes[i];
+
+				float farDistance = 
+					plane.x * (plane.x >= 0.0f ? node.maxX[slot] : node.minX[slot]) +
+					plane.y * (plane.y >= 0.0f ? node.maxY[slot] : node.minY[slot]) +
+					plane.z * (plane.z >= 0.0f ? node.maxZ[slot] : node.minZ[slot]) + plane.w;
+
+				float nearDistance = 
+					plane.x * (plane.x >= 0.0f ? node.minX[slot] : node.maxX[slot]) +
+					plane.y * (plane.y >= 0.0f ? node.minY[slot] : node.maxY[slot]) +
+					plane.z * (plane.z >= 0.0f ? node.minZ[slot] : node.maxZ[slot]) + plane.w;
+
+				outsideMask |= (farDistance < 0.0f ? 1u : 0u) << slot;
+				intersectingMask |= (nearDistance < 0.0f ? 1u : 0u) << slot;
+			}
+		}
+#endif
+
+		uint32 usedMask = (1u << node.childCount) - 1u;
+		visibleMask = ~outsideMask & usedMask;
+		insideMask = visibleMask & ~intersectingMask;
+	}
+
+	void SceneBvh::cullNode(uint32 nodeIndex, const glm::vec4 planes[6], std::vector<uint32>& visibleObjects) const
+	{
+		std::vector<uint32> stack = { nodeIndex };
+
+		while (!stack.empty())
+		{
+			uint32 current = stack.back();
+			stack.pop_back();
+			visitChildren(current, planes, visibleObjects, &stack);
+		}
+	}
+
+	void SceneBvh::collectNode(uint32 nodeIndex, std::vector<uint32>& visibleObjects) const
+	{
+		const Node& node = mNodes[nodeIndex];
+
+		for (uint32 slot = 0; slot < node.childCount; ++slot)
+		{
+			int32 child = node.children[slot];
+
+			if (child < 0)
+			{
+				visibleObjects.push_back(static_cast<uint32>(~child));
+			}
+			else
+			{
+				collectNode(static_cast<uint32>(child), visibleObjects);
+			}
+		}
+	}
+
+	void SceneBvh::visitChildren(uint32 nodeIndex, const glm::vec4 planes[6], std::vector<uint32>& visibleObjects, std::vector<uint32>* pIntersectedNodes) const
+	{
+		const Node& node = mNodes[nodeIndex];
+
+		uint32 visibleMask, insideMask;
+		testNode(node, planes, visibleMask, insideMask);
+
+		for (uint32 slot = 0; slot < node.childCount; ++slot)
+		{
+			if ((visibleMask & (1u << slot)) == 0)
+			{
+				continue;
+			}
+
+			int32 child = node.children[slot];
+
+			if (child < 0)
+			{
+				visibleObjects.push_back(static_cast<uint32>(~child));
+			}
+			else if (insideMask & (1u << slot))
+			{
+				//Fully inside the frustum, nothing below needs testing.
+				collectNode(static_cast<uint32>(child), visibleObjects);
+			}
+			else
+			{
+				pIntersectedNodes->push_back(static_cast<uint32>(child));
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,285 @@
+#include <qubeengine/scene/SceneGeometry.h>
+
+#include <qubeengine/io/AssetManifest.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+namespace qe::scene
+{
+	void SceneGeometry::load(const io::FileSystem& fileSystem, const std::vector<std::string>& meshPaths, const io::AssetManifest& manifest,
+		thread::JobSystem& jobSystem)
+	{
+		mpJobSystem = &jobSystem;
+		mModels.clear();
+		mSubmeshes.clear();
+		mFirstSubmeshes.clear();
+
+		for (std::size_t i = 0; i < meshPaths.size(); ++i)
+		{
+			mModels.push_back(std::make_unique<Model>());
+		}
+
+		//One model per chunk. The caller works on chunks as well, so this may run inside a job itself.
+		//Errors are kept until every load has finished, the first one is passed on.
+		std::vector<std::exception_ptr> errors(meshPaths.size());
+		jobSystem.parallelFor(meshPaths.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				try
+				{
+					loadModel(fileSystem, meshPaths[i], manifest, jobSystem, *mModels[i]);
+				}
+				catch (...)
+				{
+					errors[i] = std::current_exception();
+				}
+			}
+		});
+
+		for (const std::exception_ptr& pError : errors)
+		{
+			if (pError)
+			{
+				std::rethrow_exception(pError);
+			}
+		}
+
+		//The arenas hold every model in a layout that fits all of them. Indices are relative to the vertex
+		//offset of their submesh, so 16 bits stay enough as long as they were for every model.
+		mVertexLayout = mModels.empty() ? render::VertexLayout() : mModels[0]->vertexLayout;
+		mIndexSize = 2;
+		mVertexCount = 0;
+		mIndexCount = 0;
+
+		for (std::unique_ptr<Model>& pModel : mModels)
+		{
+			Model& model = *pModel;
+			mVertexLayout = render::VertexLayout::combine(mVertexLayout, model.vertexLayout);
+			mIndexSize = std::max(mIndexSize, model.indexSize);
+
+			model.firstSubmesh = static_cast<uint32>(mSubmeshes.size());
+			model.baseVertex = mVertexCount;
+			model.baseIndex = mIndexCount;
+			mFirstSubmeshes.push_back(model.firstSubmesh);
+
+			for (mesh::Submesh submesh : model.submeshes)
+			{
+				submesh.firstIndex += model.baseIndex;
+				submesh.vertexOffset += static_cast<int32>(model.baseVertex);
+
+				for (uint32 lod = 0; lod < submesh.lodCount; ++lod)
+				{
+					submesh.lods[lod].firstIndex += model.baseIndex;
+				}
+				mSubmeshes.push_back(submesh);
+			}
+
+			mVertexCount += model.vertexCount;
+			mIndexCount += model.indexCount;
+		}
+
+		mFirstSubmeshes.push_back(static_cast<uint32>(mSubmeshes.size()));
+
+		std::cout << "Loaded " << mModels.size() << " models with " << mSubmeshes.size() << " submeshes and " << mVertexCount <<
+			" vertices, " << mVertexLayout.getStride() << " bytes per vertex and " << 8 * mIndexSize << " bit indices!" << std::endl;
+	}
+
+	void SceneGeometry::release()
+	{
+		mModels.clear();
+	}
+
+	const render::VertexLayout& SceneGeometry::getVertexLayout() const
+	{
+		return mVertexLayout;
+	}
+
+	uint32 SceneGeometry::getIndexSize() const
+	{
+		return mIndexSize;
+	}
+
+	const std::vector<mesh::Submesh>& SceneGeometry::getSubmeshes() const
+	{
+		return mSubmeshes;
+	}
+
+	uint32 SceneGeometry::getFirstSubmesh(uint32 model) const
+	{
+		return mFirstSubmeshes[model];
+	}
+
+	uint32 SceneGeometry::getSubmeshCount(uint32 model) const
+	{
+		return mFirstSubmeshes[model + 1] - mFirstSubmeshes[model];
+	}
+
+	std::size_t SceneGeometry::getVertexDataSize() const
+	{
+		return (std::size_t)mVertexLayout.getStride() * mVertexCount;
+	}
+
+	std::size_t SceneGeometry::getIndexDataSize() const
+	{
+		return (std::size_t)mIndexSize * mIndexCount;
+	}
+
+	void SceneGeometry::copyVertices(void* pDestination) const
+	{
+		uint32 stride = mVertexLayout.getStride();
+		uint8* pArena = static_cast<uint8*>(pDestination);
+
+		mpJobSystem->parallelFor(mModels.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const Model& model = *mModels[i];
+				uint8* pTarget = pArena + (std::size_t)stride * model.baseVertex;
+
+				if (model.vertexLayout.getKey() == mVertexLayout.getKey())
+				{
+					std::memcpy(pTarget, model.pVertices, (std::size_t)stride * model.vertexCount);
+					continue;
+				}
+
+				//Quantized positions are relative to the bounds of their submesh, so submeshes are converted one by one.
+				const uint8* pSource = static_cast<const uint8*>(model.pVertices);
+				uint32 sourceStride = model.vertexLayout.getStride();
+
+				for (const mesh::Submesh& submesh : model.submeshes)
+				{
+					mVertexLayout.repack(model.vertexLayout, pSource + (std::size_t)sourceStride * submesh.vertexOffset, submesh.vertexCount,
+						submesh.bounds.min, submesh.bounds.max, pTarget + (std::size_t)stride * submesh.vertexOffset);
+				}
+			}
+		});
+	}
+
+	void SceneGeometry::copyIndices(void* pDestination) const
+	{
+		uint8* pArena = static_cast<uint8*>(pDestination);
+
+		mpJobSystem->parallelFor(mModels.size(), 1, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				const Model& model = *mModels[i];
+				uint8* pTarget = pArena + (std::size_t)mIndexSize * model.baseIndex;
+
+				if (model.indexSize == mIndexSize)
+				{
+					std::memcpy(pTarget, model.pIndices, (std::size_t)mIndexSize * model.indexCount);
+					continue;
+				}
+
+				//Only 16 bit models in a 32 bit arena are widened, the other way around never happens.
+				const uint16* pSource = static_cast<const uint16*>(model.pIndices);
+				uint32* pWide = reinterpret_cast<uint32*>(pTarget);
+
+				for (uint32 index = 0; index < model.indexCount; ++index)
+				{
+					pWide[index] = pSource[index];
+				}
+			}
+		});
+	}
+
+	void SceneGeometry::loadModel(const io::FileSystem& fileSystem, const std::string& path, const io::AssetManifest& manifest, thread::JobSystem& jobSystem,
+		Model& model)
+	{
+		//A model the asset cooker listed is opened as is, without reading the OBJ file.
+		std::string cookedPath;
+		uint64 cookedKey;
+		if (manifest.find(path, io::AssetKind::Mesh, cookedPath, cookedKey) && openCache(fileSystem, cookedPath, cookedKey, model))
+		{
+			return;
+		}
+
+		//The cooked mesh is keyed by the contents of the OBJ file, so an edited model is parsed again.
+		io::FileView source;
+		if (!fileSystem.open(path, source))
+		{
+			throw std::runtime_error("Failed to open model " + path + ".");
+		}
+
+		uint64 sourceKey = io::MeshCache::computeSourceKey(source);
+
+		std::string cachePath = path + ".qmesh";
+
+		if (openCache(fileSystem, cachePath, sourceKey, model))
+		{
+			return;
+		}
+
+		mesh::MeshCooker::cook(source, model.cooked, &jobSystem);
+		source.close();
+
+		if (mesh::MeshCooker::write(cachePath, sourceKey, model.cooked))
+		{
+			std::cout << "Successfully cooked model to " << cachePath << "!" << std::endl;
+		}
+		else
+		{
+			std::cout << "Failed to write mesh cache " << cachePath << ", the model is parsed again next start." << std::endl;
+		}
+
+		model.vertexLayout = model.cooked.vertexLayout;
+		model.indexSize = model.cooked.indexSize;
+		model.pVertices = model.cooked.vertices.data();
+		model.vertexCount = model.cooked.vertexCount;
+		model.pIndices = model.cooked.indices.data();
+		model.indexCount = static_cast<uint32>(model.cooked.indices.size() / model.cooked.indexSize);
+		model.submeshes = model.cooked.submeshes;
+	}
+
+	bool SceneGeometry::openCache(const io::FileSystem& fileSystem, const std::string& cachePath, uint64 sourceKey, Model& model)
+	{
+		//The vertex layout and index size of a cooked model come from its header.
+		if (!model.cache.open(fileSystem, cachePath, sourceKey, sizeof(mesh::Submesh)))
+		{
+			return false;
+		}
+
+		if (!render::VertexLayout::fromKey(model.cache.getVertexFormat(), model.vertexLayout) || model.vertexLayout.getStride() != model.cache.getVertexStride())
+		{
+			model.cache.close();
+			return false;
+		}
+
+		const mesh::Submesh* pSubmeshes = static_cast<const mesh::Submesh*>(model.cache.getSubmeshData());
+		model.submeshes.assign(pSubmeshes, pSubmeshes + model.cache.getSubmeshCount());
+
+		//The cache checked the full submeshes against the blobs, their levels of detail are only known here.
+		for (const mesh::Submesh& submesh : model.submeshes)
+		{
+			bool isValid = submesh.lodCount <= mesh::Submesh::MAX_LOD_COUNT;
+			for (uint32 lod = 0; isValid && lod < submesh.lodCount; ++lod)
+			{
+				isValid = (uint64)submesh.lods[lod].firstIndex + submesh.lods[lod].indexCount <= model.cache.getIndexCount();
+			}
+
+			if (!isValid)
+			{
+				model.submeshes.clear();
+				model.cache.close();
+				return false;
+			}
+		}
+
+		model.indexSize = model.cache.getIndexSize();
+		model.pVertices = model.cache.getVertexData();
+		model.vertexCount = model.cache.getVertexCount();
+		model.pIndices = model.cache.getIndexData();
+		model.indexCount = model.cache.getIndexCount();
+
+		std::cout << "Loaded " << model.submeshes.size() << " submeshes with " << model.vertexCount << " vertices from " << cachePath << "!" << std::endl;
+
+		return true;
+	}
+}
\ No newline at end of file
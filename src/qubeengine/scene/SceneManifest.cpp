@@ -0,0 +1,129 @@
+#include <qubeengine/scene/SceneManifest.h>
+
+#include <qubeengine/io/FileReader.h>
+#include <qubeengine/io/FileSystem.h>
+
+#include <sstream>
+#include <stdexcept>
+
+namespace qe::scene
+{
+	void SceneManifest::load(const io::FileSystem& fileSystem, const std::string& path)
+	{
+		io::FileView file;
+		if (!fileSystem.open(path, file))
+		{
+			throw std::runtime_error("Failed to open scene " + path + ".");
+		}
+
+		mModels.clear();
+		mInstances.clear();
+
+		io::FileReader reader(file);
+		std::string_view line;
+		uint32 lineNumber = 0;
+
+		while (reader.readLine(line))
+		{
+			++lineNumber;
+
+			std::istringstream stream{std::string(line)};
+			std::string statement;
+
+			if (!(stream >> statement) || statement[0] == '#')
+			{
+				continue;
+			}
+
+			auto fail = [&path, lineNumber](const std::string& reason)
+			{
+				throw std::runtime_error("Failed to load scene " + path + ", line " + std::to_string(lineNumber) + ": " + reason);
+			};
+
+			if (statement == "model")
+			{
+				SceneModel model;
+				if (!(stream >> model.name >> model.meshPath >> model.texturePath))
+				{
+					fail("expected model <name> <mesh path> <texture path>.");
+				}
+
+				for (const SceneModel& other : mModels)
+				{
+					if (other.name == model.name)
+					{
+						fail("model " + model.name + " is declared twice.");
+					}
+				}
+
+				mModels.push_back(model);
+			}
+			else if (statement == "instance")
+			{
+				std::string modelName;
+				SceneInstance instance = {};
+				instance.scale = 1.0f;
+
+				if (!(stream >> modelName >> instance.position.x >> instance.position.y >> instance.position.z))
+				{
+					fail("expected instance <model name> <x> <y> <z> [<rotation> [<scale>]].");
+				}
+
+				//Both optional values are read, a line that has them but not as numbers is an error.
+				if (!(stream >> instance.rotation))
+				{
+					instance.rotation = 0.0f;
+				}
+				else if (!(stream >> instance.scale))
+				{
+					instance.scale = 1.0f;
+				}
+
+				if (!stream.eof())
+				{
+					std::string rest;
+					stream.clear();
+					if (stream >> rest)
+					{
+						fail("unexpected " + rest + ".");
+					}
+				}
+
+				instance.model = static_cast<uint32>(mModels.size());
+				for (uint32 i = 0; i < mModels.size(); ++i)
+				{
+					if (mModels[i].name == modelName)
+					{
+						instance.model = i;
+					}
+				}
+
+				if (instance.model == mModels.size())
+				{
+					fail("unknown model " + modelName + ".");
+				}
+
+				mInstances.push_back(instance);
+			}
+			else
+			{
+				fail("unknown statement " + statement + ".");
+			}
+		}
+
+		if (mInstances.empty())
+		{
+			throw std::runtime_error("Failed to load scene " + path + ", it has no instances.");
+		}
+	}
+
+	const std::vector<SceneModel>& SceneManifest::getModels() const
+	{
+		return mModels;
+	}
+
+	const std::vector<SceneInstance>& SceneManifest::getInstances() const
+	{
+		return mInstances;
+	}
+}
\ No newline at end of file
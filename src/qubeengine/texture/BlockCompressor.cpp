@@ -0,0 +1,442 @@
+#include <qubeengine/texture/BlockCompressor.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace qe::texture
+{
+	//Block rows per job, a row of a 2048 texel wide level is 512 blocks.
+	static const std::size_t BLOCK_ROWS_PER_JOB = 4;
+
+	//Interpolation weights of the 16 palette entries of BC7 mode 6, in 64ths.
+	static const uint32 BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	//Writes the fields of a block from the lowest bit up, as BC7 stores them.
+	struct BlockWriter
+	{
+		uint8* pBytes;
+		uint32 position;
+
+		void write(uint32 value, uint32 bitCount)
+		{
+			for (uint32 i = 0; i < bitCount; ++i, ++position)
+			{
+				if ((value >> i) & 1)
+				{
+					pBytes[position >> 3] |= static_cast<uint8>(1 << (position & 7));
+				}
+			}
+		}
+	};
+
+	//Line through the first channelCount channels of a block along their principal axis, clipped to the
+	//projections of the texels. Flat blocks get the same color at both ends.
+	static inline void fitLine(const uint8* pBlock, uint32 channelCount, float ends[2][4])
+	{
+		float mean[4] = {};
+		float minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+		float maximum[4] = {};
+
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			for (uint32 c = 0; c < channelCount; ++c)
+			{
+				mean[c] += pBlock[4 * i + c] / 16.0f;
+				minimum[c] = std::min(minimum[c], static_cast<float>(pBlock[4 * i + c]));
+				maximum[c] = std::max(maximum[c], static_cast<float>(pBlock[4 * i + c]));
+			}
+		}
+
+		float covariance[4][4] = {};
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			for (uint32 row = 0; row < channelCount; ++row)
+			{
+				for (uint32 column = 0; column < channelCount; ++column)
+				{
+					covariance[row][column] += (pBlock[4 * i + row] - mean[row]) * (pBlock[4 * i + column] - mean[column]);
+				}
+			}
+		}
+
+		//Power iteration, starting along the diagonal of the bounding box.
+		float axis[4] = {};
+		for (uint32 c = 0; c < channelCount; ++c)
+		{
+			axis[c] = maximum[c] - minimum[c];
+		}
+
+		float length = 0.0f;
+		for (uint32 iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[4] = {};
+			for (uint32 row = 0; row < channelCount; ++row)
+			{
+				for (uint32 column = 0; column < channelCount; ++column)
+				{
+					next[row] += covariance[row][column] * axis[column];
+				}
+			}
+
+			length = 0.0f;
+			for (uint32 c = 0; c < channelCount; ++c)
+			{
+				length += next[c] * next[c];
+			}
+
+			length = std::sqrt(length);
+			if (length < 1e-6f)
+			{
+				break;
+			}
+
+			for (uint32 c = 0; c < channelCount; ++c)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+
+		float minProjection = 0.0f;
+		float maxProjection = 0.0f;
+		if (length >= 1e-6f)
+		{
+			minProjection = 1e9f;
+			maxProjection = -1e9f;
+
+			for (uint32 i = 0; i < 16; ++i)
+			{
+				float projection = 0.0f;
+				for (uint32 c = 0; c < channelCount; ++c)
+				{
+					projection += (pBlock[4 * i + c] - mean[c]) * axis[c];
+				}
+
+				minProjection = std::min(minProjection, projection);
+				maxProjection = std::max(maxProjection, projection);
+			}
+		}
+
+		for (uint32 c = 0; c < 4; ++c)
+		{
+			bool isFitted = c < channelCount;
+			ends[0][c] = isFitted ? std::clamp(mean[c] + minProjection * axis[c], 0.0f, 255.0f) : 255.0f;
+			ends[1][c] = isFitted ? std::clamp(mean[c] + maxProjection * axis[c], 0.0f, 255.0f) : 255.0f;
+		}
+	}
+
+	//Least squares ends for texels that sit at the given weights between them. Returns false if all texels
+	//picked the same weight.
+	static inline bool refitLine(const uint8* pBlock, uint32 channelCount, const float* pWeights, float ends[2][4])
+	{
+		float a = 0.0f;
+		float b = 0.0f;
+		float c = 0.0f;
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			a += (1.0f - pWeights[i]) * (1.0f - pWeights[i]);
+			b += (1.0f - pWeights[i]) * pWeights[i];
+			c += pWeights[i] * pWeights[i];
+		}
+
+		float determinant = a * c - b * b;
+		if (std::abs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+
+		for (uint32 channel = 0; channel < channelCount; ++channel)
+		{
+			float x = 0.0f;
+			float y = 0.0f;
+			for (uint32 i = 0; i < 16; ++i)
+			{
+				x += (1.0f - pWeights[i]) * pBlock[4 * i + channel];
+				y += pWeights[i] * pBlock[4 * i + channel];
+			}
+
+			ends[0][channel] = std::clamp((c * x - b * y) / determinant, 0.0f, 255.0f);
+			ends[1][channel] = std::clamp((a * y - b * x) / determinant, 0.0f, 255.0f);
+		}
+
+		return true;
+	}
+
+	//Quantizes the ends to RGB565 and writes a four color block. The ends are swapped if that is needed to
+	//select four color mode, pWeights receives the weight of the second end for every texel. Returns the
+	//squared error of the block.
+	static inline uint32 writeBc1(const uint8* pBlock, float ends[2][4], float* pWeights, uint8* pDestination)
+	{
+		uint16 colors[2];
+		for (uint32 e = 0; e < 2; ++e)
+		{
+			uint32 red = static_cast<uint32>(std::lround(ends[e][0] * 31.0f / 255.0f));
+			uint32 green = static_cast<uint32>(std::lround(ends[e][1] * 63.0f / 255.0f));
+			uint32 blue = static_cast<uint32>(std::lround(ends[e][2] * 31.0f / 255.0f));
+			colors[e] = static_cast<uint16>((red << 11) | (green << 5) | blue);
+		}
+
+		//Blocks with the larger color first have four palette entries, the others three and black.
+		if (colors[0] < colors[1])
+		{
+			std::swap(colors[0], colors[1]);
+			std::swap(ends[0], ends[1]);
+		}
+
+		int32 palette[4][3];
+		for (uint32 e = 0; e < 2; ++e)
+		{
+			uint32 red = colors[e] >> 11;
+			uint32 green = (colors[e] >> 5) & 0x3F;
+			uint32 blue = colors[e] & 0x1F;
+			palette[e][0] = static_cast<int32>((red << 3) | (red >> 2));
+			palette[e][1] = static_cast<int32>((green << 2) | (green >> 4));
+			palette[e][2] = static_cast<int32>((blue << 3) | (blue >> 2));
+		}
+
+		for (uint32 c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		//Equal colors only have the first entry.
+		uint32 paletteSize = colors[0] == colors[1] ? 1 : 4;
+		const float paletteWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+		uint32 indices = 0;
+		uint32 error = 0;
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			uint32 bestIndex = 0;
+			uint32 bestError = UINT32_MAX;
+
+			for (uint32 index = 0; index < paletteSize; ++index)
+			{
+				uint32 indexError = 0;
+				for (uint32 c = 0; c < 3; ++c)
+				{
+					int32 difference = palette[index][c] - pBlock[4 * i + c];
+					indexError += static_cast<uint32>(difference * difference);
+				}
+
+				if (indexError < bestError)
+				{
+					bestIndex = index;
+					bestError = indexError;
+				}
+			}
+
+			indices |= bestIndex << (2 * i);
+			pWeights[i] = paletteWeights[bestIndex];
+			error += bestError;
+		}
+
+		pDestination[0] = static_cast<uint8>(colors[0]);
+		pDestination[1] = static_cast<uint8>(colors[0] >> 8);
+		pDestination[2] = static_cast<uint8>(colors[1]);
+		pDestination[3] = static_cast<uint8>(colors[1] >> 8);
+		for (uint32 i = 0; i < 4; ++i)
+		{
+			pDestination[4 + i] = static_cast<uint8>(indices >> (8 * i));
+		}
+
+		return error;
+	}
+
+	//Quantizes the ends to 7 bits plus a shared low bit each and writes a mode 6 block. The ends are swapped
+	//if the first texel would otherwise need the high bit of its index, which the anchor does not store.
+	//pWeights receives the weight of the second end for every texel. Returns the squared error of the block.
+	static inline uint32 writeBc7(const uint8* pBlock, float ends[2][4], float* pWeights, uint8* pDestination)
+	{
+		uint32 values[2][4];
+		uint32 pBits[2];
+		for (uint32 e = 0; e < 2; ++e)
+		{
+			float bestError = 1e9f;
+			for (uint32 pBit = 0; pBit < 2; ++pBit)
+			{
+				uint32 candidate[4];
+				float candidateError = 0.0f;
+				for (uint32 c = 0; c < 4; ++c)
+				{
+					int32 quantized = std::clamp(static_cast<int32>(std::lround((ends[e][c] - pBit) / 2.0f)), 0, 127);
+					candidate[c] = (static_cast<uint32>(quantized) << 1) | pBit;
+					candidateError += (candidate[c] - ends[e][c]) * (candidate[c] - ends[e][c]);
+				}
+
+				if (candidateError < bestError)
+				{
+					bestError = candidateError;
+					std::memcpy(values[e], candidate, sizeof(candidate));
+					pBits[e] = pBit;
+				}
+			}
+		}
+
+		int32 palette[16][4];
+		for (uint32 index = 0; index < 16; ++index)
+		{
+			for (uint32 c = 0; c < 4; ++c)
+			{
+				palette[index][c] = static_cast<int32>(((64 - BC7_WEIGHTS[index]) * values[0][c] + BC7_WEIGHTS[index] * values[1][c] + 32) >> 6);
+			}
+		}
+
+		uint32 indices[16];
+		uint32 error = 0;
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			uint32 bestError = UINT32_MAX;
+
+			for (uint32 index = 0; index < 16; ++index)
+			{
+				uint32 indexError = 0;
+				for (uint32 c = 0; c < 4; ++c)
+				{
+					int32 difference = palette[index][c] - pBlock[4 * i + c];
+					indexError += static_cast<uint32>(difference * difference);
+				}
+
+				if (indexError < bestError)
+				{
+					indices[i] = index;
+					bestError = indexError;
+				}
+			}
+
+			error += bestError;
+		}
+
+		if (indices[0] >= 8)
+		{
+			std::swap(values[0], values[1]);
+			std::swap(pBits[0], pBits[1]);
+			std::swap(ends[0], ends[1]);
+
+			for (uint32 i = 0; i < 16; ++i)
+			{
+				indices[i] = 15 - indices[i];
+			}
+		}
+
+		std::memset(pDestination, 0, 16);
+		BlockWriter writer = { pDestination, 0 };
+		writer.write(1 << 6, 7);
+
+		for (uint32 c = 0; c < 4; ++c)
+		{
+			writer.write(values[0][c] >> 1, 7);
+			writer.write(values[1][c] >> 1, 7);
+		}
+
+		writer.write(pBits[0], 1);
+		writer.write(pBits[1], 1);
+
+		for (uint32 i = 0; i < 16; ++i)
+		{
+			writer.write(indices[i], i == 0 ? 3 : 4);
+			pWeights[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+		}
+
+		return error;
+	}
+
+	bool BlockCompressor::isCompressed(TextureFormat format)
+	{
+		return format != TextureFormat::Rgba8;
+	}
+
+	std::size_t BlockCompressor::getLevelSize(TextureFormat format, uint32 width, uint32 height)
+	{
+		if (!isCompressed(format))
+		{
+			return (std::size_t)4 * width * height;
+		}
+
+		std::size_t blockSize = format == TextureFormat::Bc1 ? 8 : 16;
+
+		return blockSize * ((width + 3) / 4) * ((height + 3) / 4);
+	}
+
+	void BlockCompressor::compress(TextureFormat format, const uint8* pPixels, uint32 width, uint32 height, uint8* pDestination,
+		thread::JobSystem* pJobSystem)
+	{
+		if (!isCompressed(format))
+		{
+			std::memcpy(pDestination, pPixels, getLevelSize(format, width, height));
+			return;
+		}
+
+		uint32 blocksX = (width + 3) / 4;
+		uint32 blocksY = (height + 3) / 4;
+		std::size_t blockSize = format == TextureFormat::Bc1 ? 8 : 16;
+
+		auto encodeRows = [&](std::size_t begin, std::size_t end)
+		{
+			uint8 block[64];
+
+			for (std::size_t blockY = begin; blockY < end; ++blockY)
+			{
+				for (uint32 blockX = 0; blockX < blocksX; ++blockX)
+				{
+					for (uint32 i = 0; i < 16; ++i)
+					{
+						std::size_t x = std::min(4 * blockX + (i & 3), width - 1);
+						std::size_t y = std::min(4 * static_cast<uint32>(blockY) + (i >> 2), height - 1);
+						std::memcpy(block + 4 * i, pPixels + 4 * (y * width + x), 4);
+					}
+
+					uint8* pBlockDestination = pDestination + (blockY * blocksX + blockX) * blockSize;
+					if (format == TextureFormat::Bc1)
+					{
+						encodeBc1(block, pBlockDestination);
+					}
+					else
+					{
+						encodeBc7(block, pBlockDestination);
+					}
+				}
+			}
+		};
+
+		if (pJobSystem && blocksY > BLOCK_ROWS_PER_JOB)
+		{
+			pJobSystem->parallelFor(blocksY, BLOCK_ROWS_PER_JOB, encodeRows);
+		}
+		else
+		{
+			encodeRows(0, blocksY);
+		}
+	}
+
+	void BlockCompressor::encodeBc1(const uint8* pBlock, uint8* pDestination)
+	{
+		float ends[2][4];
+		float weights[16];
+		fitLine(pBlock, 3, ends);
+		uint32 error = writeBc1(pBlock, ends, weights, pDestination);
+
+		uint8 refitted[8];
+		if (error > 0 && refitLine(pBlock, 3, weights, ends) && writeBc1(pBlock, ends, weights, refitted) < error)
+		{
+			std::memcpy(pDestination, refitted, sizeof(refitted));
+		}
+	}
+
+	void BlockCompressor::encodeBc7(const uint8* pBlock, uint8* pDestination)
+	{
+		float ends[2][4];
+		float weights[16];
+		fitLine(pBlock, 4, ends);
+		uint32 error = writeBc7(pBlock, ends, weights, pDestination);
+
+		uint8 refitted[16];
+		if (error > 0 && refitLine(pBlock, 4, weights, ends) && writeBc7(pBlock, ends, weights, refitted) < error)
+		{
+			std::memcpy(pDestination, refitted, sizeof(refitted));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include <qubeengine/texture/ImageDecoder.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <climits>
+#include <cstring>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <qubeengine/util/stb_image.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define QUBEENGINE_DECODE_SSSE3
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define QUBEENGINE_DECODE_SSSE3
+#endif
+
+namespace qe::texture
+{
+	//Rows per job, small images are expanded in one go.
+	static const std::size_t ROWS_PER_JOB = 64;
+
+	bool ImageDecoder::getInfo(const uint8* pSource, std::size_t sourceSize, uint32& width, uint32& height)
+	{
+		int x, y, channels;
+		if (sourceSize > INT_MAX || !stbi_info_from_memory(pSource, static_cast<int>(sourceSize), &x, &y, &channels))
+		{
+			return false;
+		}
+
+		width = static_cast<uint32>(x);
+		height = static_cast<uint32>(y);
+
+		return true;
+	}
+
+	bool ImageDecoder::decode(const uint8* pSource, std::size_t sourceSize, uint32 width, uint32 height, uint8* pDestination,
+		thread::JobSystem* pJobSystem)
+	{
+		if (sourceSize > INT_MAX)
+		{
+			return false;
+		}
+
+		int x, y, channels;
+		stbi_uc* pixels = stbi_load_from_memory(pSource, static_cast<int>(sourceSize), &x, &y, &channels, 0);
+
+		if (!pixels)
+		{
+			return false;
+		}
+
+		if (static_cast<uint32>(x) != width || static_cast<uint32>(y) != height)
+		{
+			stbi_image_free(pixels);
+			return false;
+		}
+
+		uint32 channelCount = static_cast<uint32>(channels);
+		auto expandRows = [&](std::size_t begin, std::size_t end)
+		{
+			expandToRgba(pixels + begin * width * channelCount, channelCount, (end - begin) * width, pDestination + begin * width * 4);
+		};
+
+		if (pJobSystem && height > ROWS_PER_JOB)
+		{
+			pJobSystem->parallelFor(height, ROWS_PER_JOB, expandRows);
+		}
+		else
+		{
+			expandRows(0, height);
+		}
+
+		stbi_image_free(pixels);
+
+		return true;
+	}
+
+	void ImageDecoder::expandToRgba(const uint8* pSource, uint32 channelCount, std::size_t texelCount, uint8* pDestination)
+	{
+		if (channelCount == 4)
+		{
+			std::memcpy(pDestination, pSource, 4 * texelCount);
+			return;
+		}
+
+		std::size_t i = 0;
+
+		if (channelCount == 3)
+		{
+#if defined(QUBEENGINE_DECODE_SSSE3)
+			//Every shuffle spreads the 12 bytes of four texels over 16 and leaves a zero where alpha goes. Loads
+			//are 16 bytes wide, so the loops stop while the last load still ends inside the source.
+#if defined(__AVX2__)
+			const __m256i shuffleWide = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+				0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			const __m256i alphaWide = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+			for (; i + 10 <= texelCount; i += 8)
+			{
+				__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + 3 * i));
+				__m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + 3 * i + 12));
+				__m256i texels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+
+				texels = _mm256_or_si256(_mm256_shuffle_epi8(texels, shuffleWide), alphaWide);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination + 4 * i), texels);
+			}
+#endif
+			const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+			const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+			for (; i + 6 <= texelCount; i += 4)
+			{
+				__m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + 3 * i));
+
+				texels = _mm_or_si128(_mm_shuffle_epi8(texels, shuffle), alpha);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + 4 * i), texels);
+			}
+#endif
+		}
+
+		for (; i < texelCount; ++i)
+		{
+			const uint8* pTexel = pSource + channelCount * i;
+			uint8* pTarget = pDestination + 4 * i;
+
+			//Grey and grey with alpha have one color channel, RGB has three.
+			bool isGrey = channelCount < 3;
+			pTarget[0] = pTexel[0];
+			pTarget[1] = isGrey ? pTexel[0] : pTexel[1];
+			pTarget[2] = isGrey ? pTexel[0] : pTexel[2];
+			pTarget[3] = channelCount == 2 ? pTexel[1] : 255;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <qubeengine/texture/MipChain.h>
+#include <qubeengine/thread/JobSystem.h>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define QUBEENGINE_MIP_SSE
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define QUBEENGINE_MIP_SSE
+#endif
+
+namespace qe::texture
+{
+	//Rows per job, small levels are filtered in one go.
+	static const std::size_t ROWS_PER_JOB = 64;
+
+	//sRGB conversions between 8 bit encoded and 16 bit linear values. toLinear has 32 bit entries so AVX2 can
+	//gather from it.
+	struct SrgbTables
+	{
+		uint32 toLinear[256];
+		uint8 toSrgb[65536];
+
+		SrgbTables()
+		{
+			for (uint32 i = 0; i < 256; ++i)
+			{
+				double value = i / 255.0;
+				double linear = value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+				toLinear[i] = static_cast<uint32>(std::lround(linear * 65535.0));
+			}
+
+			for (uint32 i = 0; i < 65536; ++i)
+			{
+				double linear = i / 65535.0;
+				double value = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+				toSrgb[i] = static_cast<uint8>(std::lround(std::clamp(value, 0.0, 1.0) * 255.0));
+			}
+		}
+	};
+
+	static inline const SrgbTables& getSrgbTables()
+	{
+		static const SrgbTables tables;
+		return tables;
+	}
+
+	//Average of a 2x2 block, columns first and rounded up like the SIMD averages.
+	static inline uint16 average(uint32 topLeft, uint32 bottomLeft, uint32 topRight, uint32 bottomRight)
+	{
+		uint32 left = (topLeft + bottomLeft + 1) >> 1;
+		uint32 right = (topRight + bottomRight + 1) >> 1;
+
+		return static_cast<uint16>((left + right + 1) >> 1);
+	}
+
+	uint32 MipChain::getLevelCount(uint32 width, uint32 height)
+	{
+		uint32 levelCount = 1;
+		for (uint32 extent = std::max(width, height); extent > 1; extent >>= 1)
+		{
+			++levelCount;
+		}
+
+		return levelCount;
+	}
+
+	uint32 MipChain::getLevelExtent(uint32 extent, uint32 level)
+	{
+		return std::max(extent >> level, 1u);
+	}
+
+	std::vector<std::size_t> MipChain::getLevelOffsets(uint32 width, uint32 height, uint32 levelCount)
+	{
+		std::vector<std::size_t> offsets(levelCount + 1, 0);
+
+		for (uint32 level = 0; level < levelCount; ++level)
+		{
+			offsets[level + 1] = offsets[level] + (std::size_t)4 * getLevelExtent(width, level) * getLevelExtent(height, level);
+		}
+
+		return offsets;
+	}
+
+	void MipChain::generate(uint8* pChain, uint32 width, uint32 height, uint32 levelCount, bool isSrgb, thread::JobSystem* pJobSystem)
+	{
+		if (levelCount <= 1)
+		{
+			return;
+		}
+
+		std::vector<std::size_t> offsets = getLevelOffsets(width, height, levelCount);
+
+		auto forRows = [&](uint32 rowCount, const std::function<void(std::size_t begin, std::size_t end)>& function)
+		{
+			if (pJobSystem && rowCount > ROWS_PER_JOB)
+			{
+				pJobSystem->parallelFor(rowCount, ROWS_PER_JOB, function);
+			}
+			else
+			{
+				function(0, rowCount);
+			}
+		};
+
+		//Level 0 in 16 bits per channel.
+		std::vector<uint16> source((std::size_t)4 * width * height);
+		std::vector<uint16> destination((std::size_t)4 * getLevelExtent(width, 1) * getLevelExtent(height, 1));
+
+		forRows(height, [&](std::size_t begin, std::size_t end)
+		{
+			decodeRows(pChain, width, source.data(), static_cast<uint32>(begin), static_cast<uint32>(end), isSrgb);
+		});
+
+		for (uint32 level = 1; level < levelCount; ++level)
+		{
+			uint32 sourceWidth = getLevelExtent(width, level - 1);
+			uint32 sourceHeight = getLevelExtent(height, level - 1);
+			uint32 levelWidth = getLevelExtent(width, level);
+			uint32 levelHeight = getLevelExtent(height, level);
+
+			forRows(levelHeight, [&](std::size_t begin, std::size_t end)
+			{
+				downsampleRows(source.data(), sourceWidth, sourceHeight, destination.data(), levelWidth, static_cast<uint32>(begin), static_cast<uint32>(end));
+				encodeRows(destination.data(), levelWidth, pChain + offsets[level], static_cast<uint32>(begin), static_cast<uint32>(end), isSrgb);
+			});
+
+			std::swap(source, destination);
+		}
+	}
+
+	void MipChain::downsampleRows(const uint16* pSource, uint32 sourceWidth, uint32 sourceHeight, uint16* pDestination, uint32 width,
+		uint32 beginRow, uint32 endRow)
+	{
+		for (uint32 y = beginRow; y < endRow; ++y)
+		{
+			//A source extent of 1 is not halved, the same row or column is used twice.
+			const uint16* pTop = pSource + (std::size_t)4 * sourceWidth * std::min(2 * y, sourceHeight - 1);
+			const uint16* pBottom = pSource + (std::size_t)4 * sourceWidth * std::min(2 * y + 1, sourceHeight - 1);
+			uint16* pTarget = pDestination + (std::size_t)4 * width * y;
+			uint32 x = 0;
+
+#if defined(QUBEENGINE_MIP_SSE)
+			if (sourceWidth > 1)
+			{
+#if defined(__AVX2__)
+				//Four target texels from eight source texels per row. Unpacking works within 128 bit lanes, so
+				//the results come out as 0, 2, 1, 3 and are put back in order with one permute.
+				for (; x + 4 <= width; x += 4)
+				{
+					__m256i topA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pTop + 8 * x));
+					__m256i topB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pTop + 8 * x + 16));
+					__m256i bottomA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBottom + 8 * x));
+					__m256i bottomB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pBottom + 8 * x + 16));
+
+					__m256i verticalA = _mm256_avg_epu16(topA, bottomA);
+					__m256i verticalB = _mm256_avg_epu16(topB, bottomB);
+					__m256i result = _mm256_avg_epu16(_mm256_unpacklo_epi64(verticalA, verticalB), _mm256_unpackhi_epi64(verticalA, verticalB));
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(pTarget + 4 * x), _mm256_permute4x64_epi64(result, 0xD8));
+				}
+#endif
+				//Two target texels from four source texels per row.
+				for (; x + 2 <= width; x += 2)
+				{
+					__m128i topA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pTop + 8 * x));
+					__m128i topB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pTop + 8 * x + 8));
+					__m128i bottomA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBottom + 8 * x));
+					__m128i bottomB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pBottom + 8 * x + 8));
+
+					__m128i verticalA = _mm_avg_epu16(topA, bottomA);
+					__m128i verticalB = _mm_avg_epu16(topB, bottomB);
+					__m128i result = _mm_avg_epu16(_mm_unpacklo_epi64(verticalA, verticalB), _mm_unpackhi_epi64(verticalA, verticalB));
+
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget + 4 * x), result);
+				}
+			}
+#endif
+			for (; x < width; ++x)
+			{
+				uint32 left = 4 * std::min(2 * x, sourceWidth - 1);
+				uint32 right = 4 * std::min(2 * x + 1, sourceWidth - 1);
+
+				for (uint32 channel = 0; channel < 4; ++channel)
+				{
+					pTarget[4 * x + channel] = average(pTop[left + channel], pBottom[left + channel], pTop[right + channel], pBottom[right + channel]);
+				}
+			}
+		}
+	}
+
+	void MipChain::decodeRows(const uint8* pSource, uint32 width, uint16* pDestination, uint32 beginRow, uint32 endRow, bool isSrgb)
+	{
+		const SrgbTables& tables = getSrgbTables();
+		std::size_t i = (std::size_t)4 * width * beginRow;
+		std::size_t end = (std::size_t)4 * width * endRow;
+
+#if defined(__AVX2__)
+		//Four texels at a time. The colors are gathered from the table and alpha, widened like the channels of
+		//linear images, is blended over the fourth channel of each texel.
+		if (isSrgb)
+		{
+			const __m256i toWide = _mm256_set1_epi16(257);
+
+			for (; i + 16 <= end; i += 16)
+			{
+				__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+
+				__m256i low = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.toLinear), _mm256_cvtepu8_epi32(bytes), 4);
+				__m256i high = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.toLinear), _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)), 4);
+				__m256i colors = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+				__m256i alphas = _mm256_mullo_epi16(_mm256_cvtepu8_epi16(bytes), toWide);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination + i), _mm256_blend_epi16(colors, alphas, 0x88));
+			}
+		}
+#endif
+#if defined(QUBEENGINE_MIP_SSE)
+		//A byte next to itself is the byte times 257, which maps 255 to 65535.
+		if (!isSrgb)
+		{
+			for (; i + 16 <= end; i += 16)
+			{
+				__m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + i), _mm_unpacklo_epi8(bytes, bytes));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + i + 8), _mm_unpackhi_epi8(bytes, bytes));
+			}
+		}
+#endif
+		for (; i < end; ++i)
+		{
+			bool isColor = (i & 3) != 3;
+			pDestination[i] = isSrgb && isColor ? static_cast<uint16>(tables.toLinear[pSource[i]]) : static_cast<uint16>(pSource[i] * 257);
+		}
+	}
+
+	void MipChain::encodeRows(const uint16* pSource, uint32 width, uint8* pDestination, uint32 beginRow, uint32 endRow, bool isSrgb)
+	{
+		const SrgbTables& tables = getSrgbTables();
+
+		for (std::size_t i = (std::size_t)4 * width * beginRow; i < (std::size_t)4 * width * endRow; ++i)
+		{
+			bool isColor = (i & 3) != 3;
+			pDestination[i] = isSrgb && isColor ? tables.toSrgb[pSource[i]] : static_cast<uint8>((pSource[i] * 255u + 32767u) / 65535u);
+		}
+	}
+}
\ No newline at end of file
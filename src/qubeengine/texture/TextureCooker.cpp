@@ -0,0 +1,62 @@
+#include <qubeengine/texture/TextureCooker.h>
+#include <qubeengine/io/TextureCache.h>
+#include <qubeengine/texture/ImageDecoder.h>
+#include <qubeengine/texture/MipChain.h>
+
+namespace qe::texture
+{
+	bool TextureCooker::cook(const uint8* pSource, std::size_t sourceSize, TextureFormat format, CookedTexture& texture,
+		thread::JobSystem* pJobSystem)
+	{
+		if (!ImageDecoder::getInfo(pSource, sourceSize, texture.width, texture.height))
+		{
+			return false;
+		}
+
+		texture.format = format;
+		texture.levelCount = MipChain::getLevelCount(texture.width, texture.height);
+
+		//The uncompressed chain is built first, then every level is encoded into its place in the texture.
+		//The image is decoded straight into level 0.
+		std::vector<std::size_t> chainOffsets = MipChain::getLevelOffsets(texture.width, texture.height, texture.levelCount);
+		std::vector<uint8> chain(chainOffsets.back());
+
+		if (!ImageDecoder::decode(pSource, sourceSize, texture.width, texture.height, chain.data(), pJobSystem))
+		{
+			return false;
+		}
+
+		MipChain::generate(chain.data(), texture.width, texture.height, texture.levelCount, true, pJobSystem);
+
+		texture.levelOffsets.assign(texture.levelCount + 1, 0);
+		for (uint32 level = 0; level < texture.levelCount; ++level)
+		{
+			std::size_t size = BlockCompressor::getLevelSize(format, MipChain::getLevelExtent(texture.width, level), 
+				MipChain::getLevelExtent(texture.height, level));
+			std::size_t end = texture.levelOffsets[level] + size;
+
+			texture.levelOffsets[level + 1] = level + 1 < texture.levelCount ? (end + LEVEL_ALIGNMENT - 1) & ~(LEVEL_ALIGNMENT - 1) : end;
+		}
+
+		texture.data.resize(texture.levelOffsets.back());
+		for (uint32 level = 0; level < texture.levelCount; ++level)
+		{
+			BlockCompressor::compress(format, chain.data() + chainOffsets[level], MipChain::getLevelExtent(texture.width, level), 
+				MipChain::getLevelExtent(texture.height, level), texture.data.data() + texture.levelOffsets[level], pJobSystem);
+		}
+
+		return true;
+	}
+	bool TextureCooker::write(const std::string& path, uint64 sourceKey, const CookedTexture& texture)
+	{
+		io::TextureCache::Contents contents = {};
+		contents.format = static_cast<uint32>(texture.format);
+		contents.width = texture.width;
+		contents.height = texture.height;
+		contents.levelCount = texture.levelCount;
+		contents.pData = texture.data.data();
+		contents.pLevelOffsets = texture.levelOffsets.data();
+
+		return io::TextureCache::write(path, sourceKey, contents);
+	}
+}
\ No newline at end of file
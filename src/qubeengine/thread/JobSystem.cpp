@@ -0,0 +1,133 @@
+#include <qubeengine/thread/JobSystem.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace qe::thread
+{
+	JobSystem::JobSystem(uint32 threadCount)
+	{
+		if (threadCount == 0)
+		{
+			uint32 hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		mWorkers.reserve(threadCount);
+
+		for (uint32 i = 0; i < threadCount; ++i)
+		{
+			mWorkers.emplace_back(&JobSystem::workerLoop, this);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mIsStopping = true;
+		}
+
+		mCondition.notify_all();
+
+		for (std::thread& worker : mWorkers)
+		{
+			worker.join();
+		}
+	}
+
+	void JobSystem::parallelFor(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t begin, std::size_t end)>& function)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		grainSize = std::max<std::size_t>(grainSize, 1);
+		std::size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+		if (chunkCount == 1 || mWorkers.empty())
+		{
+			function(0, count);
+			return;
+		}
+
+		struct LoopState
+		{
+			std::atomic<std::size_t> nextChunk = 0;
+			std::atomic<std::size_t> finishedChunks = 0;
+			std::mutex mutex;
+			std::condition_variable condition;
+		};
+
+		//Helpers that only get picked up after the loop is done find no chunks left and never touch 
+		//the function, so only the counters have to outlive this call.
+		std::shared_ptr<LoopState> pState = std::make_shared<LoopState>();
+
+		auto runChunks = [pState, &function, count, grainSize, chunkCount]()
+		{
+			std::size_t chunk;
+			while ((chunk = pState->nextChunk.fetch_add(1)) < chunkCount)
+			{
+				std::size_t begin = chunk * grainSize;
+				function(begin, std::min(begin + grainSize, count));
+
+				if (pState->finishedChunks.fetch_add(1) + 1 == chunkCount)
+				{
+					std::lock_guard<std::mutex> lock(pState->mutex);
+					pState->condition.notify_all();
+				}
+			}
+		};
+
+		std::size_t helperCount = std::min<std::size_t>(mWorkers.size(), chunkCount - 1);
+		for (std::size_t i = 0; i < helperCount; ++i)
+		{
+			enqueue(runChunks);
+		}
+
+		runChunks();
+
+		std::unique_lock<std::mutex> lock(pState->mutex);
+		pState->condition.wait(lock, [&pState, chunkCount]() { return pState->finishedChunks.load() == chunkCount; });
+	}
+
+	uint32 JobSystem::getThreadCount() const
+	{
+		return static_cast<uint32>(mWorkers.size());
+	}
+
+	void JobSystem::enqueue(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mJobs.push_back(std::move(job));
+		}
+
+		mCondition.notify_one();
+	}
+
+	void JobSystem::workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> job;
+
+			{
+				std::unique_lock<std::mutex> lock(mMutex);
+				mCondition.wait(lock, [this]() { return mIsStopping || !mJobs.empty(); });
+
+				//Drain the queue before stopping so no future is left without a value.
+				if (mJobs.empty())
+				{
+					return;
+				}
+
+				job = std::move(mJobs.front());
+				mJobs.pop_front();
+			}
+
+			job();
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include <qubeengine/util/Lz4.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace qe::util
+{
+	static inline uint32 read32(const uint8* pSource)
+	{
+		uint32 value;
+		std::memcpy(&value, pSource, sizeof(uint32));
+
+		return value;
+	}
+
+	//Lengths of 15 and more continue in bytes of 255 after the token, ended by one below 255.
+	static inline bool readLength(const uint8*& pSource, const uint8* pEnd, std::size_t& length)
+	{
+		uint8 value;
+		do
+		{
+			if (pSource == pEnd)
+			{
+				return false;
+			}
+
+			value = *pSource++;
+			length += value;
+		} while (value == 255);
+
+		return true;
+	}
+
+	std::size_t Lz4::getMaxCompressedSize(std::size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	std::size_t Lz4::compress(const uint8* pSource, std::size_t size, uint8* pDestination)
+	{
+		uint8* pOutput = pDestination;
+		std::size_t anchor = 0;
+
+		auto writeSequence = [&](std::size_t literalLength, std::size_t matchLength, std::size_t offset)
+		{
+			uint8* pToken = pOutput++;
+			*pToken = static_cast<uint8>(std::min<std::size_t>(literalLength, 15) << 4);
+
+			if (literalLength >= 15)
+			{
+				pOutput = writeLength(pOutput, literalLength - 15);
+			}
+
+			std::memcpy(pOutput, pSource + anchor, literalLength);
+			pOutput += literalLength;
+
+			if (matchLength == 0)
+			{
+				return;
+			}
+
+			pOutput[0] = static_cast<uint8>(offset);
+			pOutput[1] = static_cast<uint8>(offset >> 8);
+			pOutput += 2;
+
+			*pToken |= static_cast<uint8>(std::min<std::size_t>(matchLength - MIN_MATCH, 15));
+			if (matchLength - MIN_MATCH >= 15)
+			{
+				pOutput = writeLength(pOutput, matchLength - MIN_MATCH - 15);
+			}
+		};
+
+		//Every position is hashed by its first four bytes, the table remembers the last one for each hash.
+		//The first position that matches the bytes at its candidate is copied from there, as far as it goes.
+		if (size > MATCH_LIMIT)
+		{
+			std::vector<uint32> table(std::size_t(1) << HASH_BITS, 0);
+			std::size_t matchEnd = size - LAST_LITERALS;
+
+			for (std::size_t i = 0; i < size - MATCH_LIMIT;)
+			{
+				uint32 sequence = read32(pSource + i);
+				uint32 hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+				std::size_t candidate = table[hash];
+				table[hash] = static_cast<uint32>(i);
+
+				if (candidate >= i || i - candidate > MAX_OFFSET || read32(pSource + candidate) != sequence)
+				{
+					++i;
+					continue;
+				}
+
+				std::size_t length = MIN_MATCH;
+				while (i + length < matchEnd && pSource[candidate + length] == pSource[i + length])
+				{
+					++length;
+				}
+
+				writeSequence(i - anchor, length, i - candidate);
+				i += length;
+				anchor = i;
+			}
+		}
+
+		writeSequence(size - anchor, 0, 0);
+
+		return static_cast<std::size_t>(pOutput - pDestination);
+	}
+
+	bool Lz4::decompress(const uint8* pSource, std::size_t sourceSize, uint8* pDestination, std::size_t destinationSize)
+	{
+		const uint8* pEnd = pSource + sourceSize;
+		uint8* pOutput = pDestination;
+		uint8* pOutputEnd = pDestination + destinationSize;
+
+		while (pSource < pEnd)
+		{
+			uint8 token = *pSource++;
+
+			std::size_t literalLength = token >> 4;
+			if (literalLength == 15 && !readLength(pSource, pEnd, literalLength))
+			{
+				return false;
+			}
+
+			if (literalLength > static_cast<std::size_t>(pEnd - pSource) || literalLength > static_cast<std::size_t>(pOutputEnd - pOutput))
+			{
+				return false;
+			}
+
+			std::memcpy(pOutput, pSource, literalLength);
+			pOutput += literalLength;
+			pSource += literalLength;
+
+			//The last sequence has literals only.
+			if (pSource == pEnd)
+			{
+				break;
+			}
+
+			if (pEnd - pSource < 2)
+			{
+				return false;
+			}
+
+			std::size_t offset = pSource[0] | (static_cast<std::size_t>(pSource[1]) << 8);
+			pSource += 2;
+
+			std::size_t matchLength = token & 15;
+			if (matchLength == 15 && !readLength(pSource, pEnd, matchLength))
+			{
+				return false;
+			}
+
+			matchLength += MIN_MATCH;
+
+			if (offset == 0 || offset > static_cast<std::size_t>(pOutput - pDestination) || matchLength > static_cast<std::size_t>(pOutputEnd - pOutput))
+			{
+				return false;
+			}
+
+			//Copies closer than their length repeat what they just wrote, those go byte by byte.
+			const uint8* pMatch = pOutput - offset;
+			if (offset >= matchLength)
+			{
+				std::memcpy(pOutput, pMatch, matchLength);
+			}
+			else
+			{
+				for (std::size_t i = 0; i < matchLength; ++i)
+				{
+					pOutput[i] = pMatch[i];
+				}
+			}
+
+			pOutput += matchLength;
+		}
+
+		return pOutput == pOutputEnd;
+	}
+
+	uint8* Lz4::writeLength(uint8* pDestination, std::size_t length)
+	{
+		for (; length >= 255; length -= 255)
+		{
+			*pDestination++ = 255;
+		}
+
+		*pDestination++ = static_cast<uint8>(length);
+
+		return pDestination;
+	}
+}
\ No newline at end of file
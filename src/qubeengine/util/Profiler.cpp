@@ -0,0 +1,141 @@
+#include <qubeengine/util/Profiler.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace qe::util
+{
+	double Profiler::now()
+	{
+		static const std::chrono::steady_clock::time_point sStart = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sStart).count();
+	}
+
+	uint32 Profiler::addTrack(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mTracks.push_back(name);
+
+		return static_cast<uint32>(mTracks.size() - 1);
+	}
+
+	uint32 Profiler::getThreadTrack()
+	{
+		static std::atomic<uint32> sThreadCount{ 0 };
+		thread_local uint32 tTrack = addTrack("CPU Thread " + std::to_string(sThreadCount++));
+
+		return tTrack;
+	}
+
+	void Profiler::beginCapture()
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mZones.clear();
+		mIsCapturing = true;
+	}
+
+	bool Profiler::endCapture(const std::string& path)
+	{
+		std::vector<Zone> zones;
+		std::vector<std::string> tracks;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mIsCapturing = false;
+			zones.swap(mZones);
+			tracks = mTracks;
+		}
+
+		std::string json = "{\"traceEvents\":[";
+		const char* pSeparator = "\n";
+		char number[64];
+
+		//Metadata events name the tracks, every track is a thread of the same process.
+		for (std::size_t i = 0; i < tracks.size(); ++i)
+		{
+			json += pSeparator;
+			json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(i) + ",\"args\":{\"name\":\"";
+			writeEscaped(json, tracks[i]);
+			json += "\"}}";
+			pSeparator = ",\n";
+		}
+
+		for (const Zone& zone : zones)
+		{
+			json += pSeparator;
+			json += "{\"name\":\"";
+			writeEscaped(json, zone.name);
+			std::snprintf(number, sizeof(number), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", zone.start, zone.duration);
+			json += number;
+			json += ",\"pid\":1,\"tid\":" + std::to_string(zone.track) + "}";
+			pSeparator = ",\n";
+		}
+
+		json += "\n]}";
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "Failed to write profiler trace to " << path << "." << std::endl;
+			return false;
+		}
+
+		file << json;
+		std::cout << "Successfully wrote " << zones.size() << " profiler zones to " << path << "!" << std::endl;
+
+		return true;
+	}
+
+	bool Profiler::isCapturing() const
+	{
+		return mIsCapturing;
+	}
+
+	void Profiler::addZone(const std::string& name, uint32 track, double start, double duration)
+	{
+		if (!mIsCapturing)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mZones.push_back({ name, track, start, duration });
+	}
+
+	void Profiler::writeEscaped(std::string& out, const std::string& text)
+	{
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				out += '\\';
+			}
+			out += c;
+		}
+	}
+
+	ProfileZone::ProfileZone(const char* pName, double* pElapsed) :
+		mpName(pName),
+		mpElapsed(pElapsed),
+		mStart(Profiler::now())
+	{
+	}
+
+	ProfileZone::~ProfileZone()
+	{
+		double duration = Profiler::now() - mStart;
+
+		if (mpElapsed)
+		{
+			*mpElapsed = duration;
+		}
+
+		Profiler& profiler = Profiler::instance();
+		if (profiler.isCapturing())
+		{
+			profiler.addZone(mpName, profiler.getThreadTrack(), mStart, duration);
+		}
+	}
+}
\ No newline at end of file
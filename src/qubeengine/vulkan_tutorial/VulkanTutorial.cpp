@@ -2,17 +2,17 @@
 #include <stdexcept>
 #include <algorithm> //min and max functions
 #include <cstdint> //Necessary for UINT32_MAX
+#include <cstdio>
 #include <iostream>
 #include <map>
 #include <set>
-#include <fstream>
-#include <unordered_map>
+#include <limits>
+#include <cmath>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <qubeengine/util/stb_image.h>
+#include <glm/gtc/matrix_access.hpp>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <qubeengine/util/tiny_obj_loader.h>
+#include <qubeengine/io/ResourceLocator.h>
+#include <qubeengine/texture/MipChain.h>
 
 namespace qe
 {
@@ -51,9 +51,11 @@ namespace qe
 		return VK_FALSE;
 	}
 
-	VulkanTutorial::VulkanTutorial() :
+	VulkanTutorial::VulkanTutorial(uint32 framesInFlight) :
 		mValidationLayers(std::vector<const char*> { "VK_LAYER_KHRONOS_validation" }),
-		mDeviceExtensions(std::vector<const char*> { VK_KHR_SWAPCHAIN_EXTENSION_NAME })
+		mDeviceExtensions(std::vector<const char*> { VK_KHR_SWAPCHAIN_EXTENSION_NAME }),
+		mFramesInFlight(std::clamp(framesInFlight, 1u, MAX_FRAMES_IN_FLIGHT)),
+		mpJobSystem(std::make_unique<thread::JobSystem>())
 	{}
 	void VulkanTutorial::run()
 	{
@@ -71,10 +73,16 @@ namespace qe
 		cleanupSwapchain();
 
 		vkDestroySampler(mDevice, mTextureSampler, nullptr);
-		vkDestroyImageView(mDevice, mTextureImageView, nullptr);
+		mpAssetManager.reset();
+		mpShaderLibrary.reset();
 
-		vkDestroyImage(mDevice, mTextureImage, nullptr);
-		vkFreeMemory(mDevice, mTextureImageMemory, nullptr);
+		if (mpBindlessTextures)
+		{
+			mpBindlessTextures.reset();
+			vkDestroyImageView(mDevice, mFallbackTextureImageView, nullptr);
+			vkDestroyImage(mDevice, mFallbackTextureImage, nullptr);
+			vkFreeMemory(mDevice, mFallbackTextureImageMemory, nullptr);
+		}
 
 		vkDestroyDescriptorSetLayout(mDevice, mDescriptorSetLayout, nullptr);
 
@@ -84,15 +92,33 @@ namespace qe
 		vkDestroyBuffer(mDevice, mVertexBuffer, nullptr);
 		vkFreeMemory(mDevice, mVertexBufferMemory, nullptr);
 
-		for (std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		vkDestroyBuffer(mDevice, mDrawCommandTemplateBuffer, nullptr);
+		vkFreeMemory(mDevice, mDrawCommandTemplateBufferMemory, nullptr);
+
+		vkDestroyBuffer(mDevice, mMeshBuffer, nullptr);
+		vkFreeMemory(mDevice, mMeshBufferMemory, nullptr);
+
+		vkDestroyBuffer(mDevice, mInstanceBuffer, nullptr);
+		vkFreeMemory(mDevice, mInstanceBufferMemory, nullptr);
+
+		for (std::size_t i = 0; i < mFramesInFlight; ++i)
 		{
 			vkDestroySemaphore(mDevice, mRenderFinishedSemaphores[i], nullptr);
 			vkDestroySemaphore(mDevice, mImageAvailableSemaphores[i], nullptr);
-			vkDestroyFence(mDevice, mInFlightFences[i], nullptr);
 		}
 
 		vkDestroyCommandPool(mDevice, mCommandPool, nullptr);
 
+		if (!mpPipelineCache->save())
+		{
+			std::cout << "Failed to save the pipeline cache, pipelines are compiled again next start." << std::endl;
+		}
+		mpPipelineCache.reset();
+
+		mpUploadQueue.reset();
+		mpTransferTimeline.reset();
+		mpGraphicsTimeline.reset();
+		mpDescriptorAllocator.reset();
 		vkDestroyDevice(mDevice, nullptr);
 
 		if (ENABLE_VAL_LAYERS)
@@ -118,7 +144,9 @@ namespace qe
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "Qube Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		//1.2 for descriptor indexing (bindless textures). Devices that only support 1.0 still work, they
+		//just fall back to the single texture binding.
+		appInfo.apiVersion = VK_API_VERSION_1_2;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -156,7 +184,10 @@ namespace qe
 	}
 	void VulkanTutorial::initVulkan()
 	{
-		initResPaths();
+		loadScene();
+		//The models are loaded in parallel on the job system while the device is set up, the textures 
+		//stream in once the device exists.
+		std::future<void> sceneLoading = mpJobSystem->submit([this]() { loadSceneGeometry(); });
 		createInstance();
 		setupDebugMessenger();
 		createSurface();
@@ -164,20 +195,34 @@ namespace qe
 		createLogicalDevice();
 		createSwapChain();
 		createImageViews();
-		createRenderPass();
 		createDescriptorSetLayout();
-		createGraphicsPipeline();
 		createCommandPool();
-		createDepthResources();
-		createFramebuffers();
-		createTextureImage();
-		createTextureImageView();
+		createPipelineCache();
 		createTextureSampler();
-		loadModel();
+		createAssetManager();
+		createBindlessTextures();
+		sceneLoading.get();
 		createVertexBuffer();
 		createIndexBuffer();
+		//Both arenas were copied into staging memory, the models are not needed on the CPU anymore.
+		mSceneGeometry.release();
+		createSceneInstances();
+		createInstanceBuffers();
+		if (!mpBindlessTextures)
+		{
+			for (asset::TextureHandle handle : mModelTextures)
+			{
+				mpAssetManager->finishLoading(handle);
+			}
+		}
+		//Submit every upload recorded above in one batch. The first frame is submitted after it, so it 
+		//already sees the acquired resources.
+		mpUploadQueue->flush();
+		buildSceneBvh();
 		createUniformBuffers();
-		createDescriptorPool();
+		createCullingBuffers();
+		createRenderGraph();
+		createGraphicsPipeline();
 		createDescriptorSets();
 		createCommandBuffers();
 		createSyncObjects();
@@ -218,7 +263,8 @@ namespace qe
 		
 				if (ticks % TICKS_PER_SECOND == 0)
 				{
-					std::cout << "Ticks: " << std::to_string(TICKS_PER_SECOND) + " | FPS: " + std::to_string(frames) << std::endl;
+					std::cout << "Ticks: " << std::to_string(TICKS_PER_SECOND) + " | FPS: " + std::to_string(frames) << 
+						getFrameStatsReport() << std::endl;
 					frames = 0;
 				}
 		
@@ -229,10 +275,17 @@ namespace qe
 			}
 		
 			++frames;
+			updateShaders();
 			drawFrame();
 		}
 		
 		vkDeviceWaitIdle(mDevice);
+		collectRebuiltPipelines(true);
+
+		if (util::Profiler::instance().isCapturing())
+		{
+			toggleTraceCapture();
+		}
 	}
 	bool VulkanTutorial::validateRequiredInstanceExtensionSupport(const std::vector<const char*>& requiredExtensions)
 	{
@@ -388,6 +441,25 @@ namespace qe
 			++i;
 		}
 
+		//A family that can copy but not draw or dispatch is usually a DMA engine that runs alongside the 
+		//graphics queue. Failing that, take any non-graphics family that can transfer.
+		for (uint32 family = 0; family < queueFamilyCount; ++family)
+		{
+			VkQueueFlags flags = queueFamilies[family].queueFlags;
+			if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				if (!(flags & VK_QUEUE_COMPUTE_BIT))
+				{
+					indices.transferFamily = family;
+					break;
+				}
+				else if (!indices.transferFamily.has_value())
+				{
+					indices.transferFamily = family;
+				}
+			}
+		}
+
 		//std::cout << std::boolalpha << graphicsFamily.has_value() << std::endl;//false
 		//graphicsFamily = 0;
 		//std::cout << std::boolalpha << graphicsFamily.has_value() << std::endl;//true
@@ -476,6 +548,12 @@ namespace qe
 			return 0;
 		}
 
+		//Frame pacing is built on timeline semaphores.
+		if (!render::QueueTimeline::isSupported(device))
+		{
+			return 0;
+		}
+
 		return score;
 	}
 	
@@ -486,6 +564,8 @@ namespace qe
 
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		std::set<uint32> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+		uint32 transferFamily = indices.transferFamily.value_or(indices.graphicsFamily.value());
+		uniqueQueueFamilies.insert(transferFamily);
 
 		float queuePriority = 1.0f;
 		for (uint32 queueFamily : uniqueQueueFamilies)
@@ -498,18 +578,58 @@ namespace qe
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(mPhysicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		//Will add features we're gonna use here in the future.
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+		//Both are optional. Without them every mesh gets its own indirect draw and the visible instance 
+		//offset is passed through push constants instead of firstInstance.
+		mSupportsMultiDrawIndirect = supportedFeatures.multiDrawIndirect && supportedFeatures.drawIndirectFirstInstance;
+		deviceFeatures.multiDrawIndirect = mSupportsMultiDrawIndirect ? VK_TRUE : VK_FALSE;
+		deviceFeatures.drawIndirectFirstInstance = mSupportsMultiDrawIndirect ? VK_TRUE : VK_FALSE;
+
+		//Textures are cooked to BC7 when the device can sample it, RGBA8 otherwise.
+		mSupportsTextureCompression = supportedFeatures.textureCompressionBC;
+		deviceFeatures.textureCompressionBC = mSupportsTextureCompression ? VK_TRUE : VK_FALSE;
+
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 		createInfo.queueCreateInfoCount = static_cast<uint32>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
-		createInfo.pEnabledFeatures = &deviceFeatures;
 
-		createInfo.enabledExtensionCount = static_cast<uint32>(mDeviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = mDeviceExtensions.data();
+		//Timeline semaphores and descriptor indexing can only be enabled through the features2 chain, 
+		//which replaces pEnabledFeatures.
+		VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+		render::QueueTimeline::fillFeatures(timelineFeatures);
+
+		VkPhysicalDeviceFeatures2 deviceFeatures2 = {};
+		deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		deviceFeatures2.pNext = &timelineFeatures;
+		deviceFeatures2.features = deviceFeatures;
+
+		mSupportsBindless = render::BindlessTextureTable::isSupported(mPhysicalDevice);
+
+		VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+		if (mSupportsBindless)
+		{
+			render::BindlessTextureTable::fillFeatures(indexingFeatures);
+			timelineFeatures.pNext = &indexingFeatures;
+		}
+
+		createInfo.pNext = &deviceFeatures2;
+		createInfo.pEnabledFeatures = nullptr;
+
+		std::vector<const char*> deviceExtensions = mDeviceExtensions;
+		if (render::QueueTimeline::requiresExtension(mPhysicalDevice))
+		{
+			deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		}
+
+		createInfo.enabledExtensionCount = static_cast<uint32>(deviceExtensions.size());
+		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 		if (ENABLE_VAL_LAYERS)
 		{
@@ -533,6 +653,21 @@ namespace qe
 
 		vkGetDeviceQueue(mDevice, indices.graphicsFamily.value(), 0, &mGraphicsQueue);
 		vkGetDeviceQueue(mDevice, indices.presentFamily.value(), 0, &mPresentQueue);
+		vkGetDeviceQueue(mDevice, transferFamily, 0, &mTransferQueue);
+
+		//One timeline per queue that work is submitted to. Without a dedicated transfer family uploads 
+		//share the graphics timeline.
+		mpGraphicsTimeline = std::make_unique<render::QueueTimeline>(mDevice, mGraphicsQueue);
+		if (mTransferQueue != mGraphicsQueue)
+		{
+			mpTransferTimeline = std::make_unique<render::QueueTimeline>(mDevice, mTransferQueue);
+		}
+
+		mpUploadQueue = std::make_unique<render::UploadQueue>(mDevice, transferFamily, 
+			mpTransferTimeline ? *mpTransferTimeline : *mpGraphicsTimeline, indices.graphicsFamily.value(), *mpGraphicsTimeline);
+		std::cout << (mpUploadQueue->isDedicated() ? "Uploading on a dedicated transfer queue!" : "Uploading on the graphics queue!") << std::endl;
+
+		mpDescriptorAllocator = std::make_unique<render::DescriptorAllocator>(mDevice, mFramesInFlight);
 	}
 
 	///Section 2 - Presentation
@@ -680,6 +815,7 @@ namespace qe
 		vkGetSwapchainImagesKHR(mDevice, mSwapchain, &imageCount, nullptr);
 		mSwapchainImages.resize(imageCount);
 		vkGetSwapchainImagesKHR(mDevice, mSwapchain, &imageCount, mSwapchainImages.data());
+		mImageTimelineValues.assign(imageCount, 0);
 		
 		mSwapchainImageFormat = surfaceFormat.format;
 		mSwapchainExtent = extent;
@@ -733,22 +869,117 @@ namespace qe
 		mSwapchainImageViews.resize(mSwapchainImages.size());
 
 		for (size_t i = 0; i < mSwapchainImages.size(); i++) {
-			mSwapchainImageViews[i] = createImageView(mSwapchainImages[i], mSwapchainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT);
+			mSwapchainImageViews[i] = createImageView(mSwapchainImages[i], mSwapchainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
 		}
 	}
 	
 	///Section 3 - Setup
 
 	//Tutorial 9: Introduction
+	void VulkanTutorial::createPipelineCache()
+	{
+		//Kept next to the cooked assets, the pipelines depend on the shaders in there.
+		mpPipelineCache = std::make_unique<render::PipelineCache>(mDevice, mPhysicalDevice, mFileSystem, 
+			mResDirectory + "cooked/" + render::PipelineCache::FILE_NAME);
+	}
 	void VulkanTutorial::createGraphicsPipeline()
 	{
-		std::vector<char> vertShaderCode = readFile("../../../../res/shaders/vert.spv");
-		std::vector<char> fragShaderCode = readFile("../../../../res/shaders/frag.spv");
-		std::cout << "Vertex Shader Size: " << std::to_string(vertShaderCode.size()) << std::endl;
-		std::cout << "Fragment Shader Size: " << std::to_string(vertShaderCode.size()) << std::endl;
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		std::vector<VkDescriptorSetLayout> setLayouts = { mDescriptorSetLayout };
+		if (mpBindlessTextures)
+		{
+			setLayouts.push_back(mpBindlessTextures->getLayout());
+		}
+
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32>(setLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+		//The layout is shared with the culling compute pipeline, so the push constant range covers both stages.
+		VkPushConstantRange pushConstantRange = {};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(DrawPushConstants);
+
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(mDevice, &pipelineLayoutInfo, nullptr, &mPipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline layout.");
+		}
+		else
+		{
+			std::cout << "Successfully created pipeline layout!" << std::endl;
+		}
+
+		mpPipelines = std::make_unique<render::PipelineVariants>(mDevice);
+		buildPipelineVariants(*mpPipelines);
+	}
+	std::vector<render::PipelineKey> VulkanTutorial::getPipelineKeys() const
+	{
+		std::vector<render::PipelineKey> keys = { getDrawPipelineKey(), getCullingPipelineKey() };
+		if (mUseDepthPrepass)
+		{
+			keys.push_back(getDepthPipelineKey());
+		}
+
+		return keys;
+	}
+	render::PipelineKey VulkanTutorial::getDrawPipelineKey() const
+	{
+		render::PipelineKey key;
+		key.program = static_cast<uint32>(PipelineProgram::Draw);
+		key.vertexLayout = mVertexLayout.getKey();
+		key.features = (mSupportsBindless ? PIPELINE_BINDLESS_TEXTURES : 0) | (mUseDepthPrepass ? PIPELINE_DEPTH_EQUAL : 0);
+		//QUANTIZED_POSITIONS in shader.vert, float positions skip the dequantization.
+		key.constants[0] = mVertexLayout.getPositionFormat() != render::PositionFormat::Float3 ? VK_TRUE : VK_FALSE;
+
+		return key;
+	}
+	void VulkanTutorial::buildPipelineVariants(render::PipelineVariants& pipelines) const
+	{
+		//Every variant the frame uses is built before it is recorded, so drawing never waits for the driver. Sets 
+		//only grow, switching back to a mode finds the variants it had.
+		pipelines.build(getPipelineKeys(), mpPipelineCache->get(), *mpJobSystem, 
+			[this](const render::PipelineKey& key, VkPipelineCache cache) { return buildPipeline(key, cache); });
+
+		std::cout << "Successfully built " << pipelines.getCount() << " pipeline variants!" << std::endl;
+	}
+	VkPipeline VulkanTutorial::buildPipeline(const render::PipelineKey& key, VkPipelineCache cache) const
+	{
+		switch (static_cast<PipelineProgram>(key.program))
+		{
+		case PipelineProgram::Draw:
+		case PipelineProgram::Depth:
+			return buildGraphicsPipeline(key, cache);
+		case PipelineProgram::Cull:
+			return buildCullingPipeline(key, cache);
+		default:
+			throw std::runtime_error("Failed to build pipeline, unknown program.");
+		}
+	}
+	VkPipeline VulkanTutorial::buildGraphicsPipeline(const render::PipelineKey& key, VkPipelineCache cache) const
+	{
+		render::VertexLayout vertexLayout;
+		if (!render::VertexLayout::fromKey(key.vertexLayout, vertexLayout))
+		{
+			throw std::runtime_error("Failed to build graphics pipeline, unknown vertex layout.");
+		}
+
+		//The depth prepass only writes depth, it needs neither texture coordinates nor a fragment shader.
+		bool isDepthOnly = static_cast<PipelineProgram>(key.program) == PipelineProgram::Depth;
+
+		io::FileView vertShaderCode;
+		readFile(mpShaderLibrary->getBinaryPath(isDepthOnly ? "depth.vert" : "shader.vert"), vertShaderCode);
+		//The bindless variant samples the texture array in set 1 with the index from the instance data.
+		io::FileView fragShaderCode;
+		if (!isDepthOnly)
+		{
+			readFile(mpShaderLibrary->getBinaryPath((key.features & PIPELINE_BINDLESS_TEXTURES) ? "bindless.frag" : "shader.frag"), fragShaderCode);
+		}
 
 		VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+		VkShaderModule fragShaderModule = isDepthOnly ? VK_NULL_HANDLE : createShaderModule(fragShaderCode);
 
 		VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
 		vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -758,23 +989,32 @@ namespace qe
 		//Tell the compiler the function to invoke/the entrypoint for the shader
 		vertShaderStageInfo.pName = "main";
 
-		//Can be used to set constants in the shader if you want to change them at compile time
-		vertShaderStageInfo.pSpecializationInfo = nullptr; //optional
+		//Sets constants in the shader at pipeline creation, the driver compiles the branches on them away.
+		VkSpecializationMapEntry specializationEntries[render::PipelineKey::MAX_CONSTANTS];
+		VkSpecializationInfo specializationInfo = key.getSpecializationInfo(specializationEntries);
+		vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
 
 		VkPipelineShaderStageCreateInfo fragShaderStageInfo = {};
 		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 		fragShaderStageInfo.module = fragShaderModule;
 		fragShaderStageInfo.pName = "main";
-		fragShaderStageInfo.pSpecializationInfo = nullptr; //optional
+		fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
 
 		VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 		
-		auto bindingDescription = Vertex::getBindingDescription();
-		auto attributeDescriptions = Vertex::getAttributeDescriptions(); 
+		//The layout was picked when the model was packed or cooked.
+		//The prepass fetches positions only, the texture coordinates next to them are skipped.
+		auto bindingDescription = vertexLayout.getBindingDescription();
+		auto attributeDescriptions = vertexLayout.getAttributeDescriptions(); 
+		if (isDepthOnly)
+		{
+			attributeDescriptions.erase(std::remove_if(attributeDescriptions.begin(), attributeDescriptions.end(), 
+				[](const VkVertexInputAttributeDescription& attribute) { return attribute.location != 0; }), attributeDescriptions.end());
+		}
 
 		vertexInputInfo.vertexBindingDescriptionCount = 1;
 		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -846,8 +1086,10 @@ namespace qe
 		VkPipelineDepthStencilStateCreateInfo depthStencil{};
 		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
 		depthStencil.depthTestEnable = VK_TRUE;
-		depthStencil.depthWriteEnable = VK_TRUE;
-		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+		//After a prepass the depth buffer already holds the nearest surface, only the fragments on it are shaded.
+		bool isDepthEqual = (key.features & PIPELINE_DEPTH_EQUAL) != 0;
+		depthStencil.depthWriteEnable = isDepthEqual ? VK_FALSE : VK_TRUE;
+		depthStencil.depthCompareOp = isDepthEqual ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_LESS;
 		depthStencil.depthBoundsTestEnable = VK_FALSE;
 		depthStencil.stencilTestEnable = VK_FALSE;
 
@@ -867,32 +1109,16 @@ namespace qe
 		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 		colorBlending.logicOpEnable = VK_FALSE;
 		colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-		colorBlending.attachmentCount = 1;
+		colorBlending.attachmentCount = isDepthOnly ? 0 : 1;
 		colorBlending.pAttachments = &colorBlendAttachment;
 		colorBlending.blendConstants[0] = 0.0f; // Optional
 		colorBlending.blendConstants[1] = 0.0f; // Optional
 		colorBlending.blendConstants[2] = 0.0f; // Optional
 		colorBlending.blendConstants[3] = 0.0f; // Optional
 
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &mDescriptorSetLayout;
-		pipelineLayoutInfo.pushConstantRangeCount = 0; // Optional
-		pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
-
-		if (vkCreatePipelineLayout(mDevice, &pipelineLayoutInfo, nullptr, &mPipelineLayout) != VK_SUCCESS)
-		{
-			throw std::runtime_error("Failed to create pipeline layout.");
-		}
-		else
-		{
-			std::cout << "Successfully created pipeline layout!" << std::endl;
-		}
-
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		pipelineInfo.stageCount = 2;
+		pipelineInfo.stageCount = isDepthOnly ? 1 : 2;
 		pipelineInfo.pStages = shaderStages;
 		pipelineInfo.pVertexInputState = &vertexInputInfo;
 		pipelineInfo.pInputAssemblyState = &inputAssembly;
@@ -902,11 +1128,17 @@ namespace qe
 		pipelineInfo.pDepthStencilState = &depthStencil;
 		pipelineInfo.pColorBlendState = &colorBlending;
 		pipelineInfo.layout = mPipelineLayout;
-		pipelineInfo.renderPass = mRenderPass;
+		pipelineInfo.renderPass = mpRenderGraph->getRenderPass(isDepthOnly ? mDepthPrepass : mMainPass);
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-		if (vkCreateGraphicsPipelines(mDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &mGraphicsPipeline) != VK_SUCCESS)
+		VkPipeline graphicsPipeline;
+		VkResult result = vkCreateGraphicsPipelines(mDevice, cache, 1, &pipelineInfo, nullptr, &graphicsPipeline);
+
+		vkDestroyShaderModule(mDevice, vertShaderModule, nullptr);
+		vkDestroyShaderModule(mDevice, fragShaderModule, nullptr);
+
+		if (result != VK_SUCCESS)
 		{
 			throw std::runtime_error("Failed to create graphics pipeline.");
 		}
@@ -915,18 +1147,15 @@ namespace qe
 			std::cout << "Successfully create graphics pipeline!" << std::endl;
 		}
 
-		vkDestroyShaderModule(mDevice, vertShaderModule, nullptr);
-		vkDestroyShaderModule(mDevice, fragShaderModule, nullptr);
+		return graphicsPipeline;
 	}
 
 	//Tutorial 10: Shader Modules
-	std::vector<char> VulkanTutorial::readFile(const std::string& fileName)
+	void VulkanTutorial::readFile(const std::string& fileName, io::FileView& file) const
 	{
-		//ate: start reading at the end of the file
-		//binary: read the file as binary
-		std::ifstream file(fileName, std::ios::ate | std::ios::binary);
-
-		if (!file.is_open())
+		//The file is mapped, not read. The driver copies the code out of it when the module is created, so the 
+		//view only has to live until then.
+		if (!mFileSystem.open(fileName, file))
 		{
 			throw std::runtime_error("Failed to open file.");
 		}
@@ -934,25 +1163,14 @@ namespace qe
 		{
 			std::cout << "Successfully opened file: " << fileName << std::endl;
 		}
-
-		//We can use the read position to determine the size of the file
-		//and allocate a buffer.
-		std::size_t fileSize = (std::size_t) file.tellg();
-		std::vector<char> buffer(fileSize);
-
-		//Return to the beginning of the file to to all the bytes
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-		file.close();
-
-		return buffer;
 	}
-	VkShaderModule VulkanTutorial::createShaderModule(const std::vector<char>& code)
+	VkShaderModule VulkanTutorial::createShaderModule(const io::FileView& code) const
 	{
+		//Mappings start on a page boundary, so the code is as aligned as pCode has to be.
 		VkShaderModuleCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = code.size();
-		createInfo.pCode = reinterpret_cast<const uint32*>(code.data());
+		createInfo.codeSize = code.getSize();
+		createInfo.pCode = reinterpret_cast<const uint32*>(code.getData());
 
 		VkShaderModule shaderModule;
 		if (vkCreateShaderModule(mDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
@@ -968,106 +1186,83 @@ namespace qe
 	}
 
 	//Tutorial 11: Render Passes
-	void VulkanTutorial::createRenderPass()
-	{
-		VkAttachmentDescription colorAttachment = {};
-		colorAttachment.format = mSwapchainImageFormat;
-		//The format of the color attachment should match the format of the swap chain images, 
-		//and we're not doing anything with multisampling yet, so we'll stick to 1 sample.
-		colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		//The loadOp and storeOp determine what to do with the data in the attachment before 
-		//rendering and after rendering.
-		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; //Clear the values to a constant at the start
-		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE; //Rendered contents will be stored in memory and can be read later
-		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		VkAttachmentReference colorAttachmentRef = {};
-		colorAttachmentRef.attachment = 0;
-		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-		VkAttachmentDescription depthAttachment = {};
-		depthAttachment.format = findDepthFormat();
-		//The format of the color attachment should match the format of the swap chain images, 
-		//and we're not doing anything with multisampling yet, so we'll stick to 1 sample.
-		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
-		//The loadOp and storeOp determine what to do with the data in the attachment before 
-		//rendering and after rendering.
-		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; //Clear the values to a constant at the start
-		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE; //Rendered contents will be stored in memory and can be read later
-		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-		VkAttachmentReference depthAttachmentRef = {};
-		depthAttachmentRef.attachment = 1;
-		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-		VkSubpassDescription subpass = {};
-		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-		subpass.colorAttachmentCount = 1;
-		subpass.pColorAttachments = &colorAttachmentRef;
-		subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-		VkSubpassDependency dependency{};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-		std::array<VkAttachmentDescription, 2> attachments = { colorAttachment, depthAttachment };
-		VkRenderPassCreateInfo renderPassInfo = {};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-		renderPassInfo.pAttachments = attachments.data();
-		renderPassInfo.subpassCount = 1;
-		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
-
-		if (vkCreateRenderPass(mDevice, &renderPassInfo, nullptr, &mRenderPass) != VK_SUCCESS)
-		{
-			throw std::runtime_error("Failed to create render pass.");
+	void VulkanTutorial::createRenderGraph()
+	{
+		//The frame is described as passes and the resources they touch. The graph builds the render pass and 
+		//framebuffers from that, places the barriers between the passes and owns the depth buffer, which 
+		//only lives within the frame.
+		mpRenderGraph = std::make_unique<render::RenderGraph>(mDevice, mPhysicalDevice);
+
+		//The swapchain image has to wait on the acquire semaphore, which is waited on at color output.
+		render::ResourceHandle backbuffer = mpRenderGraph->importImage("Backbuffer", mSwapchainImages, mSwapchainImageViews, 
+			mSwapchainImageFormat, mSwapchainExtent, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		render::ResourceHandle depth = mpRenderGraph->createImage("Depth", findDepthFormat(), mSwapchainExtent);
+		render::ResourceHandle drawCommands = mpRenderGraph->importBuffer("DrawCommands", mDrawCommandBuffers);
+		render::ResourceHandle visibleInstances = mpRenderGraph->importBuffer("VisibleInstances", mVisibleInstanceBuffers);
+
+		if (mCullingMode == CullingMode::Gpu)
+		{
+			uint32 resetPass = mpRenderGraph->addPass("ResetDrawCommands", render::PassType::Transfer, 
+				[this](VkCommandBuffer commandBuffer, std::size_t imageIndex) { recordDrawCommandReset(commandBuffer, imageIndex); });
+			mpRenderGraph->write(resetPass, drawCommands, render::Access::TransferWrite);
+
+			uint32 cullingPass = mpRenderGraph->addPass("Culling", render::PassType::Compute, 
+				[this](VkCommandBuffer commandBuffer, std::size_t imageIndex) { recordCullingCommands(commandBuffer, imageIndex); });
+			mpRenderGraph->read(cullingPass, drawCommands, render::Access::ComputeShaderRead);
+			mpRenderGraph->write(cullingPass, drawCommands, render::Access::ComputeShaderWrite);
+			mpRenderGraph->write(cullingPass, visibleInstances, render::Access::ComputeShaderWrite);
 		}
 		else
 		{
-			std::cout << "Successfully created render pass!" << std::endl;
+			uint32 uploadPass = mpRenderGraph->addPass("CpuCullingUpload", render::PassType::Transfer, 
+				[this](VkCommandBuffer commandBuffer, std::size_t imageIndex) { recordCpuCullingCommands(commandBuffer, imageIndex); });
+			mpRenderGraph->write(uploadPass, drawCommands, render::Access::TransferWrite);
+			mpRenderGraph->write(uploadPass, visibleInstances, render::Access::TransferWrite);
 		}
-	}
 
-	///Section 4 - Drawing
+		VkClearValue clearColor = {};
+		clearColor.color = { { 0.0f, 0.0f, 0.0f, 1.0f } };
 
-	//Tutorial 13: Framebuffers
-	void VulkanTutorial::createFramebuffers()
-	{
-		mSwapchainFramebuffers.resize(mSwapchainImageViews.size());
+		VkClearValue clearDepth = {};
+		clearDepth.depthStencil = { 1.0f, 0 };
 
-		for (size_t i = 0; i < mSwapchainImageViews.size(); i++) {
-			std::array<VkImageView, 2> attachments = {
-				mSwapchainImageViews[i],
-				mDepthImageView
-			};
+		//With the prepass the main pass only tests against the depth it laid down, so every pixel is shaded once.
+		if (mUseDepthPrepass)
+		{
+			mDepthPrepass = mpRenderGraph->addPass("DepthPrepass", render::PassType::Graphics, 
+				[this](VkCommandBuffer commandBuffer, std::size_t imageIndex) { recordDepthPrepassCommands(commandBuffer, imageIndex); });
+			mpRenderGraph->read(mDepthPrepass, drawCommands, render::Access::IndirectRead);
+			mpRenderGraph->read(mDepthPrepass, visibleInstances, render::Access::VertexShaderRead);
+			mpRenderGraph->write(mDepthPrepass, depth, render::Access::DepthAttachmentWrite, &clearDepth);
+		}
 
-			VkFramebufferCreateInfo framebufferInfo{};
-			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-			framebufferInfo.renderPass = mRenderPass;
-			framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-			framebufferInfo.pAttachments = attachments.data();
-			framebufferInfo.width = mSwapchainExtent.width;
-			framebufferInfo.height = mSwapchainExtent.height;
-			framebufferInfo.layers = 1;
-
-			if (vkCreateFramebuffer(mDevice, &framebufferInfo, nullptr, &mSwapchainFramebuffers[i]) != VK_SUCCESS) {
-				throw std::runtime_error("failed to create framebuffer!");
-			}
+		mMainPass = mpRenderGraph->addPass("Main", render::PassType::Graphics, 
+			[this](VkCommandBuffer commandBuffer, std::size_t imageIndex) { recordDrawCommands(commandBuffer, imageIndex); });
+		mpRenderGraph->read(mMainPass, drawCommands, render::Access::IndirectRead);
+		mpRenderGraph->read(mMainPass, visibleInstances, render::Access::VertexShaderRead);
+		mpRenderGraph->write(mMainPass, backbuffer, render::Access::ColorAttachmentWrite, &clearColor);
+		if (mUseDepthPrepass)
+		{
+			mpRenderGraph->read(mMainPass, depth, render::Access::DepthAttachmentRead);
+		}
+		else
+		{
+			mpRenderGraph->write(mMainPass, depth, render::Access::DepthAttachmentWrite, &clearDepth);
 		}
+
+		mpRenderGraph->markOutput(backbuffer);
+		mpRenderGraph->compile(static_cast<uint32>(mSwapchainImages.size()));
+
+		//Every pass is timed on the GPU, with its own queries per swapchain image since each image has its 
+		//own command buffer.
+		QueueFamilyIndices queueFamilyIndices = findQueueFamilies(mPhysicalDevice);
+		mpGpuProfiler = std::make_unique<render::GpuProfiler>(mDevice, mPhysicalDevice, queueFamilyIndices.graphicsFamily.value(), 
+			static_cast<uint32>(mSwapchainImages.size()));
+		mpRenderGraph->setProfiler(mpGpuProfiler.get());
 	}
 
+	///Section 4 - Drawing
+
 	//Tutorial 14: Command Buffers
 	void VulkanTutorial::createCommandPool()
 	{
@@ -1089,7 +1284,7 @@ namespace qe
 	}
 	void VulkanTutorial::createCommandBuffers()
 	{
-		mCommandBuffers.resize(mSwapchainFramebuffers.size());
+		mCommandBuffers.resize(mSwapchainImages.size());
 
 		VkCommandBufferAllocateInfo allocInfo = {};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -1125,39 +1320,10 @@ namespace qe
 				std::cout << "Successfully recording command buffer with id: " << std::to_string(i) << "!" << std::endl;
 			}
 
-			VkRenderPassBeginInfo renderPassInfo = {};
-			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-			renderPassInfo.renderPass = mRenderPass;
-			renderPassInfo.framebuffer = mSwapchainFramebuffers[i];
-			renderPassInfo.renderArea.offset = { 0, 0 };
-			renderPassInfo.renderArea.extent = mSwapchainExtent;
-
-			std::array<VkClearValue, 2> clearValues{};
-			clearValues[0].color = { 0.0f, 0.0f, 0.0f, 1.0f };
-			clearValues[1].depthStencil = { 1.0f, 0 };
-
-			renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-			renderPassInfo.pClearValues = clearValues.data();
-
-			VkClearValue clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
-			renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-			renderPassInfo.pClearValues = clearValues.data();
-
-			//VK_SUBPASS_CONTENTS_INLINE: The render pass commands will be embedded in the primary command buffer 
-				//itself and no secondary command buffers will be executed.
-			//VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS: The render pass commands will be executed from 
-				//secondary command buffers.
-			vkCmdBeginRenderPass(mCommandBuffers[i], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-			vkCmdBindPipeline(mCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, mGraphicsPipeline);
-
-			VkBuffer vertexBuffers[] = { mVertexBuffer };
-			VkDeviceSize offsets[] = { 0 };
-			vkCmdBindVertexBuffers(mCommandBuffers[i], 0, 1, vertexBuffers, offsets);
-			vkCmdBindIndexBuffer(mCommandBuffers[i], mIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-			vkCmdBindDescriptorSets(mCommandBuffers[i], VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1, &mDescriptorSets[i], 0, nullptr);
-			vkCmdDrawIndexed(mCommandBuffers[i], static_cast<uint32_t>(mIndices.size()), 1, 0, 0, 0);
-			vkCmdEndRenderPass(mCommandBuffers[i]);
+			//Culling, the barriers after it and the render pass all come from the render graph.
+			mpGpuProfiler->beginFrame(mCommandBuffers[i], static_cast<uint32>(i));
+			mpRenderGraph->execute(mCommandBuffers[i], i);
+			mpGpuProfiler->endFrame(mCommandBuffers[i], static_cast<uint32>(i));
 
 			if (vkEndCommandBuffer(mCommandBuffers[i]) != VK_SUCCESS) 
 			{
@@ -1177,16 +1343,33 @@ namespace qe
 	//Return the image to the swap chain for presentation
 	void VulkanTutorial::drawFrame()
 	{
-		vkWaitForFences(mDevice, 1, &mInFlightFences[mCurrentFrame], VK_TRUE, UINT64_MAX);
-		//Fences are mainly designed to synchronize your application itself 
-		//with rendering operation, whereas semaphores are used to synchronize 
-		//operations within or across command queues.We want to synchronize the 
-		//queue operations of draw commands and presentation, which makes 
-		//semaphores the best fit.
+		util::ProfileZone frameZone("Frame");
+		double frameStart = util::Profiler::now();
+		double frameWaitTime = 0.0;
+		double imageWaitTime = 0.0;
+		double acquireTime = 0.0;
+		double presentTime = 0.0;
+
+		{
+			//Wait for the exact timeline value of the last submission that used this frame slot, frames that 
+			//are further along keep running.
+			util::ProfileZone zone("WaitForFrame", &frameWaitTime);
+			mpGraphicsTimeline->wait(mFrameTimelineValues[mCurrentFrame]);
+		}
+		//The GPU is done with this frame, so its transient descriptor sets can be recycled.
+		mpDescriptorAllocator->beginFrame(static_cast<uint32>(mCurrentFrame));
+		mpUploadQueue->collect();
+		updateStreamedTextures();
+		//The timeline paces the CPU against the GPU. Acquiring and presenting swapchain images still needs 
+		//binary semaphores, since the presentation engine does not support timelines.
 
 		uint32 mImageIndex;
-		//Using the maximum value of a 64 bit unsigned integer disables the timeout.
-		VkResult result = vkAcquireNextImageKHR(mDevice, mSwapchain, UINT64_MAX, mImageAvailableSemaphores[mCurrentFrame], VK_NULL_HANDLE, &mImageIndex);
+		VkResult result;
+		{
+			//Using the maximum value of a 64 bit unsigned integer disables the timeout.
+			util::ProfileZone zone("AcquireImage", &acquireTime);
+			result = vkAcquireNextImageKHR(mDevice, mSwapchain, UINT64_MAX, mImageAvailableSemaphores[mCurrentFrame], VK_NULL_HANDLE, &mImageIndex);
+		}
 	
 		if (result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
@@ -1198,37 +1381,39 @@ namespace qe
 			throw std::runtime_error("Failed to acquire swapchain image.");
 		}
 
-		// Check if a previous frame is using this image (i.e. there is its fence to wait on)
-		if (mImagesInFlight[mImageIndex] != VK_NULL_HANDLE)
 		{
-			vkWaitForFences(mDevice, 1, &mImagesInFlight[mImageIndex], VK_TRUE, UINT64_MAX);
+			//The command buffer and uniform buffer of the image may still be used by an older frame when there 
+			//are more frames in flight than swapchain images, or images are acquired out of order.
+			util::ProfileZone zone("WaitForImage", &imageWaitTime);
+			mpGraphicsTimeline->wait(mImageTimelineValues[mImageIndex]);
 		}
 
-		// Mark the image as now being in use by this frame
-		mImagesInFlight[mImageIndex] = mInFlightFences[mCurrentFrame];
+		//Read back the timestamps of every finished frame without waiting. This has to happen before the 
+		//command buffer of this image runs again and resets its queries.
+		mpGpuProfiler->collect(mpGraphicsTimeline->getCompletedValue());
 
-		updateUniformBuffer(mImageIndex);
-
-		VkSubmitInfo submitInfo = {};
-		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-		VkSemaphore waitSemaphores[] = { mImageAvailableSemaphores[mCurrentFrame] };
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		submitInfo.waitSemaphoreCount = 1;
-		submitInfo.pWaitSemaphores = waitSemaphores;
-		submitInfo.pWaitDstStageMask = waitStages;
+		{
+			QE_PROFILE_ZONE("UpdateUniforms");
+			updateUniformBuffer(mImageIndex);
+		}
 
-		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &mCommandBuffers[mImageIndex];
+		if (mCullingMode == CullingMode::Cpu)
+		{
+			QE_PROFILE_ZONE("CpuCulling");
+			updateCpuCulling(mImageIndex);
+		}
 
 		VkSemaphore signalSemaphores[] = { mRenderFinishedSemaphores[mCurrentFrame] };
-		submitInfo.signalSemaphoreCount = 1;
-		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		vkResetFences(mDevice, 1, &mInFlightFences[mCurrentFrame]);
-		if (vkQueueSubmit(mGraphicsQueue, 1, &submitInfo, mInFlightFences[mCurrentFrame]) != VK_SUCCESS) 
 		{
-			throw std::runtime_error("Failed to submit draw command buffer.");
+			QE_PROFILE_ZONE("Submit");
+			double submitTime = util::Profiler::now();
+			uint64 frameValue = mpGraphicsTimeline->submit({ mCommandBuffers[mImageIndex] }, 
+				{ { mImageAvailableSemaphores[mCurrentFrame], 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT } }, 
+				{ mRenderFinishedSemaphores[mCurrentFrame] });
+			mFrameTimelineValues[mCurrentFrame] = frameValue;
+			mImageTimelineValues[mImageIndex] = frameValue;
+			mpGpuProfiler->submitted(mImageIndex, frameValue, submitTime);
 		}
 
 		VkPresentInfoKHR presentInfo = {};
@@ -1243,7 +1428,17 @@ namespace qe
 		presentInfo.pImageIndices = &mImageIndex;
 		presentInfo.pResults = nullptr; // Optional
 
-		result = vkQueuePresentKHR(mPresentQueue, &presentInfo);
+		{
+			util::ProfileZone zone("Present", &presentTime);
+			result = vkQueuePresentKHR(mPresentQueue, &presentInfo);
+		}
+
+		double gpuWaitTime = frameWaitTime + imageWaitTime;
+		mFrameStats.cpuTime += util::Profiler::now() - frameStart - gpuWaitTime - acquireTime - presentTime;
+		mFrameStats.gpuWaitTime += gpuWaitTime;
+		mFrameStats.presentTime += acquireTime + presentTime;
+		mFrameStats.gpuTime += mpGpuProfiler->getLastFrameTime();
+		mFrameStats.frameCount++;
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || mFramebufferResized)
 		{
@@ -1257,27 +1452,21 @@ namespace qe
 			throw std::runtime_error("Failed to present swapchain image.");
 		}
 
-		mCurrentFrame = (mCurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		mCurrentFrame = (mCurrentFrame + 1) % mFramesInFlight;
 	}
 	void VulkanTutorial::createSyncObjects()
 	{
-		mImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		mRenderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		mInFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-		mImagesInFlight.resize(mSwapchainImages.size(), VK_NULL_HANDLE);
+		mImageAvailableSemaphores.resize(mFramesInFlight);
+		mRenderFinishedSemaphores.resize(mFramesInFlight);
+		mFrameTimelineValues.assign(mFramesInFlight, 0);
 
 		VkSemaphoreCreateInfo semaphoreInfo = {};
 		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-		
-		VkFenceCreateInfo fenceInfo = {};
-		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-		for (std::size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		for (std::size_t i = 0; i < mFramesInFlight; ++i)
 		{
 			if (vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, &mImageAvailableSemaphores[i]) != VK_SUCCESS ||
-				vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, &mRenderFinishedSemaphores[i]) != VK_SUCCESS ||
-				vkCreateFence(mDevice, &fenceInfo, nullptr, &mInFlightFences[i]) != VK_SUCCESS) {
+				vkCreateSemaphore(mDevice, &semaphoreInfo, nullptr, &mRenderFinishedSemaphores[i]) != VK_SUCCESS) {
 
 				throw std::runtime_error("Failed to create synchronization objects for a frame.");
 			}
@@ -1301,37 +1490,29 @@ namespace qe
 		}
 
 		vkDeviceWaitIdle(mDevice);
+		//A rebuild in progress uses the render pass and layout that are destroyed below.
+		collectRebuiltPipelines(true);
 
 		cleanupSwapchain();
 
 		createSwapChain();
 		createImageViews();
-		createRenderPass();
-		createGraphicsPipeline();
-		createDepthResources();
-		createFramebuffers();
 		createUniformBuffers();
-		createDescriptorPool();
+		createCullingBuffers();
+		createRenderGraph();
+		createGraphicsPipeline();
 		createDescriptorSets();
 		createCommandBuffers();
 	}
 	void VulkanTutorial::cleanupSwapchain()
 	{
-		vkDestroyImageView(mDevice, mDepthImageView, nullptr);
-		vkDestroyImage(mDevice, mDepthImage, nullptr);
-		vkFreeMemory(mDevice, mDepthImageMemory, nullptr);
-
-		for (VkFramebuffer framebuffer : mSwapchainFramebuffers)
-		{
-			vkDestroyFramebuffer(mDevice, framebuffer, nullptr);
-		}
-
 		vkFreeCommandBuffers(mDevice, mCommandPool, 
 			static_cast<uint32_t>(mCommandBuffers.size()), mCommandBuffers.data());
 
-		vkDestroyPipeline(mDevice, mGraphicsPipeline, nullptr);
+		mpPipelines.reset();
 		vkDestroyPipelineLayout(mDevice, mPipelineLayout, nullptr);
-		vkDestroyRenderPass(mDevice, mRenderPass, nullptr);
+		mpRenderGraph.reset();
+		mpGpuProfiler.reset();
 
 		for (auto imageView : mSwapchainImageViews)
 		{
@@ -1344,9 +1525,19 @@ namespace qe
 		{
 			vkDestroyBuffer(mDevice, mUniformBuffers[i], nullptr);
 			vkFreeMemory(mDevice, mUniformBuffersMemory[i], nullptr);
+
+			vkDestroyBuffer(mDevice, mDrawCommandBuffers[i], nullptr);
+			vkFreeMemory(mDevice, mDrawCommandBuffersMemory[i], nullptr);
+
+			vkDestroyBuffer(mDevice, mVisibleInstanceBuffers[i], nullptr);
+			vkFreeMemory(mDevice, mVisibleInstanceBuffersMemory[i], nullptr);
+
+			vkDestroyBuffer(mDevice, mCpuCullingBuffers[i], nullptr);
+			vkFreeMemory(mDevice, mCpuCullingBuffersMemory[i], nullptr);
 		}
 
-		vkDestroyDescriptorPool(mDevice, mDescriptorPool, nullptr);
+		//The descriptor sets point at the buffers destroyed above.
+		mpDescriptorAllocator->resetPersistent();
 	}
 	void VulkanTutorial::framebufferResizeCallback(GLFWwindow* window, int width, int height)
 	{
@@ -1359,25 +1550,9 @@ namespace qe
 	//Tutorial 18: Vertex Buffer Creation
 	void VulkanTutorial::createVertexBuffer()
 	{
-		VkDeviceSize bufferSize = sizeof(mVertices[0]) * mVertices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT 
-			| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-
-		void* data;
-		vkMapMemory(mDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, mVertices.data(), (size_t)bufferSize);
-		vkUnmapMemory(mDevice, stagingBufferMemory);
-
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mVertexBuffer, mVertexBufferMemory);
-
-		copyBuffer(stagingBuffer, mVertexBuffer, bufferSize);
-
-		vkDestroyBuffer(mDevice, stagingBuffer, nullptr);
-		vkFreeMemory(mDevice, stagingBufferMemory, nullptr);
+		//Every model is copied straight from its mapped cache into the staging buffer.
+		createDeviceLocalBuffer(mSceneGeometry.getVertexDataSize(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, mVertexBuffer, mVertexBufferMemory, 
+			[this](void* pData) { mSceneGeometry.copyVertices(pData); });
 	}
 	uint32_t VulkanTutorial::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) 
 	{
@@ -1423,39 +1598,50 @@ namespace qe
 
 		vkBindBufferMemory(mDevice, buffer, bufferMemory, 0);
 	}
-	void VulkanTutorial::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) 
+	void VulkanTutorial::createDeviceLocalBuffer(const void* srcData, VkDeviceSize size, VkBufferUsageFlags usage,
+		VkBuffer& buffer, VkDeviceMemory& bufferMemory)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-		VkBufferCopy copyRegion{};
-		copyRegion.size = size;
-		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-		endSingleTimeCommands(commandBuffer);
+		createDeviceLocalBuffer(size, usage, buffer, bufferMemory, [srcData, size](void* pData) { memcpy(pData, srcData, (size_t)size); });
 	}
-	
-	//Tutorial 20: Index Buffer
-	void VulkanTutorial::createIndexBuffer() 
+	void VulkanTutorial::createDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& bufferMemory, 
+		const std::function<void(void* pData)>& fill)
 	{
-		VkDeviceSize bufferSize = sizeof(mIndices[0]) * mIndices.size();
-
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | 
-			VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+		createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT 
+			| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 
 		void* data;
-		vkMapMemory(mDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, mIndices.data(), (size_t)bufferSize);
+		vkMapMemory(mDevice, stagingBufferMemory, 0, size, 0, &data);
+		fill(data);
 		vkUnmapMemory(mDevice, stagingBufferMemory);
 
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mIndexBuffer, mIndexBufferMemory);
+		createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
 
-		copyBuffer(stagingBuffer, mIndexBuffer, bufferSize);
+		//The copy is only recorded here. The upload queue frees the staging buffer after the batch it ends 
+		//up in has been flushed and completed.
+		mpUploadQueue->uploadBuffer(stagingBuffer, stagingBufferMemory, buffer, size, usage);
+	}
+	void VulkanTutorial::updateDeviceLocalBuffer(const void* srcData, VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer buffer)
+	{
+		VkBuffer stagingBuffer;
+		VkDeviceMemory stagingBufferMemory;
+		createBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT 
+			| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+
+		void* data;
+		vkMapMemory(mDevice, stagingBufferMemory, 0, size, 0, &data);
+		memcpy(data, srcData, (size_t)size);
+		vkUnmapMemory(mDevice, stagingBufferMemory);
 
-		vkDestroyBuffer(mDevice, stagingBuffer, nullptr);
-		vkFreeMemory(mDevice, stagingBufferMemory, nullptr);
+		mpUploadQueue->updateBuffer(stagingBuffer, stagingBufferMemory, buffer, size, usage);
+	}
+	
+	//Tutorial 20: Index Buffer
+	void VulkanTutorial::createIndexBuffer() 
+	{
+		createDeviceLocalBuffer(mSceneGeometry.getIndexDataSize(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, mIndexBuffer, mIndexBufferMemory, 
+			[this](void* pData) { mSceneGeometry.copyIndices(pData); });
 	}
 
 	///Section 6 - Uniform Buffers
@@ -1468,7 +1654,7 @@ namespace qe
 		uboLayoutBinding.descriptorCount = 1;
 		uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		uboLayoutBinding.pImmutableSamplers = nullptr;
-		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT;
 
 		VkDescriptorSetLayoutBinding samplerLayoutBinding{};
 		samplerLayoutBinding.binding = 1;
@@ -1477,7 +1663,24 @@ namespace qe
 		samplerLayoutBinding.pImmutableSamplers = nullptr;
 		samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-		std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
+		//The culling compute shader and the vertex shader share this layout. The vertex shader reads the 
+		//instance, visible instance and mesh buffers, the draw command buffer is compute only.
+		std::array<VkDescriptorSetLayoutBinding, 4> storageLayoutBindings{};
+		for (uint32 i = 0; i < storageLayoutBindings.size(); ++i)
+		{
+			storageLayoutBindings[i].binding = 2 + i;
+			storageLayoutBindings[i].descriptorCount = 1;
+			storageLayoutBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			storageLayoutBindings[i].pImmutableSamplers = nullptr;
+			storageLayoutBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		storageLayoutBindings[0].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT; //Instances
+		storageLayoutBindings[1].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT; //Visible instances
+		storageLayoutBindings[3].stageFlags |= VK_SHADER_STAGE_VERTEX_BIT; //Meshes, to dequantize positions
+
+		std::array<VkDescriptorSetLayoutBinding, 6> bindings = { uboLayoutBinding, samplerLayoutBinding,
+			storageLayoutBindings[0], storageLayoutBindings[1], storageLayoutBindings[2], storageLayoutBindings[3] };
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -1508,11 +1711,23 @@ namespace qe
 		auto currentTime = std::chrono::high_resolution_clock::now();
 		float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
+		glm::mat4 model = glm::rotate(glm::mat4(1.0f), time * glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 view = glm::lookAt(mCameraPosition, glm::vec3(0.0f, 0.0f, 0.0f)/*mCameraPosition + glm::vec3(0.0f, 1.0f, 0.0f)*/, glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 proj = glm::perspective(glm::radians(69.0f), mSwapchainExtent.width / (float)mSwapchainExtent.height, 0.1f, 10.0f);
+		proj[1][1] *= -1;
+
 		UniformBufferObject ubo = {};
-		ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(45.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.view = glm::lookAt(mCameraPosition, glm::vec3(0.0f, 0.0f, 0.0f)/*mCameraPosition + glm::vec3(0.0f, 1.0f, 0.0f)*/, glm::vec3(0.0f, 0.0f, 1.0f));
-		ubo.proj = glm::perspective(glm::radians(69.0f), mSwapchainExtent.width / (float)mSwapchainExtent.height, 0.1f, 10.0f);
-		ubo.proj[1][1] *= -1;
+		ubo.viewProjModel = proj * view * model;
+
+		extractFrustumPlanes(ubo.viewProjModel, ubo.frustumPlanes);
+		std::copy(std::begin(ubo.frustumPlanes), std::end(ubo.frustumPlanes), std::begin(mFrustumPlanes));
+
+		//An error of e at distance d covers e * proj[1][1] * height / (2 * d) pixels, so a level of detail is 
+		//good enough from e * lodCamera.w on. model only rotates, distances are the same on both sides of it.
+		glm::vec3 lodCameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(mCameraPosition, 1.0f));
+		float lodDistanceScale = std::abs(proj[1][1]) * mSwapchainExtent.height * 0.5f / LOD_ERROR_PIXELS;
+		ubo.lodCamera = glm::vec4(lodCameraPosition, lodDistanceScale);
+		mLodCamera = ubo.lodCamera;
 
 		void* data;
 		vkMapMemory(mDevice, mUniformBuffersMemory[currentImage], 0, sizeof(ubo), 0, &data);
@@ -1521,110 +1736,154 @@ namespace qe
 	}
 
 	//Tutorial 22: Descriptor Pool and Sets
-	void VulkanTutorial::createDescriptorPool()
+	//Sets come from the descriptor allocator. The command buffers are recorded once per swapchain image, so 
+	//these sets are persistent and live until the swapchain is recreated.
+	void VulkanTutorial::createDescriptorSets() 
 	{
-		std::array<VkDescriptorPoolSize, 2> poolSizes{};
-		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = static_cast<uint32_t>(mSwapchainImages.size());
-		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = static_cast<uint32_t>(mSwapchainImages.size());
+		mDescriptorSets.resize(mSwapchainImages.size());
+		mModelDescriptorSets.resize(mSwapchainImages.size());
 
-		VkDescriptorPoolCreateInfo poolInfo{};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = static_cast<uint32_t>(mSwapchainImages.size());
+		auto getSet = [this](size_t imageIndex, VkImageView textureView)
+		{
+			std::vector<render::DescriptorBinding> bindings = {
+				render::DescriptorBinding::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, mUniformBuffers[imageIndex], 0, sizeof(UniformBufferObject)),
+				render::DescriptorBinding::image(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureView, mTextureSampler),
+				render::DescriptorBinding::buffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mInstanceBuffer),
+				render::DescriptorBinding::buffer(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mVisibleInstanceBuffers[imageIndex]),
+				render::DescriptorBinding::buffer(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mDrawCommandBuffers[imageIndex]),
+				render::DescriptorBinding::buffer(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mMeshBuffer)
+			};
+
+			return mpDescriptorAllocator->getSet(mDescriptorSetLayout, bindings);
+		};
 
-		if (vkCreateDescriptorPool(mDevice, &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) 
+		for (size_t i = 0; i < mSwapchainImages.size(); i++) 
 		{
-			throw std::runtime_error("Failed to create descriptor pool.");
+			//The bindless path never samples binding 1, so it does not have to wait for the streamed textures.
+			if (mpBindlessTextures)
+			{
+				mModelDescriptorSets[i].clear();
+				mDescriptorSets[i] = getSet(i, mFallbackTextureImageView);
+				continue;
+			}
+
+			//Without it every model gets a set with its own texture in binding 1. Models sharing a texture 
+			//share the set, the allocator hands out the cached one.
+			mModelDescriptorSets[i].resize(mModelTextures.size());
+			for (std::size_t model = 0; model < mModelTextures.size(); ++model)
+			{
+				mModelDescriptorSets[i][model] = getSet(i, mpAssetManager->getView(mModelTextures[model]));
+			}
+
+			//Culling and the depth prepass do not sample, any of them will do.
+			mDescriptorSets[i] = mModelDescriptorSets[i][0];
 		}
 	}
-	void VulkanTutorial::createDescriptorSets() 
-	{
-		std::vector<VkDescriptorSetLayout> layouts(mSwapchainImages.size(), mDescriptorSetLayout);
-		VkDescriptorSetAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = mDescriptorPool;
-		allocInfo.descriptorSetCount = static_cast<uint32_t>(mSwapchainImages.size());
-		allocInfo.pSetLayouts = layouts.data();
 
-		mDescriptorSets.resize(mSwapchainImages.size());
-		if (vkAllocateDescriptorSets(mDevice, &allocInfo, mDescriptorSets.data()) != VK_SUCCESS) 
+	///Section 7 - Texture Mapping
+	void VulkanTutorial::createAssetManager()
+	{
+		mpAssetManager = std::make_unique<asset::AssetManager>(mDevice, mPhysicalDevice, mSupportsTextureCompression, mAssetManifest, 
+			mFileSystem, *mpUploadQueue, *mpGraphicsTimeline, *mpJobSystem);
+		for (const scene::SceneModel& model : mScene.getModels())
 		{
-			throw std::runtime_error("failed to allocate descriptor sets!");
+			mModelTextures.push_back(mpAssetManager->requestTexture(mResDirectory + model.texturePath));
+		}
+	}
+	void VulkanTutorial::updateStreamedTextures()
+	{
+		if (!mpBindlessTextures)
+		{
+			mpAssetManager->update();
+			return;
 		}
 
-		for (size_t i = 0; i < mSwapchainImages.size(); i++) {
-			VkDescriptorBufferInfo bufferInfo{};
-			bufferInfo.buffer = mUniformBuffers[i];
-			bufferInfo.offset = 0;
-			bufferInfo.range = sizeof(UniformBufferObject);
-
-			VkDescriptorImageInfo imageInfo{};
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = mTextureImageView;
-			imageInfo.sampler = mTextureSampler;
+		bool instancesChanged = false;
 
-			std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+		for (asset::TextureHandle handle : mpAssetManager->update())
+		{
+			//A new slot, so no frame in flight samples a descriptor that changes under it. Models sharing a 
+			//texture share its handle and switch over together.
+			uint32 textureIndex = mpBindlessTextures->addTexture(mpAssetManager->getView(handle), mTextureSampler);
 
-			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[0].dstSet = mDescriptorSets[i];
-			descriptorWrites[0].dstBinding = 0;
-			descriptorWrites[0].dstArrayElement = 0;
-			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descriptorWrites[0].descriptorCount = 1;
-			descriptorWrites[0].pBufferInfo = &bufferInfo;
+			for (std::size_t i = 0; i < mInstances.size(); ++i)
+			{
+				if (mModelTextures[mInstanceModels[i]] == handle)
+				{
+					mInstances[i].textureIndex = textureIndex;
+					instancesChanged = true;
+				}
+			}
 
-			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrites[1].dstSet = mDescriptorSets[i];
-			descriptorWrites[1].dstBinding = 1;
-			descriptorWrites[1].dstArrayElement = 0;
-			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorWrites[1].descriptorCount = 1;
-			descriptorWrites[1].pImageInfo = &imageInfo;
+			std::cout << "Model texture streamed in with " << mpAssetManager->getLevelCount(handle) << " mip levels!" << std::endl;
+		}
 
-			vkUpdateDescriptorSets(mDevice, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+		//Every texture that became resident this frame goes out with one update, which runs after the frames 
+		//in flight.
+		if (instancesChanged)
+		{
+			updateDeviceLocalBuffer(mInstances.data(), sizeof(InstanceData) * mInstances.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mInstanceBuffer);
+			mpUploadQueue->flush();
 		}
 	}
-
-	///Section 7 - Texture Mapping
-	void VulkanTutorial::createTextureImage()
+	void VulkanTutorial::createTextureImageFromPixels(const void* pixels, uint32_t width, uint32_t height, VkImage& image, VkDeviceMemory& imageMemory, 
+		uint32& mipLevels)
 	{
-		int textureWidth, textureHeight, textureChannels;
-		stbi_uc* pixels = stbi_load(texturePath.c_str(), &textureWidth, &textureHeight, &textureChannels, STBI_rgb_alpha);
+		mipLevels = texture::MipChain::getLevelCount(width, height);
 
-		VkDeviceSize imageSize = (uint64)textureWidth * (uint64)textureHeight * (uint64)4;
+		//The GPU blits the mip chain when the format can be filtered linearly. Otherwise it is built on the 
+		//CPU, straight into the staging buffer.
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(mPhysicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &formatProperties);
 
-		if (!pixels)
-		{
-			throw std::runtime_error("Failed to load texture image: " + texturePath);
-		}
+		VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		bool canBlit = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+
+		std::vector<std::size_t> levelOffsets = texture::MipChain::getLevelOffsets(width, height, canBlit ? 1 : mipLevels);
+		VkDeviceSize stagingSize = levelOffsets.back();
 
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
 
-		createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+		createBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
 	
 		void* data;
-		vkMapMemory(mDevice, stagingBufferMemory, 0, imageSize, 0, &data);
-		memcpy(data, pixels, static_cast<size_t>(imageSize));
+		vkMapMemory(mDevice, stagingBufferMemory, 0, stagingSize, 0, &data);
+		memcpy(data, pixels, levelOffsets[1]);
+
+		if (!canBlit)
+		{
+			texture::MipChain::generate(static_cast<uint8*>(data), width, height, mipLevels, true, mpJobSystem.get());
+		}
+
 		vkUnmapMemory(mDevice, stagingBufferMemory);
 
-		stbi_image_free(pixels);
+		createImage(width, height, mipLevels, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, 
+			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
 
-		createImage(textureWidth, textureHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, 
-			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mTextureImage, mTextureImageMemory);
-	
-		transitionImageLayout(mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		copyBufferToImage(stagingBuffer, mTextureImage, static_cast<uint32_t>(textureWidth), static_cast<uint32_t>(textureHeight));
-		transitionImageLayout(mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		if (canBlit)
+		{
+			mpUploadQueue->uploadImage(stagingBuffer, stagingBufferMemory, image, width, height, mipLevels);
+			return;
+		}
 
-		vkDestroyBuffer(mDevice, stagingBuffer, nullptr);
-		vkFreeMemory(mDevice, stagingBufferMemory, nullptr);
+		std::vector<VkBufferImageCopy> regions(mipLevels);
+		for (uint32 level = 0; level < mipLevels; ++level)
+		{
+			VkBufferImageCopy& region = regions[level];
+			region = {};
+			region.bufferOffset = levelOffsets[level];
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = { texture::MipChain::getLevelExtent(width, level), texture::MipChain::getLevelExtent(height, level), 1 };
+		}
+
+		mpUploadQueue->uploadImageLevels(stagingBuffer, stagingBufferMemory, image, regions);
 	}
-	void VulkanTutorial::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, 
+	void VulkanTutorial::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, 
 		VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) 
 	{
 		VkImageCreateInfo imageInfo{};
@@ -1633,7 +1892,7 @@ namespace qe
 		imageInfo.extent.width = width;
 		imageInfo.extent.height = height;
 		imageInfo.extent.depth = 1;
-		imageInfo.mipLevels = 1;
+		imageInfo.mipLevels = mipLevels;
 		imageInfo.arrayLayers = 1;
 		imageInfo.format = format;
 		imageInfo.tiling = tiling;
@@ -1695,96 +1954,9 @@ namespace qe
 
 		vkFreeCommandBuffers(mDevice, mCommandPool, 1, &commandBuffer);
 	}
-	void VulkanTutorial::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) 
-	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.oldLayout = oldLayout;
-		barrier.newLayout = newLayout;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.image = image;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = 1;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
-
-		VkPipelineStageFlags sourceStage;
-		VkPipelineStageFlags destinationStage;
-
-		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) 
-		{
-			barrier.srcAccessMask = 0;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		}
-		else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) 
-		{
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		}
-		else 
-		{
-			throw std::invalid_argument("unsupported layout transition!");
-		}
-
-		vkCmdPipelineBarrier(
-			commandBuffer,
-			sourceStage, destinationStage,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier
-		);
-
-		endSingleTimeCommands(commandBuffer);
-	}
-	void VulkanTutorial::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-		VkBufferImageCopy region{};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
-
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = {
-			width,
-			height,
-			1
-		};
-
-		vkCmdCopyBufferToImage(
-			commandBuffer,
-			buffer,
-			image,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-			1,
-			&region
-		);
-
-		endSingleTimeCommands(commandBuffer);
-	}
 
 	//Tutorial 24: Image View and Sampler
-	void VulkanTutorial::createTextureImageView()
-	{
-		mTextureImageView = createImageView(mTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT);
-	}
-	VkImageView VulkanTutorial::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags)
+	VkImageView VulkanTutorial::createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
 	{
 		VkImageViewCreateInfo viewInfo{};
 		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1793,7 +1965,7 @@ namespace qe
 		viewInfo.format = format;
 		viewInfo.subresourceRange.aspectMask = aspectFlags;
 		viewInfo.subresourceRange.baseMipLevel = 0;
-		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.levelCount = mipLevels;
 		viewInfo.subresourceRange.baseArrayLayer = 0;
 		viewInfo.subresourceRange.layerCount = 1;
 
@@ -1823,19 +1995,30 @@ namespace qe
 		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		samplerInfo.mipLodBias = 0.0f;
 		samplerInfo.minLod = 0.0f;
-		samplerInfo.maxLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE; //Every texture has its own number of levels
 
 		if (vkCreateSampler(mDevice, &samplerInfo, nullptr, &mTextureSampler) != VK_SUCCESS) 
 		{
 			throw std::runtime_error("Failed to create texture sampler.");
 		}
 	}
-	void VulkanTutorial::createDepthResources()
+	void VulkanTutorial::createBindlessTextures()
 	{
-		VkFormat depthFormat = findDepthFormat(); 
-		createImage(mSwapchainExtent.width, mSwapchainExtent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL, 
-			VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mDepthImage, mDepthImageMemory);
-		mDepthImageView = createImageView(mDepthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT);
+		if (!mSupportsBindless)
+		{
+			return;
+		}
+
+		//Slot 0 of the table is a white texel, sampled by anything that has no texture of its own.
+		const uint32 whitePixel = 0xFFFFFFFF;
+		uint32 fallbackMipLevels;
+		createTextureImageFromPixels(&whitePixel, 1, 1, mFallbackTextureImage, mFallbackTextureImageMemory, fallbackMipLevels);
+		mFallbackTextureImageView = createImageView(mFallbackTextureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, fallbackMipLevels);
+
+		mpBindlessTextures = std::make_unique<render::BindlessTextureTable>(mDevice, BINDLESS_TEXTURE_CAPACITY, 
+			mFallbackTextureImageView, mTextureSampler);
+
+		std::cout << "Successfully created bindless texture table!" << std::endl;
 	}
 	VkFormat VulkanTutorial::findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features) 
 	{
@@ -1868,67 +2051,461 @@ namespace qe
 	{
 		return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
 	}
-	void VulkanTutorial::loadModel()
+	void VulkanTutorial::loadScene()
 	{
-		tinyobj::attrib_t attrib;
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials;
-		std::string warn, err;
+		if (!io::ResourceLocator::findResDirectory(mResDirectory))
+		{
+			throw std::runtime_error(std::string("Failed to find the resource directory, set ") + io::ResourceLocator::ENVIRONMENT_VARIABLE + 
+				" to point to it.");
+		}
 
-		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, modelPath.c_str())) 
+		//Files the asset cooker packed are read from its archive, everything else from the resource directory.
+		if (mFileSystem.mountArchive(mResDirectory + io::ResourceArchive::FILE_NAME, mResDirectory))
 		{
-			throw std::runtime_error(warn + err);
+			std::cout << "Successfully mounted resource archive with " << mFileSystem.getMountedFileCount() << " files!" << std::endl;
 		}
 
-		std::unordered_map<Vertex, uint32_t> uniqueVertices = {};
+		mAssetManifest.open(mFileSystem, mResDirectory + "cooked/", mResDirectory);
+		//Shaders are compiled into the same directory as the cooked ones, under the same names.
+		mpShaderLibrary = std::make_unique<render::ShaderLibrary>(mFileSystem, mAssetManifest, mResDirectory + "shaders/", mResDirectory + "cooked/",
+			*mpJobSystem);
+		mScene.load(mFileSystem, mResDirectory + SCENE_FILE);
 
-		for (const auto& shape : shapes) 
+		std::cout << "Successfully loaded scene with " << mScene.getModels().size() << " models and " << mScene.getInstances().size() << 
+			" instances!" << std::endl;
+	}
+	void VulkanTutorial::loadSceneGeometry()
+	{
+		std::vector<std::string> meshPaths;
+		for (const scene::SceneModel& model : mScene.getModels())
 		{
-			for (const auto& index : shape.mesh.indices) 
+			meshPaths.push_back(mResDirectory + model.meshPath);
+		}
+
+		mSceneGeometry.load(mFileSystem, meshPaths, mAssetManifest, *mpJobSystem);
+		mSubmeshes = mSceneGeometry.getSubmeshes();
+		mVertexLayout = mSceneGeometry.getVertexLayout();
+		mIndexType = mSceneGeometry.getIndexSize() == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	}
+
+	///Section 10 - GPU Culling
+	void VulkanTutorial::createSceneInstances()
+	{
+		static_assert(mesh::Submesh::MAX_LOD_COUNT <= 4, "MeshData::lodErrors holds four levels of detail.");
+
+		//Every submesh is its own mesh, so objects are culled one by one instead of all or nothing. Its levels 
+		//of detail follow it and share its bounds and vertices.
+		std::vector<uint32> submeshMeshes;
+		for (uint32 submeshIndex = 0; submeshIndex < mSubmeshes.size(); ++submeshIndex)
+		{
+			const mesh::Submesh& submesh = mSubmeshes[submeshIndex];
+			glm::vec3 positionOffset;
+			glm::vec3 positionScale;
+			mVertexLayout.getDequantization(submesh.bounds.min, submesh.bounds.max, positionOffset, positionScale);
+
+			MeshData mesh = {};
+			mesh.boundingSphere = glm::vec4(submesh.bounds.getCenter(), submesh.boundingRadius);
+			mesh.positionOffset = glm::vec4(positionOffset, 0.0f);
+			mesh.positionScale = glm::vec4(positionScale, 0.0f);
+			mesh.lodCount = submesh.lodCount;
+
+			for (uint32 lod = 0; lod < submesh.lodCount; ++lod)
 			{
-				Vertex vertex{};
+				mesh.lodErrors[lod] = submesh.lods[lod].error;
+			}
 
-				vertex.pos = 
-				{
-					attrib.vertices[(uint64)3 * index.vertex_index + 0],
-					attrib.vertices[(uint64)3 * index.vertex_index + 1],
-					attrib.vertices[(uint64)3 * index.vertex_index + 2]
-				};
+			submeshMeshes.push_back(static_cast<uint32>(mMeshes.size()));
 
-				vertex.texCoord = 
-				{
-					attrib.texcoords[(uint64)2 * index.texcoord_index + 0],
-					1.0f - attrib.texcoords[(uint64)2 * index.texcoord_index + 1]
-				};
+			for (uint32 level = 0; level <= submesh.lodCount; ++level)
+			{
+				mMeshes.push_back(mesh);
+				mMeshSubmeshes.push_back(submeshIndex);
+			}
+		}
 
-				vertex.color = { 1.0f, 1.0f, 1.0f };
+		//The submeshes of a model are contiguous, and so are their meshes.
+		uint32 modelCount = static_cast<uint32>(mScene.getModels().size());
+		mModelFirstMeshes.resize(modelCount + 1);
+		for (uint32 model = 0; model < modelCount; ++model)
+		{
+			uint32 firstSubmesh = mSceneGeometry.getFirstSubmesh(model);
+			mModelFirstMeshes[model] = firstSubmesh < submeshMeshes.size() ? submeshMeshes[firstSubmesh] : static_cast<uint32>(mMeshes.size());
+		}
+		mModelFirstMeshes[modelCount] = static_cast<uint32>(mMeshes.size());
 
-				if (uniqueVertices.count(vertex) == 0) 
-				{
-					uniqueVertices[vertex] = static_cast<uint32_t>(mVertices.size());
-					mVertices.push_back(vertex);
-				}
+		//A scene instance places every submesh of its model. They sample the fallback until the texture of 
+		//the model is resident.
+		for (const scene::SceneInstance& sceneInstance : mScene.getInstances())
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), sceneInstance.position);
+			model = glm::rotate(model, glm::radians(sceneInstance.rotation), glm::vec3(0.0f, 0.0f, 1.0f));
+			model = glm::scale(model, glm::vec3(sceneInstance.scale));
 
-				mIndices.push_back(uniqueVertices[vertex]);
+			uint32 firstSubmesh = mSceneGeometry.getFirstSubmesh(sceneInstance.model);
+			uint32 submeshCount = mSceneGeometry.getSubmeshCount(sceneInstance.model);
+
+			for (uint32 submeshIndex = firstSubmesh; submeshIndex < firstSubmesh + submeshCount; ++submeshIndex)
+			{
+				InstanceData instance = {};
+				instance.model = model;
+				instance.meshIndex = submeshMeshes[submeshIndex];
+				instance.textureIndex = render::BindlessTextureTable::FALLBACK_TEXTURE;
+				mInstances.push_back(instance);
+				mInstanceModels.push_back(sceneInstance.model);
 			}
 		}
+
+		//Every mesh reserves room in the visible instance list for all of the instances that reference it. 
+		//Any of them may be drawn at any level of detail, so every level reserves as much as the full mesh.
+		std::vector<uint32> submeshInstanceCounts(mSubmeshes.size(), 0);
+		for (const InstanceData& instance : mInstances)
+		{
+			++submeshInstanceCounts[mMeshSubmeshes[instance.meshIndex]];
+		}
+
+		mDrawCommandTemplate.resize(mMeshes.size());
+		uint32 visibleBase = 0;
+
+		for (std::size_t i = 0; i < mMeshes.size(); ++i)
+		{
+			const mesh::Submesh& submesh = mSubmeshes[mMeshSubmeshes[i]];
+			uint32 level = static_cast<uint32>(i) - submeshMeshes[mMeshSubmeshes[i]];
+			mMeshes[i].visibleBase = visibleBase;
+
+			VkDrawIndexedIndirectCommand& command = mDrawCommandTemplate[i];
+			command.indexCount = level == 0 ? submesh.indexCount : submesh.lods[level - 1].indexCount;
+			command.instanceCount = 0; //Counted up by the culling pass every frame
+			command.firstIndex = level == 0 ? submesh.firstIndex : submesh.lods[level - 1].firstIndex;
+			command.vertexOffset = submesh.vertexOffset;
+			command.firstInstance = mSupportsMultiDrawIndirect ? visibleBase : 0;
+
+			visibleBase += submeshInstanceCounts[mMeshSubmeshes[i]];
+		}
+
+		mVisibleInstanceCapacity = visibleBase;
+
+		std::cout << "Created " << mInstances.size() << " instances of " << mSubmeshes.size() << " meshes with " << mMeshes.size() - mSubmeshes.size() <<
+			" levels of detail!" << std::endl;
 	}
-	void VulkanTutorial::initResPaths()
+	void VulkanTutorial::createInstanceBuffers()
 	{
-		std::ifstream in;
+		createDeviceLocalBuffer(mInstances.data(), sizeof(InstanceData) * mInstances.size(), 
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mInstanceBuffer, mInstanceBufferMemory);
+		createDeviceLocalBuffer(mMeshes.data(), sizeof(MeshData) * mMeshes.size(), 
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, mMeshBuffer, mMeshBufferMemory);
 
-		in.open(RES_FILE);
-		std::string fileName;
+		//The culling pass starts every frame by copying this over its draw command buffer, which resets 
+		//the instance counts without touching the rest of the commands.
+		createDeviceLocalBuffer(mDrawCommandTemplate.data(), sizeof(VkDrawIndexedIndirectCommand) * mDrawCommandTemplate.size(), 
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT, mDrawCommandTemplateBuffer, mDrawCommandTemplateBufferMemory);
+	}
+	void VulkanTutorial::createCullingBuffers()
+	{
+		VkDeviceSize drawCommandBufferSize = sizeof(VkDrawIndexedIndirectCommand) * mDrawCommandTemplate.size();
+		VkDeviceSize visibleInstanceBufferSize = sizeof(uint32) * mVisibleInstanceCapacity;
 
-		if (in.good())
+		mDrawCommandBuffers.resize(mSwapchainImages.size());
+		mDrawCommandBuffersMemory.resize(mSwapchainImages.size());
+		mVisibleInstanceBuffers.resize(mSwapchainImages.size());
+		mVisibleInstanceBuffersMemory.resize(mSwapchainImages.size());
+		mCpuCullingBuffers.resize(mSwapchainImages.size());
+		mCpuCullingBuffersMemory.resize(mSwapchainImages.size());
+
+		for (std::size_t i = 0; i < mSwapchainImages.size(); ++i)
 		{
-			std::getline(in, fileName);
-			modelPath = "../../../../res/obj/" + fileName;
-			std::getline(in, fileName);
-			texturePath = "../../../../res/textures/" + fileName;
+			createBuffer(drawCommandBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | 
+				VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mDrawCommandBuffers[i], mDrawCommandBuffersMemory[i]);
+			createBuffer(visibleInstanceBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mVisibleInstanceBuffers[i], mVisibleInstanceBuffersMemory[i]);
+
+			//Written by the CPU culling path every frame, laid out as the draw commands followed by the visible list.
+			createBuffer(drawCommandBufferSize + visibleInstanceBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mCpuCullingBuffers[i], mCpuCullingBuffersMemory[i]);
 		}
+	}
+	render::PipelineKey VulkanTutorial::getCullingPipelineKey() const
+	{
+		render::PipelineKey key;
+		key.program = static_cast<uint32>(PipelineProgram::Cull);
+		//The workgroup size of cull.comp.
+		key.constants[0] = CULLING_WORKGROUP_SIZE;
 
-		in.close();
+		return key;
+	}
+	VkPipeline VulkanTutorial::buildCullingPipeline(const render::PipelineKey& key, VkPipelineCache cache) const
+	{
+		io::FileView computeShaderCode;
+		readFile(mpShaderLibrary->getBinaryPath("cull.comp"), computeShaderCode);
+		VkShaderModule computeShaderModule = createShaderModule(computeShaderCode);
+
+		VkPipelineShaderStageCreateInfo computeShaderStageInfo = {};
+		computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		computeShaderStageInfo.module = computeShaderModule;
+		computeShaderStageInfo.pName = "main";
+		VkSpecializationMapEntry specializationEntries[render::PipelineKey::MAX_CONSTANTS];
+		VkSpecializationInfo specializationInfo = key.getSpecializationInfo(specializationEntries);
+		computeShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
+		//Reuses the graphics pipeline layout so both pipelines can share one descriptor set per frame.
+		VkComputePipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage = computeShaderStageInfo;
+		pipelineInfo.layout = mPipelineLayout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+		VkPipeline cullingPipeline;
+		VkResult result = vkCreateComputePipelines(mDevice, cache, 1, &pipelineInfo, nullptr, &cullingPipeline);
+
+		vkDestroyShaderModule(mDevice, computeShaderModule, nullptr);
+
+		if (result != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create culling pipeline.");
+		}
+		else
+		{
+			std::cout << "Successfully created culling pipeline!" << std::endl;
+		}
+
+		return cullingPipeline;
+	}
+	void VulkanTutorial::recordDrawCommandReset(VkCommandBuffer commandBuffer, std::size_t imageIndex)
+	{
+		VkBufferCopy resetRegion = {};
+		resetRegion.size = sizeof(VkDrawIndexedIndirectCommand) * mDrawCommandTemplate.size();
+		vkCmdCopyBuffer(commandBuffer, mDrawCommandTemplateBuffer, mDrawCommandBuffers[imageIndex], 1, &resetRegion);
+	}
+	void VulkanTutorial::recordCullingCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex)
+	{
+		//The render graph places the barriers around the dispatch: after the reset copy, and before the 
+		//indirect draw and the vertex shader read what culling wrote.
+		DrawPushConstants constants = {};
+		constants.instanceCount = static_cast<uint32>(mInstances.size());
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mpPipelines->find(getCullingPipelineKey()));
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mPipelineLayout, 0, 1, &mDescriptorSets[imageIndex], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, mPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 
+			0, sizeof(DrawPushConstants), &constants);
+		vkCmdDispatch(commandBuffer, (constants.instanceCount + CULLING_WORKGROUP_SIZE - 1) / CULLING_WORKGROUP_SIZE, 1, 1);
+	}
+	void VulkanTutorial::recordDrawCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mpPipelines->find(getDrawPipelineKey()));
+
+		VkBuffer vertexBuffers[] = { mVertexBuffer };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer, 0, mIndexType);
+
+		if (mpBindlessTextures)
+		{
+			VkDescriptorSet sets[] = { mDescriptorSets[imageIndex], mpBindlessTextures->getSet() };
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 2, sets, 0, nullptr);
+			recordIndirectDraws(commandBuffer, imageIndex, 0, static_cast<uint32>(mMeshes.size()));
+			return;
+		}
+
+		//One draw group per model, each with the set that holds its texture.
+		for (std::size_t model = 0; model + 1 < mModelFirstMeshes.size(); ++model)
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1, 
+				&mModelDescriptorSets[imageIndex][model], 0, nullptr);
+			recordIndirectDraws(commandBuffer, imageIndex, mModelFirstMeshes[model], mModelFirstMeshes[model + 1] - mModelFirstMeshes[model]);
+		}
+	}
+	void VulkanTutorial::recordIndirectDraws(VkCommandBuffer commandBuffer, std::size_t imageIndex, uint32 firstMesh, uint32 meshCount)
+	{
+		if (meshCount == 0)
+		{
+			return;
+		}
+
+		DrawPushConstants constants = {};
+		constants.instanceCount = static_cast<uint32>(mInstances.size());
+		uint32 stride = sizeof(VkDrawIndexedIndirectCommand);
+
+		if (mSupportsMultiDrawIndirect)
+		{
+			//firstInstance already points every command at its region of the visible instance list.
+			vkCmdPushConstants(commandBuffer, mPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 
+				0, sizeof(DrawPushConstants), &constants);
+			vkCmdDrawIndexedIndirect(commandBuffer, mDrawCommandBuffers[imageIndex], firstMesh * stride, meshCount, stride);
+		}
+		else
+		{
+			for (std::size_t i = firstMesh; i < firstMesh + meshCount; ++i)
+			{
+				constants.visibleBase = mMeshes[i].visibleBase;
+				vkCmdPushConstants(commandBuffer, mPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 
+					0, sizeof(DrawPushConstants), &constants);
+				vkCmdDrawIndexedIndirect(commandBuffer, mDrawCommandBuffers[imageIndex], i * stride, 1, stride);
+			}
+		}
+	}
+	void VulkanTutorial::extractFrustumPlanes(const glm::mat4& matrix, glm::vec4 planes[6])
+	{
+		//Gribb/Hartmann plane extraction. Because of GLM_FORCE_DEPTH_ZERO_TO_ONE the near plane is 
+		//the third row on its own instead of row3 + row2.
+		glm::vec4 row0 = glm::row(matrix, 0);
+		glm::vec4 row1 = glm::row(matrix, 1);
+		glm::vec4 row2 = glm::row(matrix, 2);
+		glm::vec4 row3 = glm::row(matrix, 3);
+
+		planes[0] = row3 + row0; //Left
+		planes[1] = row3 - row0; //Right
+		planes[2] = row3 + row1; //Bottom
+		planes[3] = row3 - row1; //Top
+		planes[4] = row2;		 //Near
+		planes[5] = row3 - row2; //Far
+
+		for (int i = 0; i < 6; ++i)
+		{
+			planes[i] /= glm::length(glm::vec3(planes[i]));
+		}
+	}
+
+	///Section 11 - CPU Culling
+	void VulkanTutorial::buildSceneBvh()
+	{
+		//Instances never move, so the tree is built once over their bounds in the space of the frustum planes.
+		std::vector<scene::Aabb> instanceBounds(mInstances.size());
+
+		for (std::size_t i = 0; i < mInstances.size(); ++i)
+		{
+			instanceBounds[i] = scene::Aabb::transform(mSubmeshes[mMeshSubmeshes[mInstances[i].meshIndex]].bounds, mInstances[i].model);
+		}
+
+		mSceneBvh.build(instanceBounds);
+
+		std::cout << "Built scene BVH with " << mSceneBvh.getNodeCount() << " nodes over " 
+			<< mSceneBvh.getObjectCount() << " instances!" << std::endl;
+	}
+	void VulkanTutorial::updateCpuCulling(uint32_t currentImage)
+	{
+		mCpuVisibleInstances.clear();
+		mSceneBvh.cullFrustum(mFrustumPlanes, mCpuVisibleInstances, mpJobSystem.get());
+
+		//Produce exactly what the culling compute shader would: instance counts in the draw commands and 
+		//every visible instance in the region of the level of detail it is drawn at.
+		mCpuDrawCommands.assign(mDrawCommandTemplate.begin(), mDrawCommandTemplate.end());
+
+		VkDeviceSize drawCommandSize = sizeof(VkDrawIndexedIndirectCommand) * mCpuDrawCommands.size();
+		VkDeviceSize visibleInstanceSize = sizeof(uint32) * mVisibleInstanceCapacity;
+
+		void* data;
+		vkMapMemory(mDevice, mCpuCullingBuffersMemory[currentImage], 0, drawCommandSize + visibleInstanceSize, 0, &data);
+
+		uint32* pVisibleInstances = reinterpret_cast<uint32*>(static_cast<char*>(data) + drawCommandSize);
+
+		for (uint32 instanceIndex : mCpuVisibleInstances)
+		{
+			uint32 meshIndex = selectLod(mInstances[instanceIndex]);
+			uint32 slot = mCpuDrawCommands[meshIndex].instanceCount++;
+			pVisibleInstances[mMeshes[meshIndex].visibleBase + slot] = instanceIndex;
+		}
+
+		memcpy(data, mCpuDrawCommands.data(), (size_t)drawCommandSize);
+		vkUnmapMemory(mDevice, mCpuCullingBuffersMemory[currentImage]);
+	}
+	uint32 VulkanTutorial::selectLod(const InstanceData& instance) const
+	{
+		//The coarsest level whose error stays below LOD_ERROR_PIXELS at the nearest point of the bounding sphere.
+		//Mirrors selectLod in cull.comp.
+		const MeshData& mesh = mMeshes[instance.meshIndex];
+		glm::vec3 center = glm::vec3(instance.model * glm::vec4(glm::vec3(mesh.boundingSphere), 1.0f));
+		float scale = std::max(glm::length(glm::vec3(instance.model[0])), std::max(glm::length(glm::vec3(instance.model[1])), 
+			glm::length(glm::vec3(instance.model[2]))));
+		float distance = glm::length(center - glm::vec3(mLodCamera)) - mesh.boundingSphere.w * scale;
+
+		uint32 level = 0;
+		while (level < mesh.lodCount && mesh.lodErrors[level] * scale * mLodCamera.w <= distance)
+		{
+			++level;
+		}
+
+		return instance.meshIndex + level;
+	}
+	void VulkanTutorial::recordCpuCullingCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex)
+	{
+		VkDeviceSize drawCommandSize = sizeof(VkDrawIndexedIndirectCommand) * mDrawCommandTemplate.size();
+
+		VkBufferCopy drawCommandRegion = {};
+		drawCommandRegion.srcOffset = 0;
+		drawCommandRegion.size = drawCommandSize;
+		vkCmdCopyBuffer(commandBuffer, mCpuCullingBuffers[imageIndex], mDrawCommandBuffers[imageIndex], 1, &drawCommandRegion);
+
+		VkBufferCopy visibleInstanceRegion = {};
+		visibleInstanceRegion.srcOffset = drawCommandSize;
+		visibleInstanceRegion.size = sizeof(uint32) * mVisibleInstanceCapacity;
+		vkCmdCopyBuffer(commandBuffer, mCpuCullingBuffers[imageIndex], mVisibleInstanceBuffers[imageIndex], 1, &visibleInstanceRegion);
+	}
+	void VulkanTutorial::setCullingMode(CullingMode mode)
+	{
+		if (mode == mCullingMode)
+		{
+			return;
+		}
+
+		//The culling passes are part of the render graph and baked into the command buffers, so both are built again.
+		vkDeviceWaitIdle(mDevice);
+		collectRebuiltPipelines(true);
+		mCullingMode = mode;
+
+		vkFreeCommandBuffers(mDevice, mCommandPool, static_cast<uint32_t>(mCommandBuffers.size()), mCommandBuffers.data());
+		mpRenderGraph.reset();
+
+		//The graphics pipeline stays valid, the new main pass has a compatible render pass.
+		createRenderGraph();
+		createCommandBuffers();
+
+		std::cout << "Culling mode: " << (mode == CullingMode::Cpu ? "CPU" : "GPU") << std::endl;
+	}
+
+	///Section 12 - Profiling
+	std::string VulkanTutorial::getFrameStatsReport()
+	{
+		if (mFrameStats.frameCount == 0)
+		{
+			return "";
+		}
+
+		double frameCount = static_cast<double>(mFrameStats.frameCount);
+		double cpuTime = mFrameStats.cpuTime / frameCount / 1000.0;
+		double gpuWaitTime = mFrameStats.gpuWaitTime / frameCount / 1000.0;
+		double presentTime = mFrameStats.presentTime / frameCount / 1000.0;
+		double gpuTime = mFrameStats.gpuTime / frameCount / 1000.0;
+
+		//Whatever the frame spent most of its time on is what limits it.
+		const char* pBound = "CPU";
+		if (gpuWaitTime > cpuTime && gpuWaitTime >= presentTime)
+			pBound = "GPU";
+		else if (presentTime > cpuTime && presentTime > gpuWaitTime)
+			pBound = "present";
+
+		char report[160];
+		std::snprintf(report, sizeof(report), " | CPU: %.2f ms | GPU: %.2f ms | GPU wait: %.2f ms | Present: %.2f ms | %s bound", 
+			cpuTime, gpuTime, gpuWaitTime, presentTime, pBound);
+
+		mFrameStats = FrameStats();
+
+		return report;
+	}
+	void VulkanTutorial::toggleTraceCapture()
+	{
+		util::Profiler& profiler = util::Profiler::instance();
+
+		if (!profiler.isCapturing())
+		{
+			profiler.beginCapture();
+			std::cout << "Capturing profiler trace, press T again to write it." << std::endl;
+			return;
+		}
+
+		//The last frames are still on the GPU, their timestamps are only in the trace once they finished.
+		mpGraphicsTimeline->waitIdle();
+		mpGpuProfiler->collect(mpGraphicsTimeline->getCompletedValue());
+		profiler.endCapture(TRACE_FILE);
 	}
 	void VulkanTutorial::processInput(GLFWwindow* window, float deltaTime)
 	{
@@ -1949,5 +2526,127 @@ namespace qe
 			mCameraPosition -= cameraSpeed * glm::vec3(0.0f, 0.0f, 1.0f) * deltaTime;
 		if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 			glfwSetWindowShouldClose(window, true);
+
+		//Toggle between GPU and CPU culling once per press, not every tick the key is held.
+		bool isCullingKeyPressed = glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS;
+		if (isCullingKeyPressed && !mCullingKeyWasPressed)
+			setCullingMode(mCullingMode == CullingMode::Gpu ? CullingMode::Cpu : CullingMode::Gpu);
+		mCullingKeyWasPressed = isCullingKeyPressed;
+
+		//Toggle the depth prepass, the frame stats show what it saves.
+		bool isDepthPrepassKeyPressed = glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS;
+		if (isDepthPrepassKeyPressed && !mDepthPrepassKeyWasPressed)
+			setDepthPrepass(!mUseDepthPrepass);
+		mDepthPrepassKeyWasPressed = isDepthPrepassKeyPressed;
+
+		//Start or stop writing CPU and GPU zones into a trace.
+		bool isTraceKeyPressed = glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS;
+		if (isTraceKeyPressed && !mTraceKeyWasPressed)
+			toggleTraceCapture();
+		mTraceKeyWasPressed = isTraceKeyPressed;
+	}
+
+	///Section 13 - Shader Reloading
+	void VulkanTutorial::updateShaders()
+	{
+		//The command buffers are recorded once, so they are recorded again for the new pipelines.
+		if (collectRebuiltPipelines(false))
+		{
+			vkFreeCommandBuffers(mDevice, mCommandPool, static_cast<uint32_t>(mCommandBuffers.size()), mCommandBuffers.data());
+			createCommandBuffers();
+			return;
+		}
+
+		if (mPipelineRebuild.valid() || !mpShaderLibrary->update())
+		{
+			return;
+		}
+
+		//Creating pipelines takes long enough to drop frames, so they are built on the job system. Layout and 
+		//render pass stay the same, only the shaders changed.
+		mPipelineRebuild = mpJobSystem->submit([this]()
+		{
+			mpRebuiltPipelines = std::make_unique<render::PipelineVariants>(mDevice);
+			buildPipelineVariants(*mpRebuiltPipelines);
+		});
+	}
+	bool VulkanTutorial::collectRebuiltPipelines(bool wait)
+	{
+		if (!mPipelineRebuild.valid() || (!wait && mPipelineRebuild.wait_for(std::chrono::seconds(0)) != std::future_status::ready))
+		{
+			return false;
+		}
+
+		bool isRebuilt = true;
+		try
+		{
+			mPipelineRebuild.get();
+		}
+		catch (const std::exception& e)
+		{
+			//The old pipelines keep running, the next edit tries again.
+			std::cout << "Failed to rebuild pipelines: " << e.what() << std::endl;
+			isRebuilt = false;
+		}
+
+		if (isRebuilt)
+		{
+			//Frames in flight still use the old pipelines.
+			vkDeviceWaitIdle(mDevice);
+			std::swap(mpPipelines, mpRebuiltPipelines);
+			std::cout << "Successfully rebuilt pipelines!" << std::endl;
+		}
+
+		//The old variants, or whatever a failed rebuild got to.
+		mpRebuiltPipelines.reset();
+
+		return isRebuilt;
+	}
+
+	///Section 14 - Depth Prepass
+	render::PipelineKey VulkanTutorial::getDepthPipelineKey() const
+	{
+		render::PipelineKey key;
+		key.program = static_cast<uint32>(PipelineProgram::Depth);
+		key.vertexLayout = mVertexLayout.getKey();
+		key.constants[0] = mVertexLayout.getPositionFormat() != render::PositionFormat::Float3 ? VK_TRUE : VK_FALSE;
+
+		return key;
+	}
+	void VulkanTutorial::recordDepthPrepassCommands(VkCommandBuffer commandBuffer, std::size_t imageIndex)
+	{
+		//Same buffers and draws as the main pass, without the textures.
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mpPipelines->find(getDepthPipelineKey()));
+
+		VkBuffer vertexBuffers[] = { mVertexBuffer };
+		VkDeviceSize offsets[] = { 0 };
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, mIndexBuffer, 0, mIndexType);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipelineLayout, 0, 1, &mDescriptorSets[imageIndex], 0, nullptr);
+
+		recordIndirectDraws(commandBuffer, imageIndex, 0, static_cast<uint32>(mMeshes.size()));
+	}
+	void VulkanTutorial::setDepthPrepass(bool isEnabled)
+	{
+		if (isEnabled == mUseDepthPrepass)
+		{
+			return;
+		}
+
+		//The prepass is part of the render graph and changes the main pass pipeline, both are baked into the 
+		//command buffers.
+		vkDeviceWaitIdle(mDevice);
+		collectRebuiltPipelines(true);
+		mUseDepthPrepass = isEnabled;
+
+		vkFreeCommandBuffers(mDevice, mCommandPool, static_cast<uint32_t>(mCommandBuffers.size()), mCommandBuffers.data());
+		mpRenderGraph.reset();
+
+		//Variants that are already built stay valid, the new passes have compatible render passes.
+		createRenderGraph();
+		buildPipelineVariants(*mpPipelines);
+		createCommandBuffers();
+
+		std::cout << "Depth prepass: " << (isEnabled ? "on" : "off") << std::endl;
 	}
 }
\ No newline at end of file